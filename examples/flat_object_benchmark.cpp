@@ -0,0 +1,91 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <bstd_json.hpp>
+
+using namespace bstd::json;
+
+// Compares flat_json against json (whose objects are std::maps) on arrays of
+// objects with a given number of members: the time to build the tree from
+// JSON text, and the time to look up every member of every object by key.
+// Each figure is the fastest of several runs.
+
+constexpr std::size_t objects = 2000;
+constexpr std::size_t runs = 5;
+
+std::string
+key(const std::size_t _i) {
+  static const char* const names[] = {"id", "timestamp", "name", "type",
+    "value", "user", "session", "status", "code", "message"};
+  return names[_i % 10] + std::to_string(_i);
+}
+
+template<class Json>
+void
+run(const char* const _name, const std::size_t _members) {
+  using clock = std::chrono::steady_clock;
+
+  std::string text = "[";
+  for(std::size_t i = 0; i < objects; ++i) {
+    text += i == 0 ? "{" : ",{";
+    for(std::size_t j = 0; j < _members; ++j)
+      text += (j == 0 ? "\"" : ",\"") + key(j) + "\":" + std::to_string(j);
+    text += '}';
+  }
+  text += ']';
+
+  std::vector<std::string> keys;
+  for(std::size_t j = 0; j < _members; ++j)
+    keys.push_back(key(j));
+
+  parser::dom_builder<Json> builder;
+  Json document;
+  auto build = clock::duration::max();
+  for(std::size_t r = 0; r < runs; ++r) {
+    const auto start = clock::now();
+    parser::parse_sax(text, builder);
+    document = builder.release();
+    build = std::min(build, clock::now() - start);
+  }
+
+  std::size_t found = 0;
+  auto lookup = clock::duration::max();
+  for(std::size_t r = 0; r < runs; ++r) {
+    const auto start = clock::now();
+    for(const auto& object :
+        document.template get<typename Json::array_type>()) {
+      const auto& members = object.template get<typename Json::object_type>();
+      for(const auto& k : keys)
+        found += members.find(k) != members.end();
+    }
+    lookup = std::min(lookup, clock::now() - start);
+  }
+
+  const auto build_ms =
+    std::chrono::duration<double, std::milli>(build).count();
+  const auto lookup_ns =
+    std::chrono::duration<double, std::nano>(lookup).count() /
+    static_cast<double>(objects * _members);
+
+  std::cout << std::setw(12) << _name << std::setw(9) << _members
+    << std::setw(12) << std::fixed << std::setprecision(2) << build_ms
+    << std::setw(14) << lookup_ns << std::endl;
+
+  if(found != runs * objects * _members)
+    std::cerr << "missing members" << std::endl;
+}
+
+int main() {
+  std::cout << std::setw(12) << "object" << std::setw(9) << "members"
+    << std::setw(12) << "build ms" << std::setw(14) << "lookup ns" << std::endl;
+
+  for(const std::size_t members : {5, 10, 20, 50}) {
+    run<json>("std::map", members);
+    run<flat_json>("flat_object", members);
+  }
+}
@@ -21,6 +21,9 @@ int main() {
   const auto& object = json({{"name1", 100}, {"name2", "string"}});
   std::cout << "Object: " << std::endl << object << std::endl;
 
+  const auto& parsed = parser::parse(R"({"name1": 100, "name2": "string"})");
+  std::cout << "Parsed: " << std::endl << *parsed << std::endl;
+
   /*
   const auto& array = json({1, "string", true, null});
   std::cout << "Array: " << std::endl << array << std::endl;
@@ -4,6 +4,22 @@
 // Contains all public header files within the json tool.
 
 #include "../src/basic_json.hpp"
+#include "../src/binary/cbor.hpp"
+#include "../src/binary/msgpack.hpp"
+#include "../src/binary/snapshot.hpp"
+#include "../src/flat_object.hpp"
+#include "../src/interned_string.hpp"
+#include "../src/json_pointer.hpp"
+#include "../src/number.hpp"
+#include "../src/pmr_json.hpp"
+#include "../src/serializer/serializer.hpp"
+#include "../src/parser/incremental_parser.hpp"
+#include "../src/parser/json_path.hpp"
+#include "../src/parser/lazy_document.hpp"
+#include "../src/parser/lexer.hpp"
+#include "../src/parser/ndjson.hpp"
+#include "../src/parser/parallel_parser.hpp"
 #include "../src/parser/parser.hpp"
+#include "../src/patch/json_patch.hpp"
 
 #endif
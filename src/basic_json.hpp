@@ -1,16 +1,25 @@
 #ifndef BSTD_BASIC_JSON_HPP_
 #define BSTD_BASIC_JSON_HPP_
 
+#include <cstdint>
+#include <cstring>
 #include <exception>
 #include <initializer_list>
 #include <iostream>
 #include <map>
+#include <memory>
+#include <new>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <utility>
 #include <variant>
 #include <vector>
 
 #include "json_iterator.hpp"
+#include "number.hpp"
+#include "serializer/serializer.hpp"
 
 namespace bstd::json {
 
@@ -20,7 +29,7 @@ template<
   template<typename, typename, typename...> class ObjectType = std::map,
   template<typename, typename...> class ArrayType = std::vector,
   class StringType = std::string,
-  class NumberType = int,
+  class NumberType = number,
   class BoolType = bool,
   class NullType = std::nullptr_t>
 class basic_json;
@@ -72,11 +81,30 @@ class basic_json {
       null
     };
 
-    basic_json() = default;
-    basic_json(const basic_json&) = default;
-    basic_json& operator=(const basic_json&) = default;
-    basic_json(basic_json&&) = default;
-    basic_json& operator=(basic_json&&) = default;
+    basic_json() noexcept { construct<null_type>(nullptr); }
+
+    basic_json(const basic_json& _other);
+
+    basic_json(basic_json&& _other) noexcept { move_from(_other); }
+
+    basic_json& operator=(const basic_json& _other) {
+      if(this != &_other) {
+        basic_json copy(_other);
+        destroy();
+        move_from(copy);
+      }
+      return *this;
+    }
+
+    basic_json& operator=(basic_json&& _other) noexcept {
+      // _other may be part of this value, so take it before destroying.
+      basic_json value(std::move(_other));
+      destroy();
+      move_from(value);
+      return *this;
+    }
+
+    ~basic_json() { destroy(); }
 
     /// \brief Construct a JSON with a character array.
     /// This constructor attempts to construct a `string_type` from a character
@@ -88,41 +116,142 @@ class basic_json {
 
     /// \brief Construct a JSON with a string value.
     /// \param _string The string to use.
-    basic_json(const string_type& _string)
-      : m_type{value_type::string}, m_value{_string} {}
+    basic_json(const string_type& _string) : basic_json(string_type(_string)) {}
+
+    /// \brief Construct a JSON with a string value.
+    /// Short strings are copied into the value itself.
+    /// \param _string The string to move from.
+    basic_json(string_type&& _string);
 
     /// \brief Construct a JSON with a number value.
     /// \param _number The number to use.
-    basic_json(const number_type _number)
-      : m_type{value_type::number}, m_value{_number} {}
+    basic_json(const number_type _number) { construct<number_type>(_number); }
+
+    /// \brief Construct a JSON with a number value from any arithmetic type.
+    /// Without this, arithmetic types that need a conversion to number_type
+    /// would invoke the `basic_json(const boolean_type)` constructor.
+    /// \param _number The number to use.
+    template<class T>
+      requires std::is_arithmetic_v<T> and
+        (!std::is_same_v<T, boolean_type>) and
+        (!std::is_same_v<T, number_type>)
+    basic_json(const T _number) {
+      construct<number_type>(static_cast<number_type>(_number));
+    }
 
     /// \brief Construct a JSON with a boolean value.
     /// \param _boolean The boolean value to use.
-    basic_json(const boolean_type _boolean)
-      : m_type{value_type::boolean}, m_value{_boolean} {}
+    basic_json(const boolean_type _boolean) {
+      construct<boolean_type>(_boolean);
+    }
 
     /// \brief Construct a JSON with a null value.
     /// \param _null The null value to use.
-    basic_json(const null_type _null)
-      : m_type{value_type::null}, m_value{_null} {}
+    basic_json(const null_type _null) { construct<null_type>(_null); }
 
     /// \brief Construct a JSON object with initializer list.
     /// \param _il An std::intializer_list containing object values.
-    basic_json(const std::initializer_list<object_value_typeype>& _il)
-      : m_type{value_type::object}, m_value{object_type{_il}} {}
+    basic_json(const std::initializer_list<object_value_typeype>& _il) {
+      construct<object_type>(_il);
+    }
+
+    /// \brief Construct a JSON object.
+    /// \param _object The object to move from.
+    basic_json(object_type&& _object) {
+      construct<object_type>(std::move(_object));
+    }
+
+    /// \brief Construct a JSON array.
+    /// \param _array The array to move from.
+    basic_json(array_type&& _array) {
+      construct<array_type>(std::move(_array));
+    }
+
+    /// \brief Get the type of the JSON value.
+    /// \return The type of the JSON value.
+    value_type get_type() const noexcept {
+      return static_cast<value_type>(m_tag & type_mask);
+    }
+
+    /// \brief Get the value as a specific type.
+    /// Short strings are stored in the JSON value itself rather than as a
+    /// `string_type`, so the const overload returns strings by value; use
+    /// get_string() to read a string without copying it.
+    /// \tparam T One of object_type, array_type, string_type, number_type,
+    ///           boolean_type, or null_type.
+    /// \return A reference to the value, or a copy for strings.
+    /// \throws std::bad_variant_access if the JSON value is not a T.
+    template<class T>
+    decltype(auto) get() const;
+
+    /// \brief Get a reference to the value as a specific type.
+    /// A short string is first moved out of the JSON value into a
+    /// `string_type` of its own, which is then kept, so that it can be
+    /// changed through the reference.
+    /// \tparam T One of object_type, array_type, string_type, number_type,
+    ///           boolean_type, or null_type.
+    /// \return A reference to the value.
+    /// \throws std::bad_variant_access if the JSON value is not a T.
+    template<class T>
+    T& get();
+
+    /// \brief Get a view of the JSON string.
+    /// \return A view of the string, valid until this value is changed.
+    /// \throws std::bad_variant_access if the JSON value is not a string.
+    std::string_view get_string() const;
+
+    /// \brief Get the number of elements of the JSON object or array, or the
+    ///        length of the string.
+    /// \return The size of the JSON value.
+    /// \throws std::domain_error if the JSON value is not one of object, array, or
+    ///         string.
+    std::size_t size() const {
+      switch (get_type()) {
+        case value_type::object:
+          return get<object_type>().size();
+        case value_type::array:
+          return get<array_type>().size();
+        case value_type::string:
+          return get_string().size();
+        case value_type::number:
+        case value_type::boolean:
+        case value_type::null:
+        default:
+          throw std::domain_error("size is only defined for objects, arrays, " \
+              "and strings.");
+      }
+    }
+
+    /// \brief Access a member of the JSON object.
+    /// \param _key The member name.
+    /// \return A reference to the member's value.
+    /// \throws std::bad_variant_access if the JSON value is not an object.
+    /// \throws std::out_of_range if there is no such member.
+    const basic_json& at(const string_type& _key) const {
+      return get<object_type>().at(_key);
+    }
+
+    /// \brief Access an element of the JSON array.
+    /// \param _index The element index.
+    /// \return A reference to the element.
+    /// \throws std::bad_variant_access if the JSON value is not an array.
+    /// \throws std::out_of_range if _index is out of range.
+    const basic_json& at(const std::size_t _index) const {
+      return get<array_type>().at(_index);
+    }
 
     /// \brief Check if the JSON object, array or string is empty.
     /// \return `true` if the JSON value is empty; `false` otherwise.
-    /// \throws std::domain_error if `m_type` is not one of object, array, or
+    /// \throws std::domain_error if the JSON value is not one of object, array, or
     ///         string.
     bool empty() const {
-      switch (m_type) {
+      switch (get_type()) {
         case value_type::object:
-          return std::get<object_type>(m_value).empty();
+          return get<object_type>().empty();
         case value_type::array:
-          return std::get<array_type>(m_value).empty();
+          return get<array_type>().empty();
         case value_type::string:
-          return std::get<string_type>(m_value).empty();
+          return get_string().empty();
         case value_type::number:
         case value_type::boolean:
         case value_type::null:
@@ -157,9 +286,45 @@ class basic_json {
     const typename object_type::const_iterator cend() const noexcept;
 
     /// \brief Convert JSON to string.
-    /// \param _include_ws If `true`, the original whitespace will be included.
+    /// \param _include_ws If `true`, the output is indented by two spaces per
+    ///                    level; otherwise it is compact.
+    /// \see serializer::serialize() to append to a reusable buffer instead.
     std::string to_string(const bool _include_ws = true) const noexcept;
 
+    /// \brief Hash the value.
+    /// Equal values hash equally: object members are combined in any order,
+    /// and numbers are hashed by value, so `1` and `1.0` agree. Objects and
+    /// arrays whose hash was memoized are not visited again.
+    /// \return the hash
+    std::size_t hash() const noexcept { return hash_value(false); }
+
+    /// \brief Hash the value, and remember the hash of every object and
+    ///        array in it.
+    /// Later calls to hash() reuse the stored hashes, and comparisons with
+    /// another memoized value exit early when they differ. A stored hash is
+    /// dropped when its container is accessed mutably through get(), begin()
+    /// or end(), but not when a value is changed through a reference taken
+    /// before; memoize again after changing a document that way.
+    /// \return the hash
+    std::size_t memoize_hash() noexcept { return hash_value(true); }
+
+    /// \brief Check if the hash of the object or array is memoized.
+    /// \return `true` if hash() returns without visiting the value
+    bool is_hash_memoized() const noexcept {
+      return (get_type() == value_type::object or
+          get_type() == value_type::array) and (m_tag & hash_cached);
+    }
+
+    /// \brief Compare two JSON values by value.
+    /// Types, then sizes, then memoized hashes are compared before any
+    /// element. Objects are equal if they have the same members in any order,
+    /// and numbers compare as with number_type's operator==.
+    /// \return `true` if the values are equal
+    friend bool operator==(const basic_json& _lhs,
+        const basic_json& _rhs) noexcept {
+      return _lhs.equals(_rhs);
+    }
+
     /// \brief Output operator overload.
     /// This calls to_string() which includes whitespace by default.
     /// If you do not want whitespace use
@@ -199,32 +364,383 @@ class basic_json {
       return _os;
     }
 
-    value_type m_type{value_type::null};
+    /// Bytes in the value for storing its contents.
+    static constexpr std::size_t storage_size = 15;
+
+    /// The low bits of m_tag hold the value_type. A string of at most
+    /// storage_size characters is kept in m_storage, marked by small_string,
+    /// with its length in the high bits.
+    static constexpr std::uint8_t type_mask = 0x07;
+    static constexpr std::uint8_t small_string = 0x08;
+    static constexpr int length_shift = 4;
+
+    /// An object or array, which holds only a pointer, keeps its memoized
+    /// hash in the rest of m_storage, marked by hash_cached.
+    static constexpr std::uint8_t hash_cached = 0x10;
+    static constexpr std::size_t hash_offset = sizeof(void*);
+    static constexpr std::size_t hash_size =
+      storage_size - hash_offset < sizeof(std::uint64_t) ?
+      storage_size - hash_offset : sizeof(std::uint64_t);
+
+    /// Small types are stored in m_storage; anything larger, such as the
+    /// containers, is allocated separately and m_storage holds a pointer.
+    template<class T>
+    static constexpr bool is_stored_inline = sizeof(T) <= storage_size and
+      alignof(T) <= alignof(T*) and std::is_nothrow_move_constructible_v<T>;
+
+    /// \brief Get the value_type a T is stored as.
+    template<class T>
+    static constexpr value_type type_of() noexcept {
+      if constexpr(std::is_same_v<T, object_type>)
+        return value_type::object;
+      else if constexpr(std::is_same_v<T, array_type>)
+        return value_type::array;
+      else if constexpr(std::is_same_v<T, string_type>)
+        return value_type::string;
+      else if constexpr(std::is_same_v<T, number_type>)
+        return value_type::number;
+      else if constexpr(std::is_same_v<T, boolean_type>)
+        return value_type::boolean;
+      else {
+        static_assert(std::is_same_v<T, null_type>,
+            "T must be one of the basic_json value types");
+        return value_type::null;
+      }
+    }
+
+    template<class T>
+    T* slot() noexcept {
+      return std::launder(reinterpret_cast<T*>(m_storage));
+    }
+
+    template<class T>
+    const T* slot() const noexcept {
+      return std::launder(reinterpret_cast<const T*>(m_storage));
+    }
+
+    /// \brief Get the stored T, wherever it is stored.
+    template<class T>
+    T& ref() noexcept {
+      if constexpr(is_stored_inline<T>)
+        return *slot<T>();
+      else
+        return **slot<T*>();
+    }
+
+    template<class T>
+    const T& ref() const noexcept {
+      if constexpr(is_stored_inline<T>)
+        return *slot<T>();
+      else
+        return **slot<T*>();
+    }
+
+    /// \brief Store a T constructed from _args and set the type.
+    template<class T, class... Args>
+    void construct(Args&&... _args);
+
+    /// \brief Destroy the stored value.
+    void destroy() noexcept;
+
+    /// \brief Take the value of _other, leaving it null.
+    void move_from(basic_json& _other) noexcept;
+
+    /// \brief Compare with another value; see operator==().
+    bool equals(const basic_json& _other) const noexcept;
+
+    /// \brief Hash the value; see hash() and memoize_hash().
+    /// \param _memoize whether to store the hashes of objects and arrays
+    std::size_t hash_value(const bool _memoize) const noexcept;
+
+    /// \brief Get the memoized hash of an object or array.
+    /// \return the hash, or 0 if there is none
+    std::size_t get_cached_hash() const noexcept {
+      std::uint64_t hash = 0;
+      if(m_tag & hash_cached)
+        for(std::size_t i = 0; i < hash_size; ++i)
+          hash |= std::uint64_t{m_storage[hash_offset + i]} << (8 * i);
+      return static_cast<std::size_t>(hash);
+    }
+
+    /// \brief Memoize the hash of an object or array.
+    void set_cached_hash(const std::uint64_t _hash) noexcept {
+      if constexpr(!is_stored_inline<object_type> and
+          !is_stored_inline<array_type>) {
+        for(std::size_t i = 0; i < hash_size; ++i)
+          m_storage[hash_offset + i] =
+            static_cast<unsigned char>(_hash >> (8 * i));
+        m_tag = static_cast<std::uint8_t>(m_tag | hash_cached);
+      }
+    }
+
+    /// \brief Take the memoized hash of an object or array equal to this one.
+    void copy_cached_hash(const basic_json& _other) noexcept {
+      if(_other.m_tag & hash_cached)
+        set_cached_hash(_other.get_cached_hash());
+    }
+
+    /// \brief Drop the memoized hash of an object or array.
+    void drop_cached_hash() noexcept {
+      m_tag = static_cast<std::uint8_t>(m_tag & ~hash_cached);
+    }
+
+    /// \brief Allocate a T with the allocator it would use for its contents.
+    template<class T>
+    static auto node_allocator(const T& _value);
+
+    alignas(void*) unsigned char m_storage[storage_size];
+
+    std::uint8_t m_tag;
 
-    std::variant<object_type, array_type, string_type, number_type, boolean_type, null_type>
-      m_value{nullptr};
 };
 
 
+static_assert(sizeof(json) == 16, "json values should fit in 16 bytes");
+
+
 BASIC_JSON_TEMPLATE_DECLARATION
-std::string
 BASIC_JSON_TEMPLATE::
-to_string(const bool _include_ws) const noexcept {
-  switch (m_type) {
+basic_json(const basic_json& _other) {
+  switch (_other.get_type()) {
     case value_type::object:
-      return object_to_string(this, _include_ws);
+      construct<object_type>(_other.ref<object_type>());
+      copy_cached_hash(_other);
+      break;
     case value_type::array:
-      // TODO: implement.
-      return "array";
+      construct<array_type>(_other.ref<array_type>());
+      copy_cached_hash(_other);
+      break;
     case value_type::string:
-      return std::get<string_type>(m_value);
+      if(_other.m_tag & small_string) {
+        std::memcpy(m_storage, _other.m_storage, storage_size);
+        m_tag = _other.m_tag;
+      }
+      else
+        construct<string_type>(_other.ref<string_type>());
+      break;
     case value_type::number:
-      return std::to_string(std::get<number_type>(m_value));
+      construct<number_type>(_other.ref<number_type>());
+      break;
     case value_type::boolean:
-      return std::to_string(std::get<boolean_type>(m_value));
+      construct<boolean_type>(_other.ref<boolean_type>());
+      break;
     case value_type::null:
-      return "null";
+      construct<null_type>(_other.ref<null_type>());
+      break;
+  }
+}
+
+
+BASIC_JSON_TEMPLATE_DECLARATION
+BASIC_JSON_TEMPLATE::
+basic_json(string_type&& _string) {
+  if constexpr(!is_stored_inline<string_type>) {
+    if(_string.size() <= storage_size) {
+      std::memcpy(m_storage, _string.data(), _string.size());
+      m_tag = static_cast<std::uint8_t>(
+          static_cast<std::uint8_t>(value_type::string) | small_string |
+          _string.size() << length_shift);
+      return;
+    }
   }
+
+  construct<string_type>(std::move(_string));
+}
+
+
+BASIC_JSON_TEMPLATE_DECLARATION
+template<class T>
+decltype(auto)
+BASIC_JSON_TEMPLATE::
+get() const {
+  if(get_type() != type_of<T>())
+    throw std::bad_variant_access();
+
+  if constexpr(std::is_same_v<T, string_type> and
+      !is_stored_inline<string_type>)
+    return string_type(get_string());
+  else
+    return ref<T>();
+}
+
+
+BASIC_JSON_TEMPLATE_DECLARATION
+template<class T>
+T&
+BASIC_JSON_TEMPLATE::
+get() {
+  if(get_type() != type_of<T>())
+    throw std::bad_variant_access();
+
+  // The container may be changed through the reference.
+  if constexpr(std::is_same_v<T, object_type> or std::is_same_v<T, array_type>)
+    drop_cached_hash();
+
+  if constexpr(std::is_same_v<T, string_type> and
+      !is_stored_inline<string_type>)
+    if(m_tag & small_string) {
+      string_type string(get_string());
+      construct<string_type>(std::move(string));
+    }
+
+  return ref<T>();
+}
+
+
+BASIC_JSON_TEMPLATE_DECLARATION
+std::string_view
+BASIC_JSON_TEMPLATE::
+get_string() const {
+  if(get_type() != value_type::string)
+    throw std::bad_variant_access();
+
+  if(m_tag & small_string)
+    return std::string_view(reinterpret_cast<const char*>(m_storage),
+        m_tag >> length_shift);
+
+  const auto& string = ref<string_type>();
+  return std::string_view(string.data(), string.size());
+}
+
+
+BASIC_JSON_TEMPLATE_DECLARATION
+template<class T, class... Args>
+void
+BASIC_JSON_TEMPLATE::
+construct(Args&&... _args) {
+  if constexpr(is_stored_inline<T>)
+    new(m_storage) T(std::forward<Args>(_args)...);
+  else {
+    T value(std::forward<Args>(_args)...);
+
+    // Allocate the node from the same allocator as its contents, so a whole
+    // document can live in one memory resource.
+    auto allocator = node_allocator(value);
+    using traits = std::allocator_traits<decltype(allocator)>;
+
+    const auto node = traits::allocate(allocator, 1);
+    try {
+      traits::construct(allocator, node, std::move(value));
+    }
+    catch(...) {
+      traits::deallocate(allocator, node, 1);
+      throw;
+    }
+
+    new(m_storage) T*(node);
+  }
+
+  m_tag = static_cast<std::uint8_t>(type_of<T>());
+}
+
+
+BASIC_JSON_TEMPLATE_DECLARATION
+void
+BASIC_JSON_TEMPLATE::
+destroy() noexcept {
+  const auto destroy_as = [this]<class T>(T*) {
+    if constexpr(is_stored_inline<T>)
+      slot<T>()->~T();
+    else {
+      const auto node = *slot<T*>();
+      auto allocator = node_allocator(*node);
+      using traits = std::allocator_traits<decltype(allocator)>;
+
+      traits::destroy(allocator, node);
+      traits::deallocate(allocator, node, 1);
+    }
+  };
+
+  switch (get_type()) {
+    case value_type::object:
+      destroy_as(static_cast<object_type*>(nullptr));
+      break;
+    case value_type::array:
+      destroy_as(static_cast<array_type*>(nullptr));
+      break;
+    case value_type::string:
+      if(!(m_tag & small_string))
+        destroy_as(static_cast<string_type*>(nullptr));
+      break;
+    case value_type::number:
+      destroy_as(static_cast<number_type*>(nullptr));
+      break;
+    case value_type::boolean:
+      destroy_as(static_cast<boolean_type*>(nullptr));
+      break;
+    case value_type::null:
+      destroy_as(static_cast<null_type*>(nullptr));
+      break;
+  }
+}
+
+
+BASIC_JSON_TEMPLATE_DECLARATION
+void
+BASIC_JSON_TEMPLATE::
+move_from(basic_json& _other) noexcept {
+  // Nodes change owner; values stored inline are moved, and the moved-from
+  // value destroyed.
+  const auto move_as = [this, &_other]<class T>(T*) {
+    if constexpr(is_stored_inline<T>) {
+      new(m_storage) T(std::move(*_other.template slot<T>()));
+      _other.template slot<T>()->~T();
+    }
+    else
+      new(m_storage) T*(*_other.template slot<T*>());
+  };
+
+  switch (_other.get_type()) {
+    case value_type::object:
+      move_as(static_cast<object_type*>(nullptr));
+      copy_cached_hash(_other);
+      break;
+    case value_type::array:
+      move_as(static_cast<array_type*>(nullptr));
+      copy_cached_hash(_other);
+      break;
+    case value_type::string:
+      if(_other.m_tag & small_string)
+        std::memcpy(m_storage, _other.m_storage, storage_size);
+      else
+        move_as(static_cast<string_type*>(nullptr));
+      break;
+    case value_type::number:
+      move_as(static_cast<number_type*>(nullptr));
+      break;
+    case value_type::boolean:
+      move_as(static_cast<boolean_type*>(nullptr));
+      break;
+    case value_type::null:
+      move_as(static_cast<null_type*>(nullptr));
+      break;
+  }
+
+  m_tag = _other.m_tag;
+  _other.template construct<null_type>(nullptr);
+}
+
+
+BASIC_JSON_TEMPLATE_DECLARATION
+template<class T>
+auto
+BASIC_JSON_TEMPLATE::
+node_allocator(const T& _value) {
+  if constexpr(requires { _value.get_allocator(); }) {
+    using allocator_type = decltype(_value.get_allocator());
+    return typename std::allocator_traits<allocator_type>::
+      template rebind_alloc<T>(_value.get_allocator());
+  }
+  else
+    return std::allocator<T>();
+}
+
+
+BASIC_JSON_TEMPLATE_DECLARATION
+std::string
+BASIC_JSON_TEMPLATE::
+to_string(const bool _include_ws) const noexcept {
+  return serializer::serialize(*this, {_include_ws ? std::size_t{2} : 0});
 }
 
 
@@ -232,7 +748,7 @@ BASIC_JSON_TEMPLATE_DECLARATION
 typename BASIC_JSON_TEMPLATE::object_type::iterator
 BASIC_JSON_TEMPLATE::
 begin() noexcept {
-  return std::get<object_type>(m_value).begin();
+  return get<object_type>().begin();
 }
 
 
@@ -240,7 +756,7 @@ BASIC_JSON_TEMPLATE_DECLARATION
 typename BASIC_JSON_TEMPLATE::object_type::const_iterator
 BASIC_JSON_TEMPLATE::
 begin() const noexcept {
-  return std::get<object_type>(m_value).begin();
+  return get<object_type>().begin();
 }
 
 
@@ -248,7 +764,7 @@ BASIC_JSON_TEMPLATE_DECLARATION
 const typename BASIC_JSON_TEMPLATE::object_type::const_iterator
 BASIC_JSON_TEMPLATE::
 cbegin() const noexcept {
-  return std::get<object_type>(m_value).cbegin();
+  return get<object_type>().cbegin();
 }
 
 
@@ -256,7 +772,7 @@ BASIC_JSON_TEMPLATE_DECLARATION
 typename BASIC_JSON_TEMPLATE::object_type::iterator
 BASIC_JSON_TEMPLATE::
 end() noexcept {
-  return std::get<object_type>(m_value).end();
+  return get<object_type>().end();
 }
 
 
@@ -264,7 +780,7 @@ BASIC_JSON_TEMPLATE_DECLARATION
 typename BASIC_JSON_TEMPLATE::object_type::const_iterator
 BASIC_JSON_TEMPLATE::
 end() const noexcept {
-  return std::get<object_type>(m_value).end();
+  return get<object_type>().end();
 }
 
 
@@ -272,37 +788,176 @@ BASIC_JSON_TEMPLATE_DECLARATION
 const typename BASIC_JSON_TEMPLATE::object_type::const_iterator
 BASIC_JSON_TEMPLATE::
 cend() const noexcept {
-  return std::get<object_type>(m_value).cend();
+  return get<object_type>().cend();
 }
 
 
 BASIC_JSON_TEMPLATE_DECLARATION
-std::string
-object_to_string(const BASIC_JSON_TEMPLATE* _json,
-    const bool _include_ws = true) {
-  auto result = "{"s;
+bool
+BASIC_JSON_TEMPLATE::
+equals(const basic_json& _other) const noexcept {
+  if(this == &_other)
+    return true;
+
+  const auto type = get_type();
+  if(type != _other.get_type())
+    return false;
+
+  switch (type) {
+    case value_type::object: {
+      const auto& object = ref<object_type>();
+      const auto& other = _other.ref<object_type>();
+      if(object.size() != other.size())
+        return false;
+
+      if((m_tag & _other.m_tag & hash_cached) and
+          get_cached_hash() != _other.get_cached_hash())
+        return false;
+
+      // Keys are unique, so every member found with an equal value means the
+      // members are the same.
+      for(const auto& [key, value] : object) {
+        const auto member = other.find(key);
+        if(member == other.end() or !(member->second == value))
+          return false;
+      }
+
+      return true;
+    }
+    case value_type::array: {
+      const auto& array = ref<array_type>();
+      const auto& other = _other.ref<array_type>();
+      if(array.size() != other.size())
+        return false;
 
-  for (const auto& member : *_json) {
-    result += member.first + ":" + member.second.to_string();
+      if((m_tag & _other.m_tag & hash_cached) and
+          get_cached_hash() != _other.get_cached_hash())
+        return false;
 
-    if (member != *std::prev(_json->end())) {
-      result += ", ";
+      for(std::size_t i = 0; i < array.size(); ++i)
+        if(!(array[i] == other[i]))
+          return false;
+
+      return true;
     }
+    case value_type::string:
+      return get_string() == _other.get_string();
+    case value_type::number:
+      return ref<number_type>() == _other.ref<number_type>();
+    case value_type::boolean:
+      return ref<boolean_type>() == _other.ref<boolean_type>();
+    case value_type::null:
+    default:
+      return true;
   }
-
-  return result += "}";
 }
 
 
 BASIC_JSON_TEMPLATE_DECLARATION
-constexpr bool
-operator==(const BASIC_JSON_TEMPLATE& _json1,
-    const BASIC_JSON_TEMPLATE& _json2) noexcept {
-  // TODO: implement.
-  return true;
+std::size_t
+BASIC_JSON_TEMPLATE::
+hash_value(const bool _memoize) const noexcept {
+  // The finalizer of MurmurHash3.
+  const auto mix = [](std::uint64_t _x) {
+    _x ^= _x >> 33;
+    _x *= 0xff51afd7ed558ccd;
+    _x ^= _x >> 33;
+    _x *= 0xc4ceb9fe1a85ec53;
+    _x ^= _x >> 33;
+    return _x;
+  };
+
+  const auto hash_text = [](const std::string_view _text) {
+    return static_cast<std::uint64_t>(std::hash<std::string_view>()(_text));
+  };
+
+  const auto type = get_type();
+  const auto seed = mix(static_cast<std::uint64_t>(type) + 1);
+
+  std::uint64_t hash = 0;
+  switch (type) {
+    case value_type::object:
+    case value_type::array: {
+      if(m_tag & hash_cached)
+        return get_cached_hash();
+
+      std::uint64_t combined = 0;
+      if(type == value_type::object) {
+        // Members are summed, so their order does not matter.
+        for(const auto& [key, value] : ref<object_type>()) {
+          std::uint64_t key_hash;
+          if constexpr(std::is_convertible_v<const string_type&,
+              std::string_view>)
+            key_hash = hash_text(std::string_view(key));
+          else
+            key_hash = std::hash<string_type>()(key);
+
+          combined += mix(key_hash ^
+              value.hash_value(_memoize) * 0x9e3779b97f4a7c15);
+        }
+      }
+      else {
+        for(const auto& element : ref<array_type>())
+          combined = mix(combined ^ element.hash_value(_memoize)) +
+            0x9e3779b97f4a7c15;
+      }
+
+      const auto size = type == value_type::object ?
+        ref<object_type>().size() : ref<array_type>().size();
+
+      // Containers hash to as many bits as they have room to memoize.
+      hash = mix(seed ^ combined ^ size) >> (64 - 8 * hash_size);
+
+      // Only memoize_hash(), which is not const, memoizes.
+      if(_memoize)
+        const_cast<basic_json&>(*this).set_cached_hash(hash);
+
+      return static_cast<std::size_t>(hash);
+    }
+    case value_type::string:
+      hash = hash_text(get_string());
+      break;
+    case value_type::number: {
+      const auto& value = ref<number_type>();
+      if constexpr(std::is_same_v<number_type, bstd::json::number>) {
+        // A number equal to a double hashes as that double, and an integer
+        // that no double equals, as itself; adding zero makes -0 into 0.
+        const auto floating_point = value.get_double() + 0.0;
+        if(value.is_integer() and bstd::json::number(floating_point) != value)
+          hash = value.get_uint64();
+        else
+          std::memcpy(&hash, &floating_point, sizeof(hash));
+      }
+      else if constexpr(std::is_arithmetic_v<number_type>) {
+        // Numbers that compare equal convert to the same double.
+        const auto floating_point = static_cast<double>(value) + 0.0;
+        std::memcpy(&hash, &floating_point, sizeof(hash));
+      }
+      else
+        hash = std::hash<number_type>()(value);
+      break;
+    }
+    case value_type::boolean:
+      hash = ref<boolean_type>() ? 1 : 0;
+      break;
+    case value_type::null:
+    default:
+      break;
+  }
+
+  return static_cast<std::size_t>(mix(seed ^ hash));
 }
 
 
 }
 
+
+BASIC_JSON_TEMPLATE_DECLARATION
+struct std::hash<bstd::json::BASIC_JSON_TEMPLATE> {
+  std::size_t operator()(
+      const bstd::json::BASIC_JSON_TEMPLATE& _json) const noexcept {
+    return _json.hash();
+  }
+};
+
 #endif
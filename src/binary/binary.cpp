@@ -0,0 +1,47 @@
+#include "binary.hpp"
+
+#include <stdexcept>
+
+
+namespace bstd::json::binary {
+
+
+void
+byte_reader::
+fail(const char* const _what) const {
+  throw std::invalid_argument(std::string(m_format) + ": " + _what +
+      " at byte " + std::to_string(get_offset()));
+}
+
+
+void
+append_base64url(const std::string_view _bytes, std::string& _text) {
+  constexpr char digits[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_";
+
+  const auto byte = [&_bytes](const std::size_t _i) {
+    return static_cast<std::uint32_t>(static_cast<unsigned char>(_bytes[_i]));
+  };
+
+  std::size_t i = 0;
+  for(; i + 3 <= _bytes.size(); i += 3) {
+    const auto bits = byte(i) << 16 | byte(i + 1) << 8 | byte(i + 2);
+    _text += digits[bits >> 18];
+    _text += digits[bits >> 12 & 0x3F];
+    _text += digits[bits >> 6 & 0x3F];
+    _text += digits[bits & 0x3F];
+  }
+
+  const auto rest = _bytes.size() - i;
+  if(rest == 0)
+    return;
+
+  const auto bits = byte(i) << 16 | (rest == 2 ? byte(i + 1) << 8 : 0);
+  _text += digits[bits >> 18];
+  _text += digits[bits >> 12 & 0x3F];
+  if(rest == 2)
+    _text += digits[bits >> 6 & 0x3F];
+}
+
+
+}
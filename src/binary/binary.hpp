@@ -0,0 +1,516 @@
+#ifndef BSTD_JSON_BINARY_HPP_
+#define BSTD_JSON_BINARY_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "number.hpp"
+#include "parser/dom_builder.hpp"
+#include "utilities/buffer_writer.hpp"
+
+namespace bstd::json::binary {
+
+/// \brief Writes bytes to the end of a caller's string.
+/// As with serializer::serializer, the string is a growable buffer managed by
+/// utilities::buffer_writer, so reusing one string between documents does
+/// not allocate.
+class byte_writer final {
+
+  public:
+
+    /// \brief Construct a writer that appends to a string.
+    /// \param _buffer the string to append to; must outlive the writer
+    explicit byte_writer(std::string& _buffer) noexcept : m_output(_buffer) {}
+
+    void write_byte(const std::uint8_t _byte) {
+      m_output.append(static_cast<char>(_byte));
+    }
+
+    /// \brief Write a byte followed by an unsigned integer, big-endian.
+    template<class T>
+      requires std::is_unsigned_v<T>
+    void write_big_endian(const std::uint8_t _byte, const T _value) {
+      auto out = m_output.reserve(1 + sizeof(T));
+      *out++ = static_cast<char>(_byte);
+      for(auto shift = 8 * static_cast<int>(sizeof(T)); shift != 0; )
+        *out++ = static_cast<char>(_value >> (shift -= 8));
+      m_output.commit(out);
+    }
+
+    void write_bytes(const std::string_view _bytes) {
+      m_output.append(_bytes);
+    }
+
+    /// \brief Trim the string to the bytes written so far.
+    void finish() { m_output.finish(); }
+
+  private:
+
+    utilities::buffer_writer m_output;
+
+};
+
+/// \brief Reads bytes from the front of a view.
+/// Callers check has() before reading.
+class byte_reader final {
+
+  public:
+
+    /// \brief Construct a reader.
+    /// \param _format the name of the format, for error messages
+    explicit byte_reader(const char* const _format) noexcept
+      : m_format(_format) {}
+
+    /// \brief Read from new data.
+    /// \param _data the data
+    /// \param _offset the offset of _data in the whole input
+    void reset(const std::string_view _data, const std::size_t _offset = 0)
+      noexcept {
+      m_data = _data;
+      m_position = 0;
+      m_offset = _offset;
+    }
+
+    /// \brief Get the position in the data.
+    std::size_t get_position() const noexcept { return m_position; }
+
+    /// \brief Go back to a position returned by get_position().
+    void set_position(const std::size_t _position) noexcept {
+      m_position = _position;
+    }
+
+    /// \brief Get the offset of the position in the whole input.
+    std::size_t get_offset() const noexcept { return m_offset + m_position; }
+
+    /// \brief Get the data not read yet.
+    std::string_view get_unread() const noexcept {
+      return m_data.substr(m_position);
+    }
+
+    /// \brief Check if at least _size bytes are left.
+    bool has(const std::size_t _size) const noexcept {
+      return m_data.size() - m_position >= _size;
+    }
+
+    std::uint8_t read_byte() noexcept {
+      return static_cast<std::uint8_t>(m_data[m_position++]);
+    }
+
+    /// \brief Read an unsigned integer, big-endian.
+    template<class T>
+      requires std::is_unsigned_v<T>
+    T read_big_endian() noexcept {
+      T value = 0;
+      for(std::size_t i = 0; i < sizeof(T); ++i)
+        value = static_cast<T>(value << 8 | read_byte());
+      return value;
+    }
+
+    std::string_view read_bytes(const std::size_t _size) noexcept {
+      const auto bytes = m_data.substr(m_position, _size);
+      m_position += _size;
+      return bytes;
+    }
+
+    /// \brief Get a buffer for text that is not in the data as is, such as
+    ///        joined chunks or base64url.
+    std::string& get_scratch() noexcept { return m_scratch; }
+
+    /// \brief Report malformed data at the position.
+    /// \throws std::invalid_argument always
+    [[noreturn]] void fail(const char* const _what) const;
+
+  private:
+
+    const char* m_format;
+
+    std::string_view m_data;
+
+    std::size_t m_position{0};
+
+    /// The offset of m_data in the whole input.
+    std::size_t m_offset{0};
+
+    std::string m_scratch;
+
+};
+
+/// \brief A data item, as decoded by a format: a scalar, the start of a
+///        container, or the end of a container of unknown size.
+struct item {
+
+  enum class kind : std::uint8_t {
+    null,
+    boolean,
+    integer,
+    unsigned_integer,
+    floating_point,
+    string,
+    array,
+    object,
+    end
+  };
+
+  /// The size of a container that is closed by an item of kind end.
+  static constexpr std::uint64_t indefinite =
+    std::numeric_limits<std::uint64_t>::max();
+
+  kind m_kind{kind::null};
+
+  bool m_boolean{false};
+
+  std::int64_t m_integer{0};
+
+  /// Unsigned integers, and the number of elements or members of containers.
+  std::uint64_t m_unsigned{0};
+
+  double m_floating_point{0};
+
+  /// Valid UTF-8, in the data or the reader's scratch buffer.
+  std::string_view m_string;
+
+};
+
+/// \brief Append bytes as base64url without padding, which is how RFC 8949
+///        converts byte strings to JSON.
+/// \param _bytes the bytes
+/// \param _text the string to append to
+void append_base64url(const std::string_view _bytes, std::string& _text);
+
+/// \brief Write a value with a format's writer.
+/// Containers are written without recursion, as by serializer::serializer.
+/// \tparam Writer a writer with write_null(), write_boolean(),
+///         write_number(), write_string(), begin_array(size) and
+///         begin_object(size)
+/// \tparam Json a basic_json
+template<class Writer, class Json>
+void write_value(Writer& _writer, const Json& _json);
+
+/// \brief Decodes a stream of binary values into basic_json trees.
+/// Decoded items are pushed straight into a parser::dom_builder, without text
+/// or the lexer: strings are constructed once from the data, each container
+/// is built at its final size, and nesting depth does not consume call
+/// stack. Data can arrive in chunks: a value that is cut off is kept as far
+/// as it was built, and only its last, partial item is read again when the
+/// next chunk is fed.
+/// \tparam Json a basic_json
+/// \tparam Format a format with `static constexpr const char* name` and
+///         `static bool read_item(byte_reader&, item&)`, which reads one item
+///         or returns false if the data ends first
+template<class Json, class Format>
+class basic_reader final {
+
+  public:
+
+    using json_type = Json;
+    using number_type = typename Json::number_type;
+    using boolean_type = typename Json::boolean_type;
+    using null_type = typename Json::null_type;
+    using allocator_type =
+      typename parser::dom_builder<Json>::allocator_type;
+
+    /// \brief Construct a reader that is fed chunks.
+    /// \param _allocator the allocator for all strings, arrays and objects
+    explicit basic_reader(const allocator_type& _allocator = allocator_type())
+      : m_input(Format::name), m_builder(_allocator) {}
+
+    /// \brief Construct a reader of data in memory, which is not copied.
+    /// \param _data the data; must outlive the reader, or until feed()
+    /// \param _allocator the allocator for all strings, arrays and objects
+    explicit basic_reader(const std::string_view _data,
+        const allocator_type& _allocator = allocator_type())
+      : basic_reader(_allocator) {
+      m_input.reset(_data);
+    }
+
+    /// \brief Append a chunk of data.
+    /// Bytes not read yet are copied into the reader with the chunk.
+    /// \param _chunk the next part of the data
+    void feed(const std::string_view _chunk);
+
+    /// \brief Decode the next value.
+    /// \return the value, or nothing if the data ends before it does
+    /// \throws std::invalid_argument if the data is malformed, or holds
+    ///         what a basic_json cannot, such as non-string keys
+    std::optional<Json> next();
+
+    /// \brief Get the number of bytes decoded, including the part of a value
+    ///        that is cut off.
+    std::size_t get_offset() const noexcept { return m_input.get_offset(); }
+
+    /// \brief Check if a value has been started but not finished.
+    bool is_partial() const noexcept { return !m_frames.empty(); }
+
+  private:
+
+    /// An open container.
+    struct frame {
+      std::uint64_t m_remaining;
+      bool m_is_object;
+      bool m_has_key;
+    };
+
+    /// \brief Add a scalar to the tree.
+    void add_value(const item& _item);
+
+    /// \brief Close the innermost container.
+    void close();
+
+    byte_reader m_input;
+
+    parser::dom_builder<Json> m_builder;
+
+    std::vector<frame> m_frames;
+
+    /// The data once a chunk has been fed.
+    std::string m_buffer;
+    bool m_owned{false};
+
+};
+
+/// \brief Decode the one value some data holds.
+/// \tparam Json the basic_json type to build
+/// \tparam Format a format, as for basic_reader
+/// \param _data the data
+/// \return the value
+/// \throws std::invalid_argument if the data is malformed, incomplete or
+///         followed by more data
+template<class Json, class Format>
+Json read_value(const std::string_view _data);
+
+/// \brief Convert a decoded number to a basic_json's number type.
+template<class Number, class T>
+Number
+make_number(const T _value) {
+  if constexpr(std::is_same_v<Number, number> or std::is_arithmetic_v<Number>)
+    return Number(_value);
+  else
+    return static_cast<Number>(static_cast<double>(_value));
+}
+
+
+template<class Writer, class Json>
+void
+write_value(Writer& _writer, const Json& _json) {
+  using value_type = typename Json::value_type;
+  using object_type = typename Json::object_type;
+  using array_type = typename Json::array_type;
+
+  /// An open, non-empty container.
+  struct frame {
+    typename object_type::const_iterator m_member;
+    typename object_type::const_iterator m_members_end;
+    typename array_type::const_iterator m_element;
+    typename array_type::const_iterator m_elements_end;
+    bool m_is_object;
+  };
+
+  std::vector<frame> frames;
+
+  // Write a value, or open it if it is a non-empty container.
+  const auto write = [&_writer, &frames](const Json& _value) {
+    switch(_value.get_type()) {
+      case value_type::object: {
+        const auto& object = _value.template get<object_type>();
+        _writer.begin_object(object.size());
+        if(!object.empty())
+          frames.push_back({object.begin(), object.end(), {}, {}, true});
+        break;
+      }
+      case value_type::array: {
+        const auto& array = _value.template get<array_type>();
+        _writer.begin_array(array.size());
+        if(!array.empty())
+          frames.push_back({{}, {}, array.begin(), array.end(), false});
+        break;
+      }
+      case value_type::string:
+        _writer.write_string(_value.get_string());
+        break;
+      case value_type::number:
+        _writer.write_number(
+            _value.template get<typename Json::number_type>());
+        break;
+      case value_type::boolean:
+        _writer.write_boolean(
+            _value.template get<typename Json::boolean_type>());
+        break;
+      case value_type::null:
+        _writer.write_null();
+        break;
+    }
+  };
+
+  write(_json);
+  while(!frames.empty()) {
+    auto& top = frames.back();
+    if(top.m_is_object ? top.m_member == top.m_members_end :
+        top.m_element == top.m_elements_end) {
+      frames.pop_back();
+      continue;
+    }
+
+    // top is invalidated by opening another container.
+    if(top.m_is_object) {
+      const auto& member = *top.m_member++;
+      _writer.write_string(std::string_view(member.first));
+      write(member.second);
+    }
+    else
+      write(*top.m_element++);
+  }
+}
+
+
+template<class Json, class Format>
+Json
+read_value(const std::string_view _data) {
+  basic_reader<Json, Format> reader(_data);
+  auto value = reader.next();
+  if(!value)
+    throw std::invalid_argument(std::string(Format::name) +
+        ": unexpected end of data at byte " +
+        std::to_string(reader.get_offset()));
+  if(reader.get_offset() != _data.size())
+    throw std::invalid_argument(std::string(Format::name) +
+        ": unexpected data after the value at byte " +
+        std::to_string(reader.get_offset()));
+
+  return std::move(*value);
+}
+
+
+template<class Json, class Format>
+void
+basic_reader<Json, Format>::
+feed(const std::string_view _chunk) {
+  const auto unread = m_input.get_unread();
+  const auto offset = m_input.get_offset();
+  if(m_owned)
+    m_buffer.erase(0, m_buffer.size() - unread.size());
+  else
+    m_buffer.assign(unread);
+
+  m_buffer.append(_chunk);
+  m_owned = true;
+  m_input.reset(m_buffer, offset);
+}
+
+
+template<class Json, class Format>
+std::optional<Json>
+basic_reader<Json, Format>::
+next() {
+  item next_item;
+  while(true) {
+    // Only complete items change the tree, so a cut off item is read again.
+    const auto position = m_input.get_position();
+    if(!Format::read_item(m_input, next_item)) {
+      m_input.set_position(position);
+      return std::nullopt;
+    }
+
+    const auto in_object = !m_frames.empty() and m_frames.back().m_is_object;
+    if(next_item.m_kind == item::kind::end) {
+      if(m_frames.empty() or m_frames.back().m_remaining != item::indefinite)
+        m_input.fail("unexpected break");
+      if(in_object and m_frames.back().m_has_key)
+        m_input.fail("missing value after key");
+      close();
+    }
+    else if(in_object and !m_frames.back().m_has_key) {
+      if(next_item.m_kind != item::kind::string)
+        m_input.fail("keys must be strings");
+      m_builder.decoded_key(next_item.m_string);
+      m_frames.back().m_has_key = true;
+      continue;
+    }
+    else if(next_item.m_kind == item::kind::array or
+        next_item.m_kind == item::kind::object) {
+      const auto is_object = next_item.m_kind == item::kind::object;
+      m_frames.push_back({next_item.m_unsigned, is_object, false});
+      if(is_object)
+        m_builder.begin_object();
+      else
+        m_builder.begin_array();
+
+      if(next_item.m_unsigned != 0)
+        continue;
+
+      close();
+    }
+    else
+      add_value(next_item);
+
+    // Count the value in its container, closing each container it completes.
+    while(!m_frames.empty()) {
+      auto& top = m_frames.back();
+      top.m_has_key = false;
+      if(top.m_remaining == item::indefinite or --top.m_remaining != 0)
+        break;
+
+      close();
+    }
+
+    if(m_frames.empty())
+      return m_builder.release();
+  }
+}
+
+
+template<class Json, class Format>
+void
+basic_reader<Json, Format>::
+add_value(const item& _item) {
+  switch(_item.m_kind) {
+    case item::kind::boolean:
+      m_builder.value(Json(boolean_type{_item.m_boolean}));
+      break;
+    case item::kind::integer:
+      m_builder.value(Json(make_number<number_type>(_item.m_integer)));
+      break;
+    case item::kind::unsigned_integer:
+      m_builder.value(Json(make_number<number_type>(_item.m_unsigned)));
+      break;
+    case item::kind::floating_point:
+      m_builder.value(Json(make_number<number_type>(
+              _item.m_floating_point)));
+      break;
+    case item::kind::string:
+      m_builder.decoded_string(_item.m_string);
+      break;
+    case item::kind::null:
+    case item::kind::array:
+    case item::kind::object:
+    case item::kind::end:
+    default:
+      m_builder.null();
+      break;
+  }
+}
+
+
+template<class Json, class Format>
+void
+basic_reader<Json, Format>::
+close() {
+  if(m_frames.back().m_is_object)
+    m_builder.end_object();
+  else
+    m_builder.end_array();
+
+  m_frames.pop_back();
+}
+
+
+}
+
+#endif
@@ -0,0 +1,391 @@
+#include "cbor.hpp"
+
+#include <cmath>
+#include <limits>
+
+#include "parser/utf8.hpp"
+
+
+namespace bstd::json::binary {
+
+
+namespace {
+
+
+enum major_type : std::uint8_t {
+  unsigned_integer = 0,
+  negative_integer = 1,
+  byte_string = 2,
+  text_string = 3,
+  array = 4,
+  map = 5,
+  tag = 6,
+  simple = 7
+};
+
+
+/// The additional information of items of unknown length, and of break.
+constexpr std::uint8_t indefinite_length = 31;
+
+
+/// \brief Read the argument that follows an initial byte.
+/// \param _info the additional information of the initial byte
+/// \return false if the data ends first
+bool
+read_argument(byte_reader& _input, const std::uint8_t _info,
+    std::uint64_t& _argument) {
+  switch(_info) {
+    case 24:
+      if(!_input.has(1))
+        return false;
+      _argument = _input.read_byte();
+      return true;
+    case 25:
+      if(!_input.has(2))
+        return false;
+      _argument = _input.read_big_endian<std::uint16_t>();
+      return true;
+    case 26:
+      if(!_input.has(4))
+        return false;
+      _argument = _input.read_big_endian<std::uint32_t>();
+      return true;
+    case 27:
+      if(!_input.has(8))
+        return false;
+      _argument = _input.read_big_endian<std::uint64_t>();
+      return true;
+    default:
+      if(_info >= 24)
+        _input.fail("reserved additional information");
+      _argument = _info;
+      return true;
+  }
+}
+
+
+/// \brief Read the bytes of a string of known length.
+/// \return false if the data ends first
+bool
+read_bytes(byte_reader& _input, const std::uint64_t _size,
+    std::string_view& _bytes) {
+  if(_size > std::numeric_limits<std::size_t>::max() or
+      !_input.has(static_cast<std::size_t>(_size)))
+    return false;
+
+  _bytes = _input.read_bytes(static_cast<std::size_t>(_size));
+  return true;
+}
+
+
+/// \brief Read a string of unknown length, as chunks of known length ended
+///        by a break, into the scratch buffer.
+/// \return false if the data ends first
+bool
+read_chunks(byte_reader& _input, const major_type _type,
+    std::string_view& _bytes) {
+  auto& joined = _input.get_scratch();
+  joined.clear();
+
+  while(true) {
+    if(!_input.has(1))
+      return false;
+
+    const auto initial = _input.read_byte();
+    if(initial == 0xFF)
+      break;
+    if(initial >> 5 != _type or (initial & 0x1F) == indefinite_length)
+      _input.fail("invalid chunk in a string of unknown length");
+
+    std::uint64_t size;
+    std::string_view chunk;
+    if(!read_argument(_input, initial & 0x1F, size) or
+        !read_bytes(_input, size, chunk))
+      return false;
+
+    joined += chunk;
+  }
+
+  _bytes = joined;
+  return true;
+}
+
+
+/// \brief Decode a half precision float.
+double
+decode_half(const std::uint16_t _half) noexcept {
+  const auto exponent = _half >> 10 & 0x1F;
+  const auto mantissa = _half & 0x3FF;
+
+  double value;
+  if(exponent == 0)
+    value = std::ldexp(mantissa, -24);
+  else if(exponent != 31)
+    value = std::ldexp(mantissa + 1024, exponent - 25);
+  else if(mantissa == 0)
+    value = std::numeric_limits<double>::infinity();
+  else
+    value = std::numeric_limits<double>::quiet_NaN();
+
+  return _half & 0x8000 ? -value : value;
+}
+
+
+/// \brief Encode a float as half precision, if that holds it exactly.
+/// \return false if it does not
+bool
+encode_half(const float _single, std::uint16_t& _half) noexcept {
+  std::uint32_t bits;
+  std::memcpy(&bits, &_single, sizeof(bits));
+
+  const auto sign = static_cast<std::uint16_t>(bits >> 16 & 0x8000);
+  const auto exponent = static_cast<int>(bits >> 23 & 0xFF);
+  const auto mantissa = bits & 0x7FFFFF;
+
+  // Infinities and NaN, which are all written as the same quiet NaN.
+  if(exponent == 0xFF) {
+    _half = mantissa == 0 ? static_cast<std::uint16_t>(sign | 0x7C00) :
+      std::uint16_t{0x7E00};
+    return true;
+  }
+
+  // Zeros; single precision subnormals are too small for half precision.
+  if(exponent == 0) {
+    _half = sign;
+    return mantissa == 0;
+  }
+
+  const auto unbiased = exponent - 127;
+  if(unbiased > 15 or unbiased < -24)
+    return false;
+
+  if(unbiased >= -14) {
+    _half = static_cast<std::uint16_t>(sign | (unbiased + 15) << 10 |
+        mantissa >> 13);
+    return (mantissa & 0x1FFF) == 0;
+  }
+
+  // Half precision subnormals count units of 2^-24.
+  const auto significand = mantissa | 0x800000;
+  const auto shift = -1 - unbiased;
+  _half = static_cast<std::uint16_t>(sign | significand >> shift);
+  return (significand & ((1u << shift) - 1)) == 0;
+}
+
+
+}
+
+
+void
+cbor_writer::
+write_number(const number& _number) {
+  auto decoded = _number;
+  decoded.decode();
+
+  switch(decoded.get_kind()) {
+    case number::kind::integer: {
+      // The argument of a negative integer n is -1 - n, which is ~n.
+      const auto integer = decoded.get_int64();
+      if(integer >= 0)
+        write_head(unsigned_integer, static_cast<std::uint64_t>(integer));
+      else
+        write_head(negative_integer, ~static_cast<std::uint64_t>(integer));
+      break;
+    }
+    case number::kind::unsigned_integer:
+      write_head(unsigned_integer, decoded.get_uint64());
+      break;
+    default:
+      write_floating_point(decoded.get_double());
+      break;
+  }
+}
+
+
+void
+cbor_writer::
+write_string(const std::string_view _string) {
+  write_head(text_string, _string.size());
+  m_output.write_bytes(_string);
+}
+
+
+void
+cbor_writer::
+write_head(const major_type _type, const std::uint64_t _argument) {
+  const auto initial = static_cast<std::uint8_t>(_type << 5);
+  if(_argument < 24)
+    m_output.write_byte(static_cast<std::uint8_t>(initial | _argument));
+  else if(_argument <= 0xFF)
+    m_output.write_big_endian(initial | 24,
+        static_cast<std::uint8_t>(_argument));
+  else if(_argument <= 0xFFFF)
+    m_output.write_big_endian(initial | 25,
+        static_cast<std::uint16_t>(_argument));
+  else if(_argument <= 0xFFFFFFFF)
+    m_output.write_big_endian(initial | 26,
+        static_cast<std::uint32_t>(_argument));
+  else
+    m_output.write_big_endian(initial | 27, _argument);
+}
+
+
+void
+cbor_writer::
+write_floating_point(const double _value) {
+  const auto is_single = !std::isfinite(_value) or
+    (std::abs(_value) <= std::numeric_limits<float>::max() and
+     static_cast<float>(_value) == _value);
+  if(!is_single) {
+    std::uint64_t bits;
+    std::memcpy(&bits, &_value, sizeof(bits));
+    m_output.write_big_endian(0xFB, bits);
+    return;
+  }
+
+  const auto single = static_cast<float>(_value);
+  if(std::uint16_t half; encode_half(single, half)) {
+    m_output.write_big_endian(0xF9, half);
+    return;
+  }
+
+  std::uint32_t bits;
+  std::memcpy(&bits, &single, sizeof(bits));
+  m_output.write_big_endian(0xFA, bits);
+}
+
+
+bool
+cbor_format::
+read_item(byte_reader& _input, item& _item) {
+  // Tags are skipped, and the item they tag read instead.
+  while(true) {
+    if(!_input.has(1))
+      return false;
+
+    const auto initial = _input.read_byte();
+    const auto type = static_cast<major_type>(initial >> 5);
+    const auto info = static_cast<std::uint8_t>(initial & 0x1F);
+
+    if(type == simple) {
+      switch(info) {
+        case 20:
+        case 21:
+          _item.m_kind = item::kind::boolean;
+          _item.m_boolean = info == 21;
+          return true;
+        case 24:
+          if(!_input.has(1))
+            return false;
+          if(_input.read_byte() < 32)
+            _input.fail("invalid simple value");
+          _item.m_kind = item::kind::null;
+          return true;
+        case 25:
+          if(!_input.has(2))
+            return false;
+          _item.m_kind = item::kind::floating_point;
+          _item.m_floating_point =
+            decode_half(_input.read_big_endian<std::uint16_t>());
+          return true;
+        case 26: {
+          if(!_input.has(4))
+            return false;
+          const auto bits = _input.read_big_endian<std::uint32_t>();
+          float single;
+          std::memcpy(&single, &bits, sizeof(single));
+          _item.m_kind = item::kind::floating_point;
+          _item.m_floating_point = single;
+          return true;
+        }
+        case 27: {
+          if(!_input.has(8))
+            return false;
+          const auto bits = _input.read_big_endian<std::uint64_t>();
+          _item.m_kind = item::kind::floating_point;
+          std::memcpy(&_item.m_floating_point, &bits, sizeof(bits));
+          return true;
+        }
+        case indefinite_length:
+          _item.m_kind = item::kind::end;
+          return true;
+        default:
+          if(info > 24)
+            _input.fail("reserved additional information");
+          // null, undefined and unassigned simple values.
+          _item.m_kind = item::kind::null;
+          return true;
+      }
+    }
+
+    std::uint64_t argument = item::indefinite;
+    if(info == indefinite_length) {
+      if(type != byte_string and type != text_string and type != array and
+          type != map)
+        _input.fail("unknown length for a type that has none");
+    }
+    else if(!read_argument(_input, info, argument))
+      return false;
+
+    switch(type) {
+      case unsigned_integer:
+        if(argument > static_cast<std::uint64_t>(
+              std::numeric_limits<std::int64_t>::max())) {
+          _item.m_kind = item::kind::unsigned_integer;
+          _item.m_unsigned = argument;
+        }
+        else {
+          _item.m_kind = item::kind::integer;
+          _item.m_integer = static_cast<std::int64_t>(argument);
+        }
+        return true;
+      case negative_integer:
+        // -1 - argument, which is below std::int64_t for large arguments.
+        if(argument > static_cast<std::uint64_t>(
+              std::numeric_limits<std::int64_t>::max())) {
+          _item.m_kind = item::kind::floating_point;
+          _item.m_floating_point = -1.0 - static_cast<double>(argument);
+        }
+        else {
+          _item.m_kind = item::kind::integer;
+          _item.m_integer = -1 - static_cast<std::int64_t>(argument);
+        }
+        return true;
+      case byte_string:
+      case text_string: {
+        std::string_view bytes;
+        if(info == indefinite_length ? !read_chunks(_input, type, bytes) :
+            !read_bytes(_input, argument, bytes))
+          return false;
+
+        _item.m_kind = item::kind::string;
+        if(type == byte_string) {
+          // The bytes may be in the scratch buffer already.
+          std::string text;
+          append_base64url(bytes, text);
+          _input.get_scratch().swap(text);
+          _item.m_string = _input.get_scratch();
+          return true;
+        }
+
+        const auto last = bytes.data() + bytes.size();
+        if(parser::validate_utf8(bytes.data(), last) != last)
+          _input.fail("invalid UTF-8");
+        _item.m_string = bytes;
+        return true;
+      }
+      case array:
+      case map:
+        _item.m_kind = type == array ? item::kind::array : item::kind::object;
+        _item.m_unsigned = argument;
+        return true;
+      case tag:
+      case simple:
+      default:
+        continue;
+    }
+  }
+}
+
+
+}
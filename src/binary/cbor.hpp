@@ -0,0 +1,168 @@
+#ifndef BSTD_JSON_CBOR_HPP_
+#define BSTD_JSON_CBOR_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "basic_json.hpp"
+#include "binary.hpp"
+#include "number.hpp"
+
+namespace bstd::json::binary {
+
+/// \brief Writes CBOR (RFC 8949) to the end of a caller's string.
+/// Output uses the preferred serialization: every integer, length and size
+/// in its shortest head, and every double as the shortest of half, single
+/// and double precision that holds it exactly. The buffer is managed as by
+/// byte_writer, and each write() appends one data item, so a writer kept
+/// across calls writes a CBOR sequence (RFC 8742).
+/// Values can also be written piece by piece: a container of known size is
+/// begun with its size and then given exactly that many elements, or
+/// members as keys and values, and one of unknown size is begun without a
+/// size and closed with end().
+class cbor_writer final {
+
+  public:
+
+    /// \brief Construct a writer that appends to a string.
+    /// \param _buffer the string to append to; must outlive the writer
+    explicit cbor_writer(std::string& _buffer) noexcept : m_output(_buffer) {}
+
+    /// \brief Write a JSON value.
+    /// \tparam Json a basic_json
+    /// \param _json the value
+    template<class Json>
+    void write(const Json& _json) { write_value(*this, _json); }
+
+    void write_null() { m_output.write_byte(0xF6); }
+
+    void write_boolean(const bool _boolean) {
+      m_output.write_byte(_boolean ? 0xF5 : 0xF4);
+    }
+
+    /// \brief Write a number as an integer if it is one, and otherwise as a
+    ///        floating point value.
+    /// \param _number the number
+    void write_number(const number& _number);
+
+    /// \copydoc write_number()
+    template<class T>
+      requires std::is_arithmetic_v<T>
+    void write_number(const T _number) { write_number(number(_number)); }
+
+    /// \brief Write a text string, or a key.
+    /// \param _string the string, which must be valid UTF-8
+    void write_string(const std::string_view _string);
+
+    /// \brief Begin an array of _size elements.
+    void begin_array(const std::size_t _size) { write_head(array, _size); }
+
+    /// \brief Begin a map of _size members.
+    void begin_object(const std::size_t _size) { write_head(map, _size); }
+
+    /// \brief Begin an array of unknown size, closed by end().
+    void begin_array() { m_output.write_byte(0x9F); }
+
+    /// \brief Begin a map of unknown size, closed by end().
+    void begin_object() { m_output.write_byte(0xBF); }
+
+    /// \brief Close the innermost container of unknown size.
+    void end() { m_output.write_byte(0xFF); }
+
+    /// \brief Trim the string to the bytes written so far.
+    void finish() { m_output.finish(); }
+
+  private:
+
+    enum major_type : std::uint8_t {
+      unsigned_integer = 0,
+      negative_integer = 1,
+      text_string = 3,
+      array = 4,
+      map = 5
+    };
+
+    /// \brief Write the head of a data item in its shortest form.
+    void write_head(const major_type _type, const std::uint64_t _argument);
+
+    void write_floating_point(const double _value);
+
+    byte_writer m_output;
+
+};
+
+/// \brief Reads CBOR data items for basic_reader.
+/// Every well-formed data item is accepted, and converted to JSON as RFC
+/// 8949 section 6.1 recommends: tags are dropped in favor of the item they
+/// tag, byte strings become base64url strings, and undefined and other
+/// simple values become null. Text strings must be valid UTF-8, and map
+/// keys must be text strings.
+struct cbor_format {
+
+  static constexpr const char* name = "cbor";
+
+  /// \brief Read one data item, or the break that ends a container.
+  /// \return false if the data ends before the item does
+  /// \throws std::invalid_argument if the data is malformed
+  static bool read_item(byte_reader& _input, item& _item);
+
+};
+
+/// \brief Decodes a stream of CBOR data items, such as a CBOR sequence.
+template<class Json>
+using cbor_reader = basic_reader<Json, cbor_format>;
+
+/// \brief Encode a JSON value as CBOR, appending it to a string.
+/// \tparam Json a basic_json
+/// \param _json the value
+/// \param _buffer the string to append to
+template<class Json>
+void to_cbor(const Json& _json, std::string& _buffer);
+
+/// \brief Encode a JSON value as CBOR.
+/// \tparam Json a basic_json
+/// \param _json the value
+/// \return the CBOR data
+template<class Json>
+std::string to_cbor(const Json& _json);
+
+/// \brief Decode one CBOR data item.
+/// \tparam Json the basic_json type to build
+/// \param _data the data, which must hold exactly one data item
+/// \return the value
+/// \throws std::invalid_argument if the data is malformed, incomplete or
+///         followed by more data
+template<class Json = json>
+Json from_cbor(const std::string_view _data);
+
+
+template<class Json>
+void
+to_cbor(const Json& _json, std::string& _buffer) {
+  cbor_writer writer(_buffer);
+  writer.write(_json);
+}
+
+
+template<class Json>
+std::string
+to_cbor(const Json& _json) {
+  std::string buffer;
+  to_cbor(_json, buffer);
+  return buffer;
+}
+
+
+template<class Json>
+Json
+from_cbor(const std::string_view _data) {
+  return read_value<Json, cbor_format>(_data);
+}
+
+
+}
+
+#endif
@@ -0,0 +1,310 @@
+#include "msgpack.hpp"
+
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "parser/utf8.hpp"
+
+
+namespace bstd::json::binary {
+
+
+namespace {
+
+
+/// \brief Read a length of 1, 2 or 4 bytes.
+/// \return false if the data ends first
+bool
+read_length(byte_reader& _input, const std::uint8_t _width,
+    std::uint64_t& _length) {
+  if(!_input.has(_width))
+    return false;
+
+  switch(_width) {
+    case 1:
+      _length = _input.read_byte();
+      break;
+    case 2:
+      _length = _input.read_big_endian<std::uint16_t>();
+      break;
+    default:
+      _length = _input.read_big_endian<std::uint32_t>();
+      break;
+  }
+
+  return true;
+}
+
+
+/// \brief Read a str or bin object's bytes into a string item.
+/// \return false if the data ends first
+bool
+read_string(byte_reader& _input, const std::uint64_t _size, const bool _text,
+    item& _item) {
+  if(!_input.has(static_cast<std::size_t>(_size)))
+    return false;
+
+  const auto bytes = _input.read_bytes(static_cast<std::size_t>(_size));
+  _item.m_kind = item::kind::string;
+  if(!_text) {
+    auto& text = _input.get_scratch();
+    text.clear();
+    append_base64url(bytes, text);
+    _item.m_string = text;
+    return true;
+  }
+
+  const auto last = bytes.data() + bytes.size();
+  if(parser::validate_utf8(bytes.data(), last) != last)
+    _input.fail("invalid UTF-8");
+  _item.m_string = bytes;
+  return true;
+}
+
+
+/// \brief Set an integer item.
+template<class T>
+void
+set_integer(item& _item, const T _integer) {
+  if constexpr(std::is_same_v<T, std::uint64_t>)
+    if(_integer > static_cast<std::uint64_t>(
+          std::numeric_limits<std::int64_t>::max())) {
+      _item.m_kind = item::kind::unsigned_integer;
+      _item.m_unsigned = _integer;
+      return;
+    }
+
+  _item.m_kind = item::kind::integer;
+  _item.m_integer = static_cast<std::int64_t>(_integer);
+}
+
+
+}
+
+
+void
+msgpack_writer::
+write_number(const number& _number) {
+  auto decoded = _number;
+  decoded.decode();
+
+  if(decoded.get_kind() == number::kind::unsigned_integer) {
+    m_output.write_big_endian(0xCF, decoded.get_uint64());
+    return;
+  }
+
+  if(decoded.get_kind() == number::kind::floating_point) {
+    const auto value = decoded.get_double();
+    const auto is_single = !std::isfinite(value) or
+      (std::abs(value) <= std::numeric_limits<float>::max() and
+       static_cast<float>(value) == value);
+    if(is_single) {
+      const auto single = static_cast<float>(value);
+      std::uint32_t bits;
+      std::memcpy(&bits, &single, sizeof(bits));
+      m_output.write_big_endian(0xCA, bits);
+    }
+    else {
+      std::uint64_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+      m_output.write_big_endian(0xCB, bits);
+    }
+    return;
+  }
+
+  // Fix ints hold -32 to 127 in the format byte itself.
+  const auto integer = decoded.get_int64();
+  if(integer >= -32 and integer <= 127)
+    m_output.write_byte(static_cast<std::uint8_t>(integer));
+  else if(integer > 0) {
+    const auto value = static_cast<std::uint64_t>(integer);
+    if(value <= 0xFF)
+      m_output.write_big_endian(0xCC, static_cast<std::uint8_t>(value));
+    else if(value <= 0xFFFF)
+      m_output.write_big_endian(0xCD, static_cast<std::uint16_t>(value));
+    else if(value <= 0xFFFFFFFF)
+      m_output.write_big_endian(0xCE, static_cast<std::uint32_t>(value));
+    else
+      m_output.write_big_endian(0xCF, value);
+  }
+  else if(integer >= std::numeric_limits<std::int8_t>::min())
+    m_output.write_big_endian(0xD0, static_cast<std::uint8_t>(integer));
+  else if(integer >= std::numeric_limits<std::int16_t>::min())
+    m_output.write_big_endian(0xD1, static_cast<std::uint16_t>(integer));
+  else if(integer >= std::numeric_limits<std::int32_t>::min())
+    m_output.write_big_endian(0xD2, static_cast<std::uint32_t>(integer));
+  else
+    m_output.write_big_endian(0xD3, static_cast<std::uint64_t>(integer));
+}
+
+
+void
+msgpack_writer::
+write_string(const std::string_view _string) {
+  if(_string.size() < 32)
+    m_output.write_byte(static_cast<std::uint8_t>(0xA0 | _string.size()));
+  else if(_string.size() <= 0xFF)
+    m_output.write_big_endian(0xD9,
+        static_cast<std::uint8_t>(_string.size()));
+  else
+    write_size(_string.size(), 0xDA);
+
+  m_output.write_bytes(_string);
+}
+
+
+void
+msgpack_writer::
+begin_array(const std::size_t _size) {
+  if(_size < 16)
+    m_output.write_byte(static_cast<std::uint8_t>(0x90 | _size));
+  else
+    write_size(_size, 0xDC);
+}
+
+
+void
+msgpack_writer::
+begin_object(const std::size_t _size) {
+  if(_size < 16)
+    m_output.write_byte(static_cast<std::uint8_t>(0x80 | _size));
+  else
+    write_size(_size, 0xDE);
+}
+
+
+void
+msgpack_writer::
+write_size(const std::size_t _size, const std::uint8_t _format_16) {
+  if(_size <= 0xFFFF)
+    m_output.write_big_endian(_format_16, static_cast<std::uint16_t>(_size));
+  else if(_size <= 0xFFFFFFFF)
+    m_output.write_big_endian(static_cast<std::uint8_t>(_format_16 + 1),
+        static_cast<std::uint32_t>(_size));
+  else
+    throw std::length_error("msgpack: size does not fit in 32 bits");
+}
+
+
+bool
+msgpack_format::
+read_item(byte_reader& _input, item& _item) {
+  if(!_input.has(1))
+    return false;
+
+  const auto format = _input.read_byte();
+
+  // Fix formats hold their value or size in the format byte.
+  if(format <= 0x7F or format >= 0xE0) {
+    _item.m_kind = item::kind::integer;
+    _item.m_integer = static_cast<std::int8_t>(format);
+    return true;
+  }
+  if(format <= 0x8F or (format >= 0x90 and format <= 0x9F)) {
+    _item.m_kind = format <= 0x8F ? item::kind::object : item::kind::array;
+    _item.m_unsigned = format & 0x0F;
+    return true;
+  }
+  if(format <= 0xBF)
+    return read_string(_input, format & 0x1F, true, _item);
+
+  std::uint64_t size;
+  switch(format) {
+    case 0xC0:
+      _item.m_kind = item::kind::null;
+      return true;
+    case 0xC2:
+    case 0xC3:
+      _item.m_kind = item::kind::boolean;
+      _item.m_boolean = format == 0xC3;
+      return true;
+    case 0xC4:
+    case 0xC5:
+    case 0xC6:
+      return read_length(_input, static_cast<std::uint8_t>(1 << (format -
+              0xC4)), size) and read_string(_input, size, false, _item);
+    case 0xCA: {
+      if(!_input.has(4))
+        return false;
+      const auto bits = _input.read_big_endian<std::uint32_t>();
+      float single;
+      std::memcpy(&single, &bits, sizeof(single));
+      _item.m_kind = item::kind::floating_point;
+      _item.m_floating_point = single;
+      return true;
+    }
+    case 0xCB: {
+      if(!_input.has(8))
+        return false;
+      const auto bits = _input.read_big_endian<std::uint64_t>();
+      _item.m_kind = item::kind::floating_point;
+      std::memcpy(&_item.m_floating_point, &bits, sizeof(bits));
+      return true;
+    }
+    case 0xCC:
+      if(!_input.has(1))
+        return false;
+      set_integer(_item, _input.read_byte());
+      return true;
+    case 0xCD:
+      if(!_input.has(2))
+        return false;
+      set_integer(_item, _input.read_big_endian<std::uint16_t>());
+      return true;
+    case 0xCE:
+      if(!_input.has(4))
+        return false;
+      set_integer(_item, _input.read_big_endian<std::uint32_t>());
+      return true;
+    case 0xCF:
+      if(!_input.has(8))
+        return false;
+      set_integer(_item, _input.read_big_endian<std::uint64_t>());
+      return true;
+    case 0xD0:
+      if(!_input.has(1))
+        return false;
+      set_integer(_item, static_cast<std::int8_t>(_input.read_byte()));
+      return true;
+    case 0xD1:
+      if(!_input.has(2))
+        return false;
+      set_integer(_item,
+          static_cast<std::int16_t>(_input.read_big_endian<std::uint16_t>()));
+      return true;
+    case 0xD2:
+      if(!_input.has(4))
+        return false;
+      set_integer(_item,
+          static_cast<std::int32_t>(_input.read_big_endian<std::uint32_t>()));
+      return true;
+    case 0xD3:
+      if(!_input.has(8))
+        return false;
+      set_integer(_item,
+          static_cast<std::int64_t>(_input.read_big_endian<std::uint64_t>()));
+      return true;
+    case 0xD9:
+    case 0xDA:
+    case 0xDB:
+      return read_length(_input, static_cast<std::uint8_t>(1 << (format -
+              0xD9)), size) and read_string(_input, size, true, _item);
+    case 0xDC:
+    case 0xDD:
+    case 0xDE:
+    case 0xDF:
+      if(!read_length(_input, format & 1 ? 4 : 2, size))
+        return false;
+      _item.m_kind = format <= 0xDD ? item::kind::array : item::kind::object;
+      _item.m_unsigned = size;
+      return true;
+    case 0xC1:
+      _input.fail("never used format 0xc1");
+    default:
+      _input.fail("extension types are not supported");
+  }
+}
+
+
+}
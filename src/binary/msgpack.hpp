@@ -0,0 +1,150 @@
+#ifndef BSTD_JSON_MSGPACK_HPP_
+#define BSTD_JSON_MSGPACK_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "basic_json.hpp"
+#include "binary.hpp"
+#include "number.hpp"
+
+namespace bstd::json::binary {
+
+/// \brief Writes MessagePack to the end of a caller's string.
+/// Integers, strings and containers are written in their shortest format,
+/// and doubles as float 32 when that holds them exactly. The buffer is
+/// managed as by byte_writer, and each write() appends one object, so a
+/// writer kept across calls writes a stream of objects.
+/// Values can also be written piece by piece: a container is begun with its
+/// size and then given exactly that many elements, or members as keys and
+/// values.
+class msgpack_writer final {
+
+  public:
+
+    /// \brief Construct a writer that appends to a string.
+    /// \param _buffer the string to append to; must outlive the writer
+    explicit msgpack_writer(std::string& _buffer) noexcept
+      : m_output(_buffer) {}
+
+    /// \brief Write a JSON value.
+    /// \tparam Json a basic_json
+    /// \param _json the value
+    template<class Json>
+    void write(const Json& _json) { write_value(*this, _json); }
+
+    void write_null() { m_output.write_byte(0xC0); }
+
+    void write_boolean(const bool _boolean) {
+      m_output.write_byte(_boolean ? 0xC3 : 0xC2);
+    }
+
+    /// \brief Write a number as an integer if it is one, and otherwise as a
+    ///        float.
+    /// \param _number the number
+    void write_number(const number& _number);
+
+    /// \copydoc write_number()
+    template<class T>
+      requires std::is_arithmetic_v<T>
+    void write_number(const T _number) { write_number(number(_number)); }
+
+    /// \brief Write a string, or a key.
+    /// \param _string the string
+    /// \throws std::length_error if _string is 4 GiB or longer
+    void write_string(const std::string_view _string);
+
+    /// \brief Begin an array of _size elements.
+    /// \throws std::length_error if _size does not fit in 32 bits
+    void begin_array(const std::size_t _size);
+
+    /// \brief Begin a map of _size members.
+    /// \throws std::length_error if _size does not fit in 32 bits
+    void begin_object(const std::size_t _size);
+
+    /// \brief Trim the string to the bytes written so far.
+    void finish() { m_output.finish(); }
+
+  private:
+
+    /// \brief Write a size in 16 bits after the byte _format_16, or in 32
+    ///        bits after the byte that follows it.
+    void write_size(const std::size_t _size, const std::uint8_t _format_16);
+
+    byte_writer m_output;
+
+};
+
+/// \brief Reads MessagePack objects for basic_reader.
+/// bin objects become base64url strings, as CBOR byte strings do; ext
+/// objects, which have no JSON form, are rejected. str objects must be valid
+/// UTF-8, and map keys must be str objects.
+struct msgpack_format {
+
+  static constexpr const char* name = "msgpack";
+
+  /// \brief Read one object, or the head of an array or map.
+  /// \return false if the data ends before the object does
+  /// \throws std::invalid_argument if the data is malformed or unsupported
+  static bool read_item(byte_reader& _input, item& _item);
+
+};
+
+/// \brief Decodes a stream of MessagePack objects.
+template<class Json>
+using msgpack_reader = basic_reader<Json, msgpack_format>;
+
+/// \brief Encode a JSON value as MessagePack, appending it to a string.
+/// \tparam Json a basic_json
+/// \param _json the value
+/// \param _buffer the string to append to
+template<class Json>
+void to_msgpack(const Json& _json, std::string& _buffer);
+
+/// \brief Encode a JSON value as MessagePack.
+/// \tparam Json a basic_json
+/// \param _json the value
+/// \return the MessagePack data
+template<class Json>
+std::string to_msgpack(const Json& _json);
+
+/// \brief Decode one MessagePack object.
+/// \tparam Json the basic_json type to build
+/// \param _data the data, which must hold exactly one object
+/// \return the value
+/// \throws std::invalid_argument if the data is malformed, incomplete or
+///         followed by more data
+template<class Json = json>
+Json from_msgpack(const std::string_view _data);
+
+
+template<class Json>
+void
+to_msgpack(const Json& _json, std::string& _buffer) {
+  msgpack_writer writer(_buffer);
+  writer.write(_json);
+}
+
+
+template<class Json>
+std::string
+to_msgpack(const Json& _json) {
+  std::string buffer;
+  to_msgpack(_json, buffer);
+  return buffer;
+}
+
+
+template<class Json>
+Json
+from_msgpack(const std::string_view _data) {
+  return read_value<Json, msgpack_format>(_data);
+}
+
+
+}
+
+#endif
@@ -0,0 +1,426 @@
+#include "snapshot.hpp"
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <variant>
+
+#include <sys/mman.h>
+
+
+namespace bstd::json::binary {
+
+
+namespace {
+
+
+[[noreturn]] void
+corrupt() {
+  throw std::out_of_range("snapshot: corrupt image");
+}
+
+
+}
+
+
+snapshot_format::entry_type
+snapshot_writer::
+add_string(const std::string_view _string) {
+  using namespace snapshot_format;
+
+  if(const auto it = m_strings.find(_string); it != m_strings.end())
+    return it->second;
+
+  if(_string.size() > std::numeric_limits<std::uint32_t>::max())
+    throw std::length_error("snapshot: string does not fit in 32 bits");
+
+  m_pool.resize((m_pool.size() + pool_alignment - 1) / pool_alignment *
+      pool_alignment);
+  if(m_pool.size() / pool_alignment > payload_mask)
+    throw std::length_error("snapshot: string pool is larger than 2 GiB");
+
+  const auto offset = static_cast<entry_type>(m_pool.size() / pool_alignment);
+  const auto size = static_cast<std::uint32_t>(_string.size());
+  m_pool.append(reinterpret_cast<const char*>(&size), sizeof(size));
+  m_pool.append(_string);
+  m_strings.emplace(_string, offset);
+  return offset;
+}
+
+
+snapshot_format::entry_type
+snapshot_writer::
+add_number(const number& _number) {
+  using namespace snapshot_format;
+
+  auto decoded = _number;
+  decoded.decode();
+
+  std::uint64_t bits;
+  switch(decoded.get_kind()) {
+    case number::kind::integer: {
+      const auto integer = decoded.get_int64();
+      if(integer >= min_integer and integer <= max_integer)
+        return make_entry(tag::integer, static_cast<std::uint64_t>(integer));
+      bits = static_cast<std::uint64_t>(integer);
+      break;
+    }
+    case number::kind::unsigned_integer:
+      bits = decoded.get_uint64();
+      break;
+    default: {
+      const auto value = decoded.get_double();
+      std::memcpy(&bits, &value, sizeof(bits));
+      break;
+    }
+  }
+
+  const auto index = m_tape.size();
+  m_tape.push_back(make_entry(tag::number,
+        static_cast<std::uint64_t>(decoded.get_kind())));
+  m_tape.push_back(static_cast<entry_type>(bits));
+  m_tape.push_back(static_cast<entry_type>(bits >> 32));
+  return make_entry(tag::reference, index);
+}
+
+
+void
+snapshot_writer::
+finish(std::string& _buffer) {
+  using namespace snapshot_format;
+
+  // Indices, sizes and member positions are all smaller than the tape.
+  if(m_tape.size() > std::size_t{payload_mask} + 1)
+    throw std::length_error("snapshot: value needs more than 2^29 entries");
+
+  header head;
+  std::memcpy(head.m_magic, magic, sizeof(magic));
+  head.m_byte_order = byte_order;
+  head.m_version = version;
+  head.m_tape_size = m_tape.size();
+  head.m_pool_size = m_pool.size();
+
+  _buffer.reserve(_buffer.size() + sizeof(head) +
+      m_tape.size() * sizeof(entry_type) + m_pool.size());
+  _buffer.append(reinterpret_cast<const char*>(&head), sizeof(head));
+  _buffer.append(reinterpret_cast<const char*>(m_tape.data()),
+      m_tape.size() * sizeof(entry_type));
+  _buffer += m_pool;
+
+  m_tape.clear();
+  m_pool.clear();
+  m_strings.clear();
+}
+
+
+json::value_type
+snapshot_value::
+get_type() const {
+  switch(get_tag()) {
+    case snapshot_format::tag::object:
+      return json::value_type::object;
+    case snapshot_format::tag::array:
+      return json::value_type::array;
+    case snapshot_format::tag::string:
+      return json::value_type::string;
+    case snapshot_format::tag::integer:
+    case snapshot_format::tag::number:
+      return json::value_type::number;
+    case snapshot_format::tag::boolean:
+      return json::value_type::boolean;
+    case snapshot_format::tag::null:
+      return json::value_type::null;
+    default:
+      corrupt();
+  }
+}
+
+
+std::optional<snapshot_value>
+snapshot_value::
+find(const std::string_view _key) const {
+  require(snapshot_format::tag::object, "not an object");
+
+  const auto size = static_cast<std::size_t>(get_entry() &
+      snapshot_format::payload_mask);
+  if(size <= snapshot_format::linear_limit) {
+    for(std::size_t i = 0; i < size; ++i)
+      if(get_key(i) == _key)
+        return get_child(i);
+    return std::nullopt;
+  }
+
+  // The sorted member positions follow the member table.
+  const auto sorted = 1 + 2 * size;
+  std::size_t first = 0;
+  std::size_t last = size;
+  while(first < last) {
+    const auto middle = first + (last - first) / 2;
+    const auto position = static_cast<std::size_t>(get_entry(sorted + middle));
+    const auto key = get_key(position);
+    if(key < _key)
+      first = middle + 1;
+    else if(_key < key)
+      last = middle;
+    else
+      return get_child(position);
+  }
+
+  return std::nullopt;
+}
+
+
+snapshot_value
+snapshot_value::
+at(const std::string_view _key) const {
+  if(const auto member = find(_key))
+    return *member;
+
+  throw std::out_of_range("snapshot: no member '" + std::string(_key) + "'");
+}
+
+
+snapshot_value
+snapshot_value::
+at(const std::size_t _index) const {
+  require(snapshot_format::tag::array, "not an array");
+
+  if(_index >= (get_entry() & snapshot_format::payload_mask))
+    throw std::out_of_range("snapshot: index " + std::to_string(_index) +
+        " is out of range");
+
+  return get_child(_index);
+}
+
+
+std::size_t
+snapshot_value::
+size() const {
+  const auto tag = get_tag();
+  if(tag != snapshot_format::tag::object and
+      tag != snapshot_format::tag::array)
+    throw std::domain_error("snapshot: not an object or an array");
+
+  return static_cast<std::size_t>(get_entry() & snapshot_format::payload_mask);
+}
+
+
+snapshot_value::const_iterator
+snapshot_value::
+begin() const {
+  size();
+  return {*this, 0};
+}
+
+
+snapshot_value::const_iterator
+snapshot_value::
+end() const {
+  return {*this, size()};
+}
+
+
+std::string_view
+snapshot_value::
+get_string() const {
+  if(get_tag() != snapshot_format::tag::string)
+    throw std::bad_variant_access();
+
+  return m_snapshot->get_string(get_entry() & snapshot_format::payload_mask);
+}
+
+
+number
+snapshot_value::
+get_number() const {
+  const auto tag = get_tag();
+  if(tag == snapshot_format::tag::integer) {
+    // Sign extend the payload.
+    const auto shift = 32 - snapshot_format::payload_bits;
+    return number(std::int64_t{static_cast<std::int32_t>(get_entry() << shift)
+        >> shift});
+  }
+  if(tag != snapshot_format::tag::number)
+    throw std::bad_variant_access();
+
+  const auto bits = get_entry(1) | std::uint64_t{get_entry(2)} << 32;
+  switch(static_cast<number::kind>(get_entry() &
+        snapshot_format::payload_mask)) {
+    case number::kind::integer:
+      return number(static_cast<std::int64_t>(bits));
+    case number::kind::unsigned_integer:
+      return number(bits);
+    default: {
+      double value;
+      std::memcpy(&value, &bits, sizeof(value));
+      return number(value);
+    }
+  }
+}
+
+
+bool
+snapshot_value::
+get_boolean() const {
+  if(get_tag() != snapshot_format::tag::boolean)
+    throw std::bad_variant_access();
+
+  return (get_entry() & snapshot_format::payload_mask) != 0;
+}
+
+
+snapshot_format::entry_type
+snapshot_value::
+get_entry(const std::size_t _offset) const {
+  return m_snapshot->get_entry(m_index + _offset);
+}
+
+
+snapshot_format::tag
+snapshot_value::
+get_tag() const {
+  return static_cast<snapshot_format::tag>(get_entry() >>
+      snapshot_format::payload_bits);
+}
+
+
+snapshot_value
+snapshot_value::
+get_child(const std::size_t _i) const {
+  return resolve(*m_snapshot, m_index + (get_tag() ==
+        snapshot_format::tag::object ? 2 + 2 * _i : 1 + _i));
+}
+
+
+std::string_view
+snapshot_value::
+get_key(const std::size_t _i) const {
+  if(get_tag() != snapshot_format::tag::object)
+    return {};
+
+  return m_snapshot->get_string(get_entry(1 + 2 * _i));
+}
+
+
+void
+snapshot_value::
+require(const snapshot_format::tag _tag, const char* const _what) const {
+  if(get_tag() != _tag)
+    throw std::domain_error(std::string("snapshot: ") + _what);
+}
+
+
+snapshot_value
+snapshot_value::
+resolve(const snapshot& _snapshot, const std::size_t _slot) {
+  const auto entry = _snapshot.get_entry(_slot);
+  if(entry >> snapshot_format::payload_bits != snapshot_format::reference)
+    return {_snapshot, _slot};
+
+  // Values follow the slots that refer to them, so a reference backwards
+  // could be a cycle.
+  const auto index = entry & snapshot_format::payload_mask;
+  if(index <= _slot)
+    corrupt();
+
+  return {_snapshot, static_cast<std::size_t>(index)};
+}
+
+
+snapshot::
+snapshot(const std::string_view _image)
+    : m_image(_image) {
+  load();
+}
+
+
+snapshot::
+snapshot(utilities::mapped_file&& _file)
+    : m_file(std::move(_file)) {
+  if(!m_file.is_open())
+    throw std::invalid_argument("snapshot: file is not open");
+
+  m_image = m_file.get_view();
+  load();
+
+  // Values are read where they are, not front to back.
+  if(m_file.is_mapped())
+    ::madvise(const_cast<char*>(m_image.data()), m_image.size(),
+        MADV_NORMAL);
+}
+
+
+void
+snapshot::
+load() {
+  using namespace snapshot_format;
+
+  header head;
+  if(m_image.size() < sizeof(head))
+    throw std::invalid_argument("snapshot: image is too small");
+
+  std::memcpy(&head, m_image.data(), sizeof(head));
+  if(std::memcmp(head.m_magic, magic, sizeof(magic)) != 0)
+    throw std::invalid_argument("snapshot: not a snapshot image");
+  if(head.m_byte_order != byte_order)
+    throw std::invalid_argument("snapshot: image has another byte order");
+  if(head.m_version != version)
+    throw std::invalid_argument("snapshot: unsupported version " +
+        std::to_string(head.m_version));
+
+  const auto available = (m_image.size() - sizeof(head)) / sizeof(entry_type);
+  if(head.m_tape_size == 0 or head.m_tape_size > available or
+      head.m_pool_size != m_image.size() - sizeof(head) -
+        head.m_tape_size * sizeof(entry_type))
+    throw std::invalid_argument("snapshot: image is truncated");
+
+  m_tape = m_image.data() + sizeof(head);
+  m_tape_size = static_cast<std::size_t>(head.m_tape_size);
+  m_pool = m_image.substr(sizeof(head) + m_tape_size * sizeof(entry_type));
+}
+
+
+snapshot_format::entry_type
+snapshot::
+get_entry(const std::size_t _index) const {
+  if(_index >= m_tape_size)
+    corrupt();
+
+  snapshot_format::entry_type entry;
+  std::memcpy(&entry, m_tape + _index * sizeof(entry), sizeof(entry));
+  return entry;
+}
+
+
+std::string_view
+snapshot::
+get_string(const std::uint64_t _offset) const {
+  std::uint32_t size;
+  if(_offset > m_pool.size() / snapshot_format::pool_alignment)
+    corrupt();
+
+  const auto offset = static_cast<std::size_t>(_offset) *
+    snapshot_format::pool_alignment;
+  if(m_pool.size() - offset < sizeof(size))
+    corrupt();
+
+  std::memcpy(&size, m_pool.data() + offset, sizeof(size));
+  if(m_pool.size() - offset - sizeof(size) < size)
+    corrupt();
+
+  return m_pool.substr(offset + sizeof(size), size);
+}
+
+
+snapshot
+open_snapshot(const std::string& _path) {
+  utilities::mapped_file file(_path);
+  if(!file.is_open())
+    throw std::invalid_argument("snapshot: cannot open '" + _path + "'");
+
+  return snapshot(std::move(file));
+}
+
+
+}
@@ -0,0 +1,600 @@
+#ifndef BSTD_JSON_SNAPSHOT_HPP_
+#define BSTD_JSON_SNAPSHOT_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "basic_json.hpp"
+#include "binary.hpp"
+#include "number.hpp"
+#include "parser/dom_builder.hpp"
+#include "utilities/mapped_file.hpp"
+
+namespace bstd::json::binary {
+
+/// \brief The layout of a snapshot image.
+/// An image is a header, a tape of 4-byte entries and a string pool, all in
+/// native byte order and addressed by offsets, so it can be mapped anywhere
+/// and read in place. Each entry has a tag in its high 3 bits and a 29-bit
+/// payload:
+///   - null, and booleans with the value as payload
+///   - integers that fit in the payload
+///   - other numbers, with the number's kind as payload, followed by two
+///     entries with the low and high halves of its bits
+///   - strings, with the offset of the string in the pool, in units of
+///     pool_alignment, as payload; the pool holds each distinct string once,
+///     as a 32-bit length and bytes
+///   - arrays, with their size as payload, followed by a slot per element
+///   - objects, likewise followed by a key offset and a slot per member in
+///     order, and for objects of more than linear_limit members, the member
+///     positions sorted by key for binary search
+///   - references, with the index of a value as payload
+/// A slot holds a value of one entry, or a reference to a value that follows
+/// the container's tables; values follow in order. The first entry is the
+/// root's slot. Payloads limit the tape to 2^29 entries and the pool to
+/// 2 GiB.
+namespace snapshot_format {
+
+enum tag : std::uint8_t {
+  null,
+  boolean,
+  integer,
+  number,
+  string,
+  array,
+  object,
+  reference
+};
+
+using entry_type = std::uint32_t;
+
+constexpr int payload_bits = 29;
+
+constexpr entry_type payload_mask = (entry_type{1} << payload_bits) - 1;
+
+/// The range of integers held in a payload.
+constexpr std::int64_t min_integer = -(std::int64_t{1} << (payload_bits - 1));
+constexpr std::int64_t max_integer =
+  (std::int64_t{1} << (payload_bits - 1)) - 1;
+
+/// Strings in the pool start at multiples of this many bytes.
+constexpr std::size_t pool_alignment = 4;
+
+/// Objects up to this size are searched linearly.
+constexpr std::size_t linear_limit = 8;
+
+/// Identifies images whose byte order matches the reader's.
+constexpr std::uint32_t byte_order = 0x01020304;
+
+constexpr std::uint32_t version = 2;
+
+struct header {
+  char m_magic[8];
+  std::uint32_t m_byte_order;
+  std::uint32_t m_version;
+  std::uint64_t m_tape_size;
+  std::uint64_t m_pool_size;
+};
+
+constexpr char magic[8] = {'B', 'S', 'T', 'D', 'J', 'S', 'O', 'N'};
+
+constexpr entry_type
+make_entry(const tag _tag, const std::uint64_t _payload) noexcept {
+  return static_cast<entry_type>(entry_type{_tag} << payload_bits |
+      (_payload & payload_mask));
+}
+
+}
+
+/// \brief Writes the snapshot image of a value to the end of a caller's
+///        string.
+/// Values are written without recursion, and equal strings, such as the keys
+/// of records, are stored once.
+class snapshot_writer final {
+
+  public:
+
+    /// \brief Write a value.
+    /// \tparam Json a basic_json
+    /// \param _json the value
+    /// \param _buffer the string to append the image to
+    /// \throws std::length_error if the image is too large for its offsets
+    template<class Json>
+    void write(const Json& _json, std::string& _buffer);
+
+  private:
+
+    using entry_type = snapshot_format::entry_type;
+
+    /// \brief Add a string to the pool, unless it is there already.
+    /// \return its offset in the pool, in units of pool_alignment
+    entry_type add_string(const std::string_view _string);
+
+    /// \brief Add a number.
+    /// \return its slot: the number itself, if it is an integer that fits in
+    ///         an entry, or a reference to it
+    entry_type add_number(const number& _number);
+
+    template<class T>
+      requires std::is_arithmetic_v<T>
+    entry_type add_number(const T _number) {
+      return add_number(number(_number));
+    }
+
+    /// \brief Append the header, the tape and the pool to a string, and
+    ///        clear them.
+    /// \throws std::length_error if the tape has too many entries for their
+    ///         indices to fit in a payload
+    void finish(std::string& _buffer);
+
+    std::vector<entry_type> m_tape;
+
+    std::string m_pool;
+
+    /// Offsets of the strings in the pool, by views of the value's strings.
+    std::unordered_map<std::string_view, entry_type> m_strings;
+
+    /// Keys of the object being opened, with their positions.
+    std::vector<std::pair<std::string_view, entry_type>> m_keys;
+
+};
+
+class snapshot;
+
+/// \brief A read-only view of one value in a snapshot.
+/// Reading a value follows offsets in the image: members are found by
+/// binary search and elements by index, and strings are views of the image,
+/// so nothing is decoded or allocated. A snapshot_value is only valid while
+/// its snapshot is alive and not moved.
+class snapshot_value final {
+
+  public:
+
+    /// \brief Iterates over the elements of an array or the members of an
+    ///        object, in order.
+    class const_iterator;
+
+    snapshot_value() = default;
+
+    /// \brief Get the type of the value.
+    /// \return the type of the value
+    json::value_type get_type() const;
+
+    /// \brief Find a member of an object.
+    /// \param _key the member name
+    /// \return the member's value, or std::nullopt if there is no such member
+    /// \throws std::domain_error if the value is not an object
+    std::optional<snapshot_value> find(const std::string_view _key) const;
+
+    /// \brief Access a member of an object.
+    /// \param _key the member name
+    /// \return the member's value
+    /// \throws std::domain_error if the value is not an object
+    /// \throws std::out_of_range if there is no such member
+    snapshot_value at(const std::string_view _key) const;
+
+    /// \brief Access an element of an array.
+    /// \param _index the element index
+    /// \return the element
+    /// \throws std::domain_error if the value is not an array
+    /// \throws std::out_of_range if _index is out of range
+    snapshot_value at(const std::size_t _index) const;
+
+    /// \copydoc at(const std::string_view) const
+    snapshot_value operator[](const std::string_view _key) const {
+      return at(_key);
+    }
+
+    /// \copydoc at(const std::size_t) const
+    snapshot_value operator[](const std::size_t _index) const {
+      return at(_index);
+    }
+
+    /// \brief Get the number of members of an object or elements of an
+    ///        array.
+    /// \return the number of children
+    /// \throws std::domain_error if the value is not an object or an array
+    std::size_t size() const;
+
+    /// \brief Check if an object or array has no children.
+    /// \throws std::domain_error if the value is not an object or an array
+    bool empty() const { return size() == 0; }
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    /// \brief Get a string.
+    /// \return a view of the string in the image
+    /// \throws std::bad_variant_access if the value is not a string
+    std::string_view get_string() const;
+
+    /// \brief Get a number.
+    /// \throws std::bad_variant_access if the value is not a number
+    number get_number() const;
+
+    /// \brief Get a boolean.
+    /// \throws std::bad_variant_access if the value is not a boolean
+    bool get_boolean() const;
+
+    /// \brief Get a scalar value.
+    /// \tparam T std::string_view, bool, number, or an arithmetic type
+    /// \return the value
+    /// \throws std::bad_variant_access if the value is not a T
+    template<class T>
+    T get() const;
+
+    /// \brief Decode the value, and everything in it, into a basic_json.
+    /// \tparam Json the basic_json type to build
+    /// \return the decoded value
+    template<class Json = json>
+    Json get_json() const;
+
+  private:
+
+    friend class snapshot;
+
+    snapshot_value(const snapshot& _snapshot, const std::size_t _index)
+      : m_snapshot(&_snapshot), m_index(_index) {}
+
+    /// \brief Get the value in a slot, following a reference.
+    static snapshot_value resolve(const snapshot& _snapshot,
+        const std::size_t _slot);
+
+    snapshot_format::entry_type get_entry(const std::size_t _offset = 0)
+      const;
+
+    snapshot_format::tag get_tag() const;
+
+    /// \brief Get the _i-th element or member value of a container.
+    snapshot_value get_child(const std::size_t _i) const;
+
+    /// \brief Get the _i-th member key of an object, or nothing in an array.
+    std::string_view get_key(const std::size_t _i) const;
+
+    /// \brief Throw unless this value is a container with the tag _tag.
+    void require(const snapshot_format::tag _tag, const char* const _what)
+      const;
+
+    const snapshot* m_snapshot{nullptr};
+
+    std::size_t m_index{0};
+
+};
+
+class snapshot_value::const_iterator final {
+
+  public:
+
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = snapshot_value;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = snapshot_value;
+
+    const_iterator() = default;
+
+    const_iterator(const snapshot_value& _container, const std::size_t _i)
+      : m_container(_container), m_i(_i) {}
+
+    /// \brief Get the key of the current member.
+    /// \return the key, or an empty view in an array
+    std::string_view key() const { return m_container.get_key(m_i); }
+
+    snapshot_value operator*() const { return m_container.get_child(m_i); }
+
+    const_iterator& operator++() { ++m_i; return *this; }
+
+    const_iterator operator++(int) {
+      auto copy = *this;
+      ++m_i;
+      return copy;
+    }
+
+    bool operator==(const const_iterator& _rhs) const noexcept {
+      return m_i == _rhs.m_i;
+    }
+
+  private:
+
+    snapshot_value m_container;
+
+    std::size_t m_i{0};
+
+};
+
+
+/// \brief A value written by write_snapshot(), read in place.
+/// Loading checks the image's header and nothing else, so it takes constant
+/// time and allocates nothing, however large the value: a document mapped
+/// with open_snapshot() is read straight from the page cache, and only the
+/// pages that are read are loaded. Images are trusted to be ones
+/// write_snapshot() wrote; reads are bounds checked, so a corrupt image
+/// throws rather than reading outside of itself.
+class snapshot final {
+
+  public:
+
+    /// \brief Read an image in memory.
+    /// \param _image the image; must outlive the snapshot
+    /// \throws std::invalid_argument if _image is not a snapshot image of
+    ///         this version and byte order
+    explicit snapshot(const std::string_view _image);
+
+    /// \brief Read a mapped image, and keep it mapped.
+    /// \param _file the file holding the image
+    /// \throws std::invalid_argument if the file is not open, or does not
+    ///         hold a snapshot image
+    explicit snapshot(utilities::mapped_file&& _file);
+
+    snapshot(snapshot&&) noexcept = default;
+    snapshot& operator=(snapshot&&) noexcept = default;
+
+    /// \brief Get the root value.
+    snapshot_value get_root() const {
+      return snapshot_value::resolve(*this, 0);
+    }
+
+    /// \brief Get the image.
+    std::string_view get_image() const noexcept { return m_image; }
+
+  private:
+
+    friend class snapshot_value;
+
+    /// \brief Check the header, and find the tape and the pool.
+    void load();
+
+    /// \brief Get an entry of the tape.
+    /// \throws std::out_of_range if the image is corrupt
+    snapshot_format::entry_type get_entry(const std::size_t _index) const;
+
+    /// \brief Get a string in the pool.
+    /// \param _offset the offset of the string, in units of pool_alignment
+    /// \throws std::out_of_range if the image is corrupt
+    std::string_view get_string(const std::uint64_t _offset) const;
+
+    utilities::mapped_file m_file;
+
+    std::string_view m_image;
+
+    const char* m_tape{nullptr};
+
+    std::size_t m_tape_size{0};
+
+    std::string_view m_pool;
+
+};
+
+/// \brief Write the snapshot image of a value, appending it to a string.
+/// \tparam Json a basic_json
+/// \param _json the value
+/// \param _buffer the string to append to
+template<class Json>
+void write_snapshot(const Json& _json, std::string& _buffer);
+
+/// \brief Write the snapshot image of a value.
+/// \tparam Json a basic_json
+/// \param _json the value
+/// \return the image
+template<class Json>
+std::string write_snapshot(const Json& _json);
+
+/// \brief Map a file holding a snapshot image.
+/// \param _path the file path
+/// \return the snapshot
+/// \throws std::invalid_argument if the file cannot be opened, or does not
+///         hold a snapshot image
+snapshot open_snapshot(const std::string& _path);
+
+
+template<class Json>
+void
+snapshot_writer::
+write(const Json& _json, std::string& _buffer) {
+  using namespace snapshot_format;
+  using value_type = typename Json::value_type;
+  using object_type = typename Json::object_type;
+  using array_type = typename Json::array_type;
+
+  /// An open container with children left to write.
+  struct frame {
+    typename object_type::const_iterator m_member;
+    typename array_type::const_iterator m_element;
+    std::size_t m_slot;
+    std::size_t m_remaining;
+    bool m_is_object;
+  };
+
+  std::vector<frame> frames;
+
+  // Write a value, or the tables of a container and open it, and return the
+  // value's slot.
+  const auto write_value = [this, &frames](const Json& _value) {
+    const auto index = m_tape.size();
+    switch(_value.get_type()) {
+      case value_type::object: {
+        const auto& object = _value.template get<object_type>();
+        const auto size = object.size();
+        m_tape.push_back(make_entry(tag::object, size));
+
+        m_keys.clear();
+        for(const auto& [key, member] : object) {
+          m_tape.push_back(add_string(std::string_view(key)));
+          m_tape.push_back(0);
+          m_keys.emplace_back(std::string_view(key),
+              static_cast<entry_type>(m_keys.size()));
+        }
+
+        if(size > linear_limit) {
+          std::sort(m_keys.begin(), m_keys.end());
+          for(const auto& key : m_keys)
+            m_tape.push_back(key.second);
+        }
+
+        if(size != 0)
+          frames.push_back({object.begin(), {}, index + 2, size, true});
+        return make_entry(tag::reference, index);
+      }
+      case value_type::array: {
+        const auto& array = _value.template get<array_type>();
+        m_tape.push_back(make_entry(tag::array, array.size()));
+        m_tape.resize(m_tape.size() + array.size());
+
+        if(!array.empty())
+          frames.push_back({{}, array.begin(), index + 1, array.size(),
+              false});
+        return make_entry(tag::reference, index);
+      }
+      case value_type::string:
+        return make_entry(tag::string, add_string(_value.get_string()));
+      case value_type::number:
+        return add_number(_value.template get<typename Json::number_type>());
+      case value_type::boolean:
+        return make_entry(tag::boolean,
+            _value.template get<typename Json::boolean_type>() ? 1 : 0);
+      case value_type::null:
+      default:
+        return make_entry(tag::null, 0);
+    }
+  };
+
+  m_tape.push_back(0);
+  m_tape[0] = write_value(_json);
+  while(!frames.empty()) {
+    auto& top = frames.back();
+    if(top.m_remaining == 0) {
+      frames.pop_back();
+      continue;
+    }
+
+    // top is invalidated by opening another container.
+    const auto slot = top.m_slot;
+    top.m_slot += top.m_is_object ? 2 : 1;
+    --top.m_remaining;
+    const auto& child = top.m_is_object ? (top.m_member++)->second :
+      *top.m_element++;
+    const auto entry = write_value(child);
+    m_tape[slot] = entry;
+  }
+
+  finish(_buffer);
+}
+
+
+template<class T>
+T
+snapshot_value::
+get() const {
+  if constexpr(std::is_same_v<T, std::string_view>)
+    return get_string();
+  else if constexpr(std::is_same_v<T, bool>)
+    return get_boolean();
+  else if constexpr(std::is_same_v<T, number>)
+    return get_number();
+  else
+    return get_number().template get<T>();
+}
+
+
+template<class Json>
+Json
+snapshot_value::
+get_json() const {
+  using number_type = typename Json::number_type;
+
+  /// An open container.
+  struct frame {
+    snapshot_value m_container;
+    std::size_t m_size;
+    std::size_t m_next;
+    bool m_is_object;
+  };
+
+  parser::dom_builder<Json> builder;
+  std::vector<frame> frames;
+  auto value = *this;
+  while(true) {
+    switch(value.get_tag()) {
+      case snapshot_format::tag::object:
+        builder.begin_object();
+        frames.push_back({value, value.size(), 0, true});
+        break;
+      case snapshot_format::tag::array:
+        builder.begin_array();
+        frames.push_back({value, value.size(), 0, false});
+        break;
+      case snapshot_format::tag::string:
+        builder.decoded_string(value.get_string());
+        break;
+      case snapshot_format::tag::integer:
+      case snapshot_format::tag::number: {
+        const auto decoded = value.get_number();
+        if constexpr(std::is_same_v<number_type, number>)
+          builder.value(Json(decoded));
+        else if constexpr(std::is_arithmetic_v<number_type>)
+          builder.value(Json(decoded.template get<number_type>()));
+        else
+          builder.value(Json(static_cast<number_type>(decoded.get_double())));
+        break;
+      }
+      case snapshot_format::tag::boolean:
+        builder.boolean(value.get_boolean());
+        break;
+      case snapshot_format::tag::null:
+      default:
+        builder.null();
+        break;
+    }
+
+    // Move on to the next child, closing each container that is done.
+    while(!frames.empty()) {
+      auto& top = frames.back();
+      if(top.m_next != top.m_size) {
+        if(top.m_is_object)
+          builder.decoded_key(top.m_container.get_key(top.m_next));
+        value = top.m_container.get_child(top.m_next++);
+        break;
+      }
+
+      if(top.m_is_object)
+        builder.end_object();
+      else
+        builder.end_array();
+      frames.pop_back();
+    }
+
+    if(frames.empty())
+      return builder.release();
+  }
+}
+
+
+template<class Json>
+void
+write_snapshot(const Json& _json, std::string& _buffer) {
+  snapshot_writer writer;
+  writer.write(_json, _buffer);
+}
+
+
+template<class Json>
+std::string
+write_snapshot(const Json& _json) {
+  std::string buffer;
+  write_snapshot(_json, buffer);
+  return buffer;
+}
+
+
+}
+
+#endif
@@ -0,0 +1,464 @@
+#ifndef BSTD_FLAT_OBJECT_HPP_
+#define BSTD_FLAT_OBJECT_HPP_
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "basic_json.hpp"
+
+namespace bstd::json {
+
+/// \brief Hash a string, at compile time if need be.
+/// This is the hash flat_object indexes string keys by, so a key hashed ahead
+/// of time, such as by a json_pointer, can be looked up without hashing it
+/// again.
+/// \param _string the string
+/// \return the 64-bit FNV-1a hash of _string
+constexpr std::size_t
+hash_string(const std::string_view _string) noexcept {
+  std::uint64_t hash = 0xcbf29ce484222325;
+  for(const auto c : _string) {
+    hash ^= static_cast<unsigned char>(c);
+    hash *= 0x100000001b3;
+  }
+
+  return static_cast<std::size_t>(hash);
+}
+
+/// \brief An object container stored in one contiguous array.
+/// Members are kept in insertion order in a single vector, so iterating
+/// touches consecutive memory and small objects need one allocation. Objects
+/// with up to linear_threshold members are searched with a linear scan, which
+/// for typical key counts beats walking a tree. For string keys the scan
+/// first compares a one-byte tag per member, eight at a time packed into a
+/// 64-bit word, so only members whose tag matches have their keys compared. Larger objects also maintain an
+/// open-addressing hash index of member positions.
+/// flat_object fits basic_json's ObjectType parameter; see flat_json.
+/// Keys must not be modified through iterators.
+/// \tparam Key the key type; may be const-qualified, as basic_json passes it
+/// \tparam T the mapped type
+/// \tparam Allocator the allocator for members
+template<class Key, class T,
+  class Allocator = std::allocator<std::pair<std::remove_const_t<Key>, T>>>
+class flat_object final {
+
+  public:
+
+    using key_type = std::remove_const_t<Key>;
+    using mapped_type = T;
+    using value_type = std::pair<key_type, T>;
+    using size_type = std::size_t;
+    using allocator_type = typename std::allocator_traits<Allocator>::
+      template rebind_alloc<value_type>;
+
+  private:
+
+    using storage_type = std::vector<value_type, allocator_type>;
+
+  public:
+
+    using iterator = typename storage_type::iterator;
+    using const_iterator = typename storage_type::const_iterator;
+
+    /// Objects larger than this are indexed by hash.
+    static constexpr size_type linear_threshold = 16;
+
+    flat_object() = default;
+
+    /// \brief Construct an empty object with an allocator.
+    /// \param _allocator the allocator for members and the index
+    explicit flat_object(const allocator_type& _allocator)
+      : m_members(_allocator), m_index(index_allocator_type(_allocator)) {}
+
+    /// \brief Construct from members; later duplicates are ignored, as with
+    ///        std::map.
+    /// \param _il the members
+    flat_object(std::initializer_list<std::pair<Key, T>> _il) {
+      reserve(_il.size());
+      for(const auto& member : _il)
+        emplace(member.first, member.second);
+    }
+
+    iterator begin() noexcept { return m_members.begin(); }
+    const_iterator begin() const noexcept { return m_members.begin(); }
+    const_iterator cbegin() const noexcept { return m_members.cbegin(); }
+
+    iterator end() noexcept { return m_members.end(); }
+    const_iterator end() const noexcept { return m_members.end(); }
+    const_iterator cend() const noexcept { return m_members.cend(); }
+
+    size_type size() const noexcept { return m_members.size(); }
+
+    bool empty() const noexcept { return m_members.empty(); }
+
+    allocator_type get_allocator() const noexcept {
+      return m_members.get_allocator();
+    }
+
+    /// \brief Reserve storage, and the index if it will be needed.
+    /// \param _size the number of members to make room for
+    void reserve(const size_type _size);
+
+    /// \brief Remove all members.
+    void clear() noexcept {
+      m_members.clear();
+      m_index.clear();
+    }
+
+    /// \brief Find a member.
+    /// \param _key the key; anything comparable with key_type, such as a
+    ///             std::string_view for string keys
+    /// \return an iterator to the member, or end()
+    template<class K>
+    iterator find(const K& _key) {
+      return begin() + find_position(_key);
+    }
+    /// \copydoc find()
+    template<class K>
+    const_iterator find(const K& _key) const {
+      return cbegin() + find_position(_key);
+    }
+
+    /// \brief Find a member by a key that is already hashed.
+    /// \param _key the key
+    /// \param _hash hash_string(_key) for string keys, or the std::hash of
+    ///              _key otherwise
+    /// \return an iterator to the member, or end()
+    template<class K>
+    iterator find(const K& _key, const std::size_t _hash) {
+      return begin() + find_position(_key, _hash);
+    }
+    /// \copydoc find(const K&, const std::size_t)
+    template<class K>
+    const_iterator find(const K& _key, const std::size_t _hash) const {
+      return cbegin() + find_position(_key, _hash);
+    }
+
+    /// \brief Check if a member exists.
+    /// \param _key the key
+    /// \return true if there is a member with _key
+    template<class K>
+    bool contains(const K& _key) const {
+      return find_position(_key) != size();
+    }
+
+    /// \brief Count the members with a key.
+    /// \param _key the key
+    /// \return 1 if there is a member with _key, 0 otherwise
+    template<class K>
+    size_type count(const K& _key) const { return contains(_key) ? 1 : 0; }
+
+    /// \brief Access a member.
+    /// \param _key the key
+    /// \return the member's value
+    /// \throws std::out_of_range if there is no such member
+    template<class K>
+    T& at(const K& _key) {
+      return const_cast<T&>(std::as_const(*this).at(_key));
+    }
+    /// \copydoc at()
+    template<class K>
+    const T& at(const K& _key) const;
+
+    /// \brief Access a member, inserting a default value if it is missing.
+    /// \param _key the key
+    /// \return the member's value
+    T& operator[](const key_type& _key) {
+      return emplace(_key, T()).first->second;
+    }
+
+    /// \brief Insert a member unless its key already exists.
+    /// \param _key the key
+    /// \param _args the arguments for constructing the value
+    /// \return an iterator to the member with _key, and true if it was
+    ///         inserted
+    template<class K, class... Args>
+    std::pair<iterator, bool> emplace(K&& _key, Args&&... _args);
+
+    /// \copydoc emplace()
+    template<class K, class... Args>
+    std::pair<iterator, bool> try_emplace(K&& _key, Args&&... _args) {
+      return emplace(std::forward<K>(_key), std::forward<Args>(_args)...);
+    }
+
+    /// \brief Insert a member unless its key already exists.
+    /// \param _member the member
+    /// \return an iterator to the member with the key, and true if it was
+    ///         inserted
+    std::pair<iterator, bool> insert(value_type _member) {
+      return emplace(std::move(_member.first), std::move(_member.second));
+    }
+
+    /// \brief Insert a member, or replace the value of an existing one.
+    /// \param _key the key
+    /// \param _value the value
+    /// \return an iterator to the member, and true if it was inserted
+    template<class K, class V>
+    std::pair<iterator, bool> insert_or_assign(K&& _key, V&& _value);
+
+    /// \brief Remove a member, keeping the others in order.
+    /// \param _position the member to remove
+    /// \return an iterator to the following member
+    iterator erase(const_iterator _position);
+    /// \copydoc erase(const_iterator)
+    iterator erase(iterator _position) {
+      return erase(const_iterator(_position));
+    }
+
+    /// \brief Remove a member, keeping the others in order.
+    /// \param _key the key
+    /// \return the number of members removed
+    template<class K>
+    size_type erase(const K& _key) {
+      const auto position = find(_key);
+      if(position == end())
+        return 0;
+
+      erase(position);
+      return 1;
+    }
+
+  private:
+
+    /// An index slot: one plus a member's position, or 0 if empty.
+    using slot_type = std::uint32_t;
+
+    using index_allocator_type = typename std::allocator_traits<Allocator>::
+      template rebind_alloc<slot_type>;
+
+    /// Keys that can be viewed as strings are tagged for the linear scan.
+    static constexpr bool is_tagged =
+      std::is_convertible_v<const key_type&, std::string_view>;
+
+    /// \brief Tag a string key from its length and its first and last
+    ///        characters, which tell apart most keys of one object without
+    ///        reading the rest of them.
+    static std::uint8_t tag(const std::string_view _key) noexcept {
+      if(_key.empty())
+        return 0;
+
+      return static_cast<std::uint8_t>(_key.size() << 4 ^
+          static_cast<unsigned char>(_key.front()) ^
+          static_cast<unsigned char>(_key.back()) << 1);
+    }
+
+    /// \brief Hash a key so that equal strings of any string type agree.
+    template<class K>
+    static std::size_t hash(const K& _key) {
+      if constexpr(std::is_convertible_v<const K&, std::string_view>)
+        return hash_string(std::string_view(_key));
+      else
+        return std::hash<key_type>()(_key);
+    }
+
+    /// \brief Get the position of a member, or size() if there is none.
+    template<class K>
+    size_type find_position(const K& _key) const {
+      // Small objects are scanned, so the key need not be hashed.
+      return find_position(_key, m_index.empty() ? 0 : hash(_key));
+    }
+
+    /// \copydoc find_position(const K&)
+    /// \param _hash the hash of _key
+    template<class K>
+    size_type find_position(const K& _key, const std::size_t _hash) const;
+
+    /// \brief Add a member's position to the index.
+    void index(const size_type _position);
+
+    /// \brief Rebuild the index for the current members.
+    void rebuild_index(size_type _capacity);
+
+    /// \brief Tag the member at a position, if the object is small.
+    void tag_member(const size_type _position) noexcept;
+
+    storage_type m_members;
+
+    /// The tag of each member's key, while the object is small and keys are
+    /// tagged: byte i % 8 of word i / 8 for member i.
+    std::array<std::uint64_t, linear_threshold / 8> m_tags{};
+
+    /// Open-addressing table of member positions; empty while the object is
+    /// small. Its size is a power of two at least twice the member count.
+    std::vector<slot_type, index_allocator_type> m_index;
+
+};
+
+/// \brief A json whose objects are flat_objects.
+using flat_json = basic_json<flat_object>;
+
+
+template<class Key, class T, class Allocator>
+void
+flat_object<Key, T, Allocator>::
+reserve(const size_type _size) {
+  m_members.reserve(_size);
+
+  if(_size > linear_threshold and m_index.size() < 2 * _size)
+    rebuild_index(std::bit_ceil(2 * _size));
+}
+
+
+template<class Key, class T, class Allocator>
+template<class K>
+const T&
+flat_object<Key, T, Allocator>::
+at(const K& _key) const {
+  const auto position = find_position(_key);
+  if(position == size())
+    throw std::out_of_range("flat_object::at: no such member");
+
+  return m_members[position].second;
+}
+
+
+template<class Key, class T, class Allocator>
+template<class K, class... Args>
+std::pair<typename flat_object<Key, T, Allocator>::iterator, bool>
+flat_object<Key, T, Allocator>::
+emplace(K&& _key, Args&&... _args) {
+  if(const auto position = find_position(_key); position != size())
+    return {begin() + position, false};
+
+  m_members.emplace_back(std::piecewise_construct,
+      std::forward_as_tuple(std::forward<K>(_key)),
+      std::forward_as_tuple(std::forward<Args>(_args)...));
+
+  const auto position = size() - 1;
+  tag_member(position);
+  if(m_index.size() >= 2 * size())
+    index(position);
+  else if(size() > linear_threshold)
+    rebuild_index(std::bit_ceil(4 * size()));
+
+  return {begin() + position, true};
+}
+
+
+template<class Key, class T, class Allocator>
+template<class K, class V>
+std::pair<typename flat_object<Key, T, Allocator>::iterator, bool>
+flat_object<Key, T, Allocator>::
+insert_or_assign(K&& _key, V&& _value) {
+  auto result = emplace(std::forward<K>(_key), std::forward<V>(_value));
+  if(!result.second)
+    result.first->second = std::forward<V>(_value);
+
+  return result;
+}
+
+
+template<class Key, class T, class Allocator>
+typename flat_object<Key, T, Allocator>::iterator
+flat_object<Key, T, Allocator>::
+erase(const_iterator _position) {
+  const auto position = _position - cbegin();
+  m_members.erase(_position);
+
+  // Every later member has moved.
+  if(!m_index.empty())
+    rebuild_index(m_index.size());
+  else
+    for(auto i = static_cast<size_type>(position); i < size(); ++i)
+      tag_member(i);
+
+  return begin() + position;
+}
+
+
+template<class Key, class T, class Allocator>
+template<class K>
+typename flat_object<Key, T, Allocator>::size_type
+flat_object<Key, T, Allocator>::
+find_position(const K& _key, const std::size_t _hash) const {
+  if(m_index.empty()) {
+    if constexpr(is_tagged and
+        std::is_convertible_v<const K&, std::string_view>) {
+      // Find the bytes of a word that equal the key's tag by finding the
+      // zero bytes of their XOR. A borrow can mark a byte above a true match
+      // too, but every candidate is confirmed by comparing keys.
+      constexpr std::uint64_t ones = 0x0101010101010101;
+      const auto key_tag = ones * tag(std::string_view(_key));
+      for(size_type word = 0; 8 * word < m_members.size(); ++word) {
+        const auto difference = m_tags[word] ^ key_tag;
+        auto matches = (difference - ones) & ~difference & ones << 7;
+        for(; matches != 0; matches &= matches - 1) {
+          const auto i = 8 * word +
+            static_cast<size_type>(std::countr_zero(matches)) / 8;
+          if(i < m_members.size() and m_members[i].first == _key)
+            return i;
+        }
+      }
+    }
+    else {
+      for(size_type i = 0; i < m_members.size(); ++i)
+        if(m_members[i].first == _key)
+          return i;
+    }
+
+    return size();
+  }
+
+  const auto mask = m_index.size() - 1;
+  for(auto slot = _hash & mask; m_index[slot] != 0;
+      slot = (slot + 1) & mask)
+    if(m_members[m_index[slot] - 1].first == _key)
+      return m_index[slot] - 1;
+
+  return size();
+}
+
+
+template<class Key, class T, class Allocator>
+void
+flat_object<Key, T, Allocator>::
+index(const size_type _position) {
+  const auto mask = m_index.size() - 1;
+  auto slot = hash(m_members[_position].first) & mask;
+  while(m_index[slot] != 0)
+    slot = (slot + 1) & mask;
+
+  m_index[slot] = static_cast<slot_type>(_position + 1);
+}
+
+
+template<class Key, class T, class Allocator>
+void
+flat_object<Key, T, Allocator>::
+tag_member(const size_type _position) noexcept {
+  if constexpr(is_tagged) {
+    if(_position >= linear_threshold)
+      return;
+
+    const auto shift = 8 * (_position % 8);
+    auto& word = m_tags[_position / 8];
+    word = (word & ~(std::uint64_t{0xFF} << shift)) | std::uint64_t{
+      tag(std::string_view(m_members[_position].first))} << shift;
+  }
+}
+
+
+template<class Key, class T, class Allocator>
+void
+flat_object<Key, T, Allocator>::
+rebuild_index(const size_type _capacity) {
+  m_index.assign(_capacity, 0);
+  for(size_type i = 0; i < m_members.size(); ++i)
+    index(i);
+}
+
+
+}
+
+#endif
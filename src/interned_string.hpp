@@ -0,0 +1,175 @@
+#ifndef BSTD_INTERNED_STRING_HPP_
+#define BSTD_INTERNED_STRING_HPP_
+
+#include <compare>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "basic_json.hpp"
+#include "flat_object.hpp"
+#include "utilities/string_pool.hpp"
+
+namespace bstd::json {
+
+/// \brief An immutable string that is a single pointer.
+/// A string made with intern() is, if it has at most max_interned_size
+/// characters, interned in string_pool::get_default(), so every copy of the
+/// same short string, in any document and on any thread, shares one entry,
+/// and two interned strings are equal exactly when their entries are the
+/// same. Pool entries are never freed, so only strings from a small,
+/// recurring set, such as the member names of records, should be interned;
+/// dom_builder interns keys and nothing else. Other strings get their own
+/// reference-counted entry.
+/// interned_string fits basic_json's StringType parameter; see interned_json.
+class interned_string final {
+
+  public:
+
+    using value_type = char;
+    using size_type = std::size_t;
+
+    /// Strings at most this long are interned.
+    static constexpr size_type max_interned_size = 32;
+
+    interned_string() noexcept = default;
+
+    /// \brief Construct from a string, without interning it.
+    /// \param _string the string
+    explicit interned_string(const std::string_view _string)
+      : m_entry(make_entry(_string)) {}
+
+    /// \copydoc interned_string(const std::string_view)
+    interned_string(const char* _string)
+      : interned_string(std::string_view(_string)) {}
+
+    interned_string(const interned_string& _other) noexcept
+      : m_entry(_other.m_entry) {
+      acquire();
+    }
+
+    interned_string(interned_string&& _other) noexcept
+      : m_entry(std::exchange(_other.m_entry, nullptr)) {}
+
+    interned_string& operator=(interned_string _other) noexcept {
+      std::swap(m_entry, _other.m_entry);
+      return *this;
+    }
+
+    ~interned_string() { release(); }
+
+    /// \brief Intern a string, if it is short enough.
+    /// \param _string the string
+    /// \return the string, shared through the default pool if it has at most
+    ///         max_interned_size characters
+    static interned_string intern(const std::string_view _string) {
+      interned_string interned;
+      if(!_string.empty() and _string.size() <= max_interned_size)
+        interned.m_entry = utilities::string_pool::get_default().intern(
+            _string);
+      else
+        interned.m_entry = make_entry(_string);
+      return interned;
+    }
+
+    const char* data() const noexcept {
+      return m_entry ? m_entry->data() : "";
+    }
+
+    size_type size() const noexcept { return m_entry ? m_entry->m_size : 0; }
+
+    bool empty() const noexcept { return size() == 0; }
+
+    /// \brief Check if the string is in the pool.
+    /// \return true if the string is shared through the pool
+    bool is_interned() const noexcept {
+      return m_entry and m_entry->m_references == 0;
+    }
+
+    operator std::string_view() const noexcept { return {data(), size()}; }
+
+    operator std::string() const { return std::string(data(), size()); }
+
+    /// \brief Compare two strings; by address when both are interned.
+    friend bool operator==(const interned_string& _lhs,
+        const interned_string& _rhs) noexcept {
+      // An interned string is the only interned entry with its contents.
+      if(_lhs.m_entry == _rhs.m_entry)
+        return true;
+      if(_lhs.is_interned() and _rhs.is_interned())
+        return false;
+
+      return std::string_view(_lhs) == std::string_view(_rhs);
+    }
+
+    friend bool operator==(const interned_string& _lhs,
+        const std::string_view _rhs) noexcept {
+      return std::string_view(_lhs) == _rhs;
+    }
+
+    friend bool operator==(const interned_string& _lhs,
+        const char* _rhs) noexcept {
+      return std::string_view(_lhs) == _rhs;
+    }
+
+    friend std::strong_ordering operator<=>(const interned_string& _lhs,
+        const interned_string& _rhs) noexcept {
+      return std::string_view(_lhs) <=> std::string_view(_rhs);
+    }
+
+    friend std::ostream& operator<<(std::ostream& _os,
+        const interned_string& _string) {
+      return _os << std::string_view(_string);
+    }
+
+  private:
+
+    using entry_type = utilities::string_entry;
+
+    static const entry_type* make_entry(const std::string_view _string) {
+      if(_string.empty())
+        return nullptr;
+
+      const auto entry = new(::operator new(sizeof(entry_type) +
+            _string.size())) entry_type{_string.size(), {1}};
+      std::memcpy(const_cast<char*>(entry->data()), _string.data(),
+          _string.size());
+      return entry;
+    }
+
+    void acquire() const noexcept {
+      if(m_entry and m_entry->m_references != 0)
+        m_entry->m_references.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void release() noexcept {
+      if(m_entry and m_entry->m_references != 0 and
+          m_entry->m_references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        ::operator delete(const_cast<entry_type*>(m_entry));
+    }
+
+    const entry_type* m_entry{nullptr};
+
+};
+
+/// \brief A json with interned keys and flat objects, so member lookups by
+///        interned key compare addresses.
+using interned_json = basic_json<flat_object, std::vector, interned_string>;
+
+}
+
+template<>
+struct std::hash<bstd::json::interned_string> {
+  std::size_t operator()(const bstd::json::interned_string& _string) const
+    noexcept {
+    return std::hash<std::string_view>()(_string);
+  }
+};
+
+#endif
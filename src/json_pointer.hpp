@@ -0,0 +1,359 @@
+#ifndef BSTD_JSON_POINTER_HPP_
+#define BSTD_JSON_POINTER_HPP_
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "basic_json.hpp"
+#include "flat_object.hpp"
+
+namespace bstd::json {
+
+/// \brief A JSON Pointer (RFC 6901), parsed once and applied many times.
+/// The reference tokens are unescaped when the pointer is constructed; tokens
+/// that are array indices are converted to integers, and every token is
+/// hashed with hash_string(), so applying the pointer neither parses nor
+/// allocates. Objects with a `find(key, hash)` member, such as flat_object,
+/// use the precomputed hash; others are searched by key.
+/// \tparam _capacity std::dynamic_extent for a pointer of any length, which
+///                   allocates its tokens; otherwise the pointer holds up to
+///                   _capacity characters and tokens in place, so it can be
+///                   a constant expression. See static_json_pointer.
+template<std::size_t _capacity = std::dynamic_extent>
+class basic_json_pointer final {
+
+  public:
+
+    /// The index of a token that is not an array index, such as `-`.
+    static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+    /// \brief Construct a pointer to the whole document.
+    constexpr basic_json_pointer() noexcept = default;
+
+    /// \brief Parse a pointer.
+    /// \param _pointer a JSON Pointer, such as `/payload/items/0/price`; the
+    ///                 empty string refers to the whole document
+    /// \throws std::invalid_argument if _pointer is not empty and does not
+    ///         start with `/`, or has a `~` not followed by `0` or `1`
+    /// \throws std::length_error if _pointer does not fit in _capacity
+    constexpr explicit basic_json_pointer(const std::string_view _pointer);
+
+    /// \copydoc basic_json_pointer(const std::string_view)
+    template<std::size_t _n>
+    constexpr basic_json_pointer(const char (&_pointer)[_n])
+      : basic_json_pointer(std::string_view(_pointer, _n - 1)) {}
+
+    /// \brief Get the number of reference tokens.
+    constexpr std::size_t size() const noexcept { return m_tokens.size(); }
+
+    /// \brief Check if the pointer refers to the whole document.
+    constexpr bool empty() const noexcept { return size() == 0; }
+
+    /// \brief Get a reference token, unescaped.
+    /// \param _i the token's position
+    constexpr std::string_view key(const std::size_t _i) const noexcept {
+      return std::string_view(m_text.data() + m_tokens[_i].offset,
+          m_tokens[_i].size);
+    }
+
+    /// \brief Get the array index a reference token denotes.
+    /// \param _i the token's position
+    /// \return the index, or npos if the token is not an array index
+    constexpr std::size_t index(const std::size_t _i) const noexcept {
+      return m_tokens[_i].index;
+    }
+
+    /// \brief Get the pointer as text, escaped.
+    std::string to_string() const;
+
+    /// \brief Find the value the pointer refers to.
+    /// \param _json the document
+    /// \return the value, or nullptr if there is none
+    template<class Json>
+    const Json* find(const Json& _json) const {
+      return walk(_json, size());
+    }
+    /// \copydoc find()
+    template<class Json>
+    Json* find(Json& _json) const { return walk(_json, size()); }
+
+    /// \brief Find the object or array holding the value the pointer refers
+    ///        to, which need not exist itself.
+    /// \param _json the document
+    /// \return the container, or nullptr if there is none or the pointer
+    ///         refers to the whole document
+    template<class Json>
+    const Json* find_parent(const Json& _json) const {
+      return empty() ? nullptr : walk(_json, size() - 1);
+    }
+    /// \copydoc find_parent()
+    template<class Json>
+    Json* find_parent(Json& _json) const {
+      return empty() ? nullptr : walk(_json, size() - 1);
+    }
+
+    /// \brief Check if the pointer is a proper prefix of another.
+    /// \param _other the other pointer
+    /// \return true if _other refers to a value inside the one this pointer
+    ///         refers to
+    template<std::size_t _other_capacity>
+    bool is_prefix_of(const basic_json_pointer<_other_capacity>& _other) const
+      noexcept {
+      if(size() >= _other.size())
+        return false;
+
+      for(std::size_t i = 0; i < size(); ++i)
+        if(key(i) != _other.key(i))
+          return false;
+
+      return true;
+    }
+
+    /// \brief Access the value the pointer refers to.
+    /// \param _json the document
+    /// \return the value
+    /// \throws std::out_of_range if there is no such value
+    template<class Json>
+    const Json& at(const Json& _json) const { return at_value(_json); }
+    /// \copydoc at()
+    template<class Json>
+    Json& at(Json& _json) const { return at_value(_json); }
+
+  private:
+
+    struct token {
+      std::size_t offset{0};
+      std::size_t size{0};
+      std::size_t index{npos};
+      std::size_t hash{0};
+    };
+
+    /// \brief A fixed number of elements, of which only the first are used.
+    template<class T>
+    struct fixed_vector {
+      constexpr std::size_t size() const noexcept { return m_size; }
+      constexpr const T* data() const noexcept { return m_data.data(); }
+      constexpr const T& operator[](const std::size_t _i) const noexcept {
+        return m_data[_i];
+      }
+      constexpr void push_back(const T& _value) {
+        if(m_size == _capacity)
+          throw std::length_error("json_pointer: pointer is too long");
+        m_data[m_size++] = _value;
+      }
+
+      std::array<T, _capacity> m_data{};
+      std::size_t m_size{0};
+    };
+
+    static constexpr bool is_dynamic = _capacity == std::dynamic_extent;
+
+    template<class T>
+    using storage_type =
+      std::conditional_t<is_dynamic, std::vector<T>, fixed_vector<T>>;
+
+    /// \brief Get the array index a token denotes: `0`, or digits without a
+    ///        leading zero.
+    static constexpr std::size_t parse_index(const std::string_view _key);
+
+    /// \brief Find the value the pointer refers to.
+    /// Containers are accessed as mutably as _json is, so values reached
+    /// through a mutable document drop their memoized hashes.
+    /// \tparam Json a basic_json, const or not
+    /// \param _size how many tokens to follow
+    template<class Json>
+    Json* walk(Json& _json, const std::size_t _size) const;
+
+    /// \brief Access the value the pointer refers to; see walk().
+    template<class Json>
+    Json& at_value(Json& _json) const;
+
+    /// \brief Find the member of an object with the key of a token.
+    /// \tparam Object an object type, const or not
+    template<class Object>
+    auto find_member(Object& _object, const token& _token) const;
+
+    /// The unescaped tokens, one after another.
+    storage_type<char> m_text;
+    storage_type<token> m_tokens;
+
+};
+
+/// \brief A JSON Pointer that allocates as needed.
+using json_pointer = basic_json_pointer<>;
+
+/// \brief A JSON Pointer stored in place, for constant paths.
+/// `constexpr static_json_pointer price("/payload/items/0/price");` is
+/// parsed and hashed by the compiler, and a malformed path does not compile.
+template<std::size_t _capacity>
+using static_json_pointer = basic_json_pointer<_capacity>;
+
+template<std::size_t _n>
+basic_json_pointer(const char (&)[_n]) -> basic_json_pointer<_n>;
+
+
+template<std::size_t _capacity>
+constexpr
+basic_json_pointer<_capacity>::
+basic_json_pointer(const std::string_view _pointer) {
+  if(_pointer.empty())
+    return;
+
+  if(_pointer.front() != '/')
+    throw std::invalid_argument("json_pointer: pointer must start with '/'");
+
+  for(std::size_t i = 1; i <= _pointer.size(); ++i) {
+    token next;
+    next.offset = m_text.size();
+
+    for(; i < _pointer.size() and _pointer[i] != '/'; ++i) {
+      auto c = _pointer[i];
+      if(c == '~') {
+        if(++i == _pointer.size() or
+            (_pointer[i] != '0' and _pointer[i] != '1'))
+          throw std::invalid_argument("json_pointer: '~' must be followed by "
+              "'0' or '1'");
+        c = _pointer[i] == '0' ? '~' : '/';
+      }
+
+      m_text.push_back(c);
+    }
+
+    next.size = m_text.size() - next.offset;
+
+    const auto key = std::string_view(m_text.data() + next.offset, next.size);
+    next.index = parse_index(key);
+    next.hash = hash_string(key);
+    m_tokens.push_back(next);
+  }
+}
+
+
+template<std::size_t _capacity>
+std::string
+basic_json_pointer<_capacity>::
+to_string() const {
+  std::string text;
+  for(std::size_t i = 0; i < size(); ++i) {
+    text += '/';
+    for(const auto c : key(i)) {
+      if(c == '~')
+        text += "~0";
+      else if(c == '/')
+        text += "~1";
+      else
+        text += c;
+    }
+  }
+
+  return text;
+}
+
+
+template<std::size_t _capacity>
+template<class Json>
+Json*
+basic_json_pointer<_capacity>::
+walk(Json& _json, const std::size_t _size) const {
+  using json_type = std::remove_const_t<Json>;
+  using value_type = typename json_type::value_type;
+
+  auto value = &_json;
+  for(std::size_t i = 0; i < _size and value != nullptr; ++i) {
+    const auto& next = m_tokens[i];
+    switch (value->get_type()) {
+      case value_type::object:
+        value = find_member(
+            value->template get<typename json_type::object_type>(), next);
+        break;
+      case value_type::array: {
+        auto& array = value->template get<typename json_type::array_type>();
+        value = next.index < array.size() ? &array[next.index] : nullptr;
+        break;
+      }
+      case value_type::string:
+      case value_type::number:
+      case value_type::boolean:
+      case value_type::null:
+      default:
+        return nullptr;
+    }
+  }
+
+  return value;
+}
+
+
+template<std::size_t _capacity>
+template<class Json>
+Json&
+basic_json_pointer<_capacity>::
+at_value(Json& _json) const {
+  const auto value = walk(_json, size());
+  if(value == nullptr)
+    throw std::out_of_range("json_pointer::at: no value at " + to_string());
+
+  return *value;
+}
+
+
+template<std::size_t _capacity>
+constexpr std::size_t
+basic_json_pointer<_capacity>::
+parse_index(const std::string_view _key) {
+  if(_key.empty() or (_key.front() == '0' and _key.size() > 1))
+    return npos;
+
+  std::size_t index = 0;
+  for(const auto c : _key) {
+    if(c < '0' or c > '9')
+      return npos;
+
+    const auto digit = static_cast<std::size_t>(c - '0');
+    if(index > (npos - 1 - digit) / 10)
+      return npos;
+
+    index = index * 10 + digit;
+  }
+
+  return index;
+}
+
+
+template<std::size_t _capacity>
+template<class Object>
+auto
+basic_json_pointer<_capacity>::
+find_member(Object& _object, const token& _token) const {
+  const auto key = std::string_view(m_text.data() + _token.offset,
+      _token.size);
+
+  decltype(_object.begin()) member;
+  if constexpr(requires { _object.find(key, _token.hash); })
+    member = _object.find(key, _token.hash);
+  else if constexpr(requires { _object.find(key); })
+    member = _object.find(key);
+  else {
+    // The map needs its own key type; the copy reuses a buffer, so only a
+    // key longer than any before it allocates.
+    thread_local std::remove_const_t<typename std::remove_const_t<Object>::
+      key_type> buffer;
+    buffer.assign(key.data(), key.size());
+    member = _object.find(buffer);
+  }
+
+  return member == _object.end() ? nullptr : &member->second;
+}
+
+
+}
+
+#endif
@@ -0,0 +1,306 @@
+#ifndef BSTD_NUMBER_HPP_
+#define BSTD_NUMBER_HPP_
+
+#include <charconv>
+#include <cmath>
+#include <compare>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "parser/number_parser.hpp"
+
+namespace bstd::json {
+
+/// \brief A JSON number: a 64-bit signed or unsigned integer, a double, or
+///        the raw text of a number that has not been decoded yet.
+/// Integers keep their full precision; only numbers with a fraction or an
+/// exponent, and integers outside of the 64-bit ranges, are doubles. A raw
+/// number holds up to max_raw_size characters of text, and is decoded each
+/// time it is read until decode() is called, so numbers that are never read
+/// are never converted.
+/// number fits basic_json's NumberType parameter, and is its default.
+class number final {
+
+  public:
+
+    enum class kind : std::uint8_t {
+      integer,
+      unsigned_integer,
+      floating_point,
+      raw
+    };
+
+    /// The longest text a raw number can hold.
+    static constexpr std::size_t max_raw_size = 14;
+
+    number() noexcept : number(std::int64_t{0}) {}
+
+    /// \brief Construct from an integer.
+    /// Unsigned values that fit in an std::int64_t are stored as signed.
+    /// \param _integer the integer
+    template<class T>
+      requires std::is_integral_v<T> and (!std::is_same_v<T, bool>)
+    number(const T _integer) noexcept {
+      if constexpr(std::is_signed_v<T>)
+        store(kind::integer, static_cast<std::int64_t>(_integer));
+      else if(_integer > static_cast<std::uint64_t>(
+            std::numeric_limits<std::int64_t>::max()))
+        store(kind::unsigned_integer, static_cast<std::uint64_t>(_integer));
+      else
+        store(kind::integer, static_cast<std::int64_t>(_integer));
+    }
+
+    /// \brief Construct from a floating point value.
+    /// \param _floating_point the value
+    template<class T>
+      requires std::is_floating_point_v<T>
+    number(const T _floating_point) noexcept {
+      store(kind::floating_point, static_cast<double>(_floating_point));
+    }
+
+    /// \brief Decode the text of a number.
+    /// \param _text the text of a number as accepted by the scanner
+    /// \return the number
+    /// \see parser::decode_number()
+    static number parse(const std::string_view _text) noexcept {
+      const auto decoded = parser::decode_number(_text);
+
+      number result;
+      result.store(static_cast<kind>(decoded.m_kind), decoded.m_bits);
+      return result;
+    }
+
+    /// \brief Keep the text of a number to decode when it is first read.
+    /// \param _text the text of a number as accepted by the scanner
+    /// \return a raw number, or the decoded number if _text is longer than
+    ///         max_raw_size
+    static number from_raw(const std::string_view _text) noexcept {
+      if(_text.size() > max_raw_size)
+        return parse(_text);
+
+      number result;
+      std::memcpy(result.m_storage, _text.data(), _text.size());
+      result.m_tag = static_cast<std::uint8_t>(
+          static_cast<std::uint8_t>(kind::raw) | _text.size() << length_shift);
+      return result;
+    }
+
+    /// \brief Get how the number is stored.
+    /// \return the kind of the number
+    kind get_kind() const noexcept {
+      return static_cast<kind>(m_tag & kind_mask);
+    }
+
+    /// \brief Check if the number is an integer, decoding it if needed.
+    /// \return true if the number is a signed or unsigned integer
+    bool is_integer() const noexcept {
+      const auto value = get_decoded();
+      return value.get_kind() != kind::floating_point;
+    }
+
+    /// \brief Get the text of a raw number.
+    /// \return the text, or an empty view if the number is not raw
+    std::string_view get_raw() const noexcept {
+      if(get_kind() != kind::raw)
+        return {};
+
+      return {m_storage, static_cast<std::size_t>(m_tag >> length_shift)};
+    }
+
+    /// \brief Decode a raw number in place.
+    void decode() noexcept { *this = get_decoded(); }
+
+    /// \brief Get the number as an arithmetic type.
+    /// Integers convert to floating point types as with static_cast, and
+    /// floating point values to integer types saturate at T's range.
+    /// \tparam T an integer or floating point type
+    /// \return the value
+    template<class T>
+      requires std::is_arithmetic_v<T>
+    T get() const noexcept;
+
+    std::int64_t get_int64() const noexcept { return get<std::int64_t>(); }
+
+    std::uint64_t get_uint64() const noexcept { return get<std::uint64_t>(); }
+
+    double get_double() const noexcept { return get<double>(); }
+
+    template<class T>
+      requires std::is_arithmetic_v<T>
+    explicit operator T() const noexcept { return get<T>(); }
+
+    /// \brief Compare two numbers by value.
+    /// Comparisons are exact, also between an integer and a double: they are
+    /// equal only if the double is integral and holds exactly the integer's
+    /// value, so equality stays transitive for integers beyond 2^53.
+    friend bool operator==(const number& _lhs, const number& _rhs) noexcept {
+      return (_lhs <=> _rhs) == 0;
+    }
+
+    /// \copydoc operator==()
+    friend std::partial_ordering operator<=>(const number& _lhs,
+        const number& _rhs) noexcept;
+
+    friend std::ostream& operator<<(std::ostream& _os,
+        const number& _number) {
+      return _os << to_string(_number);
+    }
+
+    /// \brief Convert a number to the shortest text that reads back as the
+    ///        same value; raw numbers keep their text.
+    /// \param _number the number
+    /// \return the text of the number
+    friend std::string to_string(const number& _number) {
+      if(_number.get_kind() == kind::raw)
+        return std::string(_number.get_raw());
+
+      // Enough for any std::int64_t, std::uint64_t or shortest double.
+      char buffer[32];
+      const auto end = _number.to_chars(buffer, buffer + sizeof(buffer));
+      return std::string(buffer, end);
+    }
+
+  private:
+
+    /// \brief Write a decoded number with std::to_chars.
+    char* to_chars(char* _first, char* _last) const noexcept {
+      switch(get_kind()) {
+        case kind::integer:
+          return std::to_chars(_first, _last, load<std::int64_t>()).ptr;
+        case kind::unsigned_integer:
+          return std::to_chars(_first, _last, load<std::uint64_t>()).ptr;
+        default:
+          return std::to_chars(_first, _last, load<double>()).ptr;
+      }
+    }
+
+    /// \brief Compare an integer with a double without rounding either.
+    template<class T>
+    static std::partial_ordering compare_exactly(const T _integer,
+        const double _floating_point) noexcept;
+
+    static constexpr std::uint8_t kind_mask = 0x03;
+    static constexpr int length_shift = 4;
+
+    /// \brief Get the number, decoding it if it is raw.
+    number get_decoded() const noexcept {
+      return get_kind() == kind::raw ? parse(get_raw()) : *this;
+    }
+
+    template<class T>
+    void store(const kind _kind, const T _value) noexcept {
+      static_assert(sizeof(T) <= sizeof(m_storage));
+      std::memcpy(m_storage, &_value, sizeof(T));
+      m_tag = static_cast<std::uint8_t>(_kind);
+    }
+
+    template<class T>
+    T load() const noexcept {
+      T value;
+      std::memcpy(&value, m_storage, sizeof(T));
+      return value;
+    }
+
+    /// The value, or the text of a raw number. Kept unaligned so that a
+    /// number fits in basic_json's inline storage.
+    char m_storage[max_raw_size];
+
+    /// The kind in the low bits, and the length of raw text above them.
+    std::uint8_t m_tag;
+
+};
+
+static_assert(sizeof(number) == number::max_raw_size + 1);
+
+
+template<class T>
+  requires std::is_arithmetic_v<T>
+T
+number::
+get() const noexcept {
+  switch(get_kind()) {
+    case kind::integer:
+      return static_cast<T>(load<std::int64_t>());
+    case kind::unsigned_integer:
+      return static_cast<T>(load<std::uint64_t>());
+    case kind::raw:
+      return parse(get_raw()).template get<T>();
+    default:
+      break;
+  }
+
+  const auto floating_point = load<double>();
+  if constexpr(std::is_integral_v<T>) {
+    using limits = std::numeric_limits<T>;
+    if(!(floating_point > static_cast<double>(limits::min())))
+      return limits::min();
+    if(!(floating_point < static_cast<double>(limits::max())))
+      return limits::max();
+  }
+
+  return static_cast<T>(floating_point);
+}
+
+
+template<class T>
+std::partial_ordering
+number::
+compare_exactly(const T _integer, const double _floating_point) noexcept {
+  // Every T is at least -2^63, or 0, and below 2^63, or 2^64.
+  constexpr auto lowest = std::is_signed_v<T> ? -0x1p63 : 0.0;
+  constexpr auto limit = std::is_signed_v<T> ? 0x1p63 : 0x1p64;
+
+  if(std::isnan(_floating_point))
+    return std::partial_ordering::unordered;
+  if(_floating_point >= limit)
+    return std::partial_ordering::less;
+  if(_floating_point < lowest)
+    return std::partial_ordering::greater;
+
+  // The whole part of the double converts to T exactly; the fraction breaks
+  // ties.
+  const auto whole = std::trunc(_floating_point);
+  if(const auto integer = static_cast<T>(whole); _integer != integer)
+    return _integer <=> integer;
+  return 0.0 <=> _floating_point - whole;
+}
+
+
+inline std::partial_ordering
+operator<=>(const number& _lhs, const number& _rhs) noexcept {
+  const auto lhs = _lhs.get_decoded();
+  const auto rhs = _rhs.get_decoded();
+  const auto lhs_kind = lhs.get_kind();
+  const auto rhs_kind = rhs.get_kind();
+
+  if(lhs_kind == number::kind::floating_point and
+      rhs_kind == number::kind::floating_point)
+    return lhs.load<double>() <=> rhs.load<double>();
+
+  if(rhs_kind == number::kind::floating_point)
+    return lhs_kind == number::kind::integer ?
+      number::compare_exactly(lhs.load<std::int64_t>(), rhs.load<double>()) :
+      number::compare_exactly(lhs.load<std::uint64_t>(), rhs.load<double>());
+
+  if(lhs_kind == number::kind::floating_point)
+    return 0 <=> (rhs <=> lhs);
+
+  // Unsigned integers are all larger than any signed one.
+  if(lhs_kind != rhs_kind)
+    return lhs_kind == number::kind::integer ? std::partial_ordering::less :
+      std::partial_ordering::greater;
+
+  if(lhs_kind == number::kind::integer)
+    return lhs.load<std::int64_t>() <=> rhs.load<std::int64_t>();
+  return lhs.load<std::uint64_t>() <=> rhs.load<std::uint64_t>();
+}
+
+
+}
+
+#endif
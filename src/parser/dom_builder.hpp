@@ -0,0 +1,241 @@
+#ifndef BSTD_JSON_DOM_BUILDER_HPP_
+#define BSTD_JSON_DOM_BUILDER_HPP_
+
+#include <iterator>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "number.hpp"
+#include "string_parser.hpp"
+
+namespace bstd::json::parser {
+
+/// \brief When the numbers of a document are decoded.
+enum class number_mode {
+  /// Decode every number while parsing.
+  eager,
+  /// Keep the text of numbers, where the number type can hold it, and decode
+  /// each number when it is read. Parsing is faster when most numbers are
+  /// never read, and reads are slower until number::decode() is called.
+  lazy
+};
+
+/// \brief Grammar event handler that builds a basic_json.
+/// Finished values are kept on one contiguous value stack. When a container
+/// ends, its elements are moved off the top of the stack into a container of
+/// exactly the right size, so arrays are allocated once and strings and keys
+/// are moved, never copied, into the tree. Escapes in strings and keys are
+/// decoded, and strings without escapes are constructed straight from the
+/// input.
+/// Every string, array and object whose type accepts an allocator is
+/// constructed with the builder's, so a basic_json with allocator-aware
+/// containers, such as pmr_json, can be built entirely inside one memory
+/// resource.
+/// \tparam Json the basic_json type to build
+template<class Json>
+class dom_builder final {
+
+  public:
+
+    using json_type = Json;
+    using object_type = typename json_type::object_type;
+    using array_type = typename json_type::array_type;
+    using string_type = typename json_type::string_type;
+    using number_type = typename json_type::number_type;
+    using boolean_type = typename json_type::boolean_type;
+    using null_type = typename json_type::null_type;
+    using allocator_type = typename array_type::allocator_type;
+
+    /// \brief Construct a builder.
+    /// \param _allocator the allocator for all strings, arrays and objects
+    /// \param _numbers when to decode numbers
+    explicit dom_builder(const allocator_type& _allocator = allocator_type(),
+        const number_mode _numbers = number_mode::eager)
+      : m_allocator(_allocator), m_numbers(_numbers) {}
+
+    void begin_object() { m_frames.push_back(m_values.size()); }
+
+    void begin_array() { m_frames.push_back(m_values.size()); }
+
+    void end_object();
+
+    void end_array();
+
+    void key(const std::string_view _key) {
+      m_keys.push_back(make_key(unescape(_key, m_unescaped)));
+    }
+
+    void string(const std::string_view _string) {
+      m_values.emplace_back(make_string(unescape(_string, m_unescaped)));
+    }
+
+    void number(const std::string_view _number) {
+      if constexpr(std::is_same_v<number_type, bstd::json::number>)
+        if(m_numbers == number_mode::lazy) {
+          m_values.emplace_back(number_type::from_raw(_number));
+          return;
+        }
+
+      m_values.emplace_back(to_number(_number));
+    }
+
+    void boolean(const bool _boolean) {
+      m_values.emplace_back(boolean_type{_boolean});
+    }
+
+    void null() { m_values.emplace_back(null_type{}); }
+
+    /// \brief Add a key that is already decoded, such as one read from a
+    ///        binary format.
+    void decoded_key(const std::string_view _key) {
+      m_keys.push_back(make_key(_key));
+    }
+
+    /// \brief Add a string that is already decoded.
+    void decoded_string(const std::string_view _string) {
+      m_values.emplace_back(make_string(_string));
+    }
+
+    /// \brief Add a scalar value that is already decoded.
+    void value(json_type&& _value) { m_values.push_back(std::move(_value)); }
+
+    /// \brief Take the finished root value.
+    /// \return the root value, or a null value if nothing was built
+    json_type release();
+
+    /// \brief Discard all partially built values.
+    void clear() noexcept;
+
+    /// \brief Convert the text of a number to number_type.
+    /// \param _number the text of a number as accepted by the scanner
+    /// \return the number
+    static number_type to_number(const std::string_view _number);
+
+  private:
+
+    /// \brief Construct a string, with the builder's allocator if string_type
+    ///        takes one.
+    string_type make_string(const std::string_view _string) const {
+      if constexpr(std::uses_allocator_v<string_type, allocator_type>)
+        return string_type(_string, m_allocator);
+      else
+        return string_type(_string);
+    }
+
+    /// \brief Construct a key, interned if string_type can intern strings.
+    /// Keys come from a small, recurring set of names, unlike values, so they
+    /// are the only strings worth interning.
+    string_type make_key(const std::string_view _key) const {
+      if constexpr(requires { string_type::intern(_key); })
+        return string_type::intern(_key);
+      else
+        return make_string(_key);
+    }
+
+    using object_allocator_type = typename object_type::allocator_type;
+
+    allocator_type m_allocator;
+
+    number_mode m_numbers;
+
+    std::vector<json_type> m_values;
+
+    std::vector<string_type> m_keys;
+
+    /// Index in m_values of the first element of each open container.
+    std::vector<std::size_t> m_frames;
+
+    /// Holds the last string with escapes while it is decoded.
+    std::string m_unescaped;
+
+};
+
+
+template<class Json>
+void
+dom_builder<Json>::
+end_object() {
+  const auto first = m_values.begin() + m_frames.back();
+  m_frames.pop_back();
+
+  const auto size = static_cast<std::size_t>(m_values.end() - first);
+  auto key = m_keys.end() - size;
+
+  object_type object{object_allocator_type(m_allocator)};
+  if constexpr(requires { object.reserve(size); })
+    object.reserve(size);
+
+  // Later duplicates replace earlier ones.
+  for(auto value = first; value != m_values.end(); ++value, ++key) {
+    if(const auto it = object.find(*key); it != object.end())
+      it->second = std::move(*value);
+    else
+      object.emplace(std::move(*key), std::move(*value));
+  }
+
+  m_keys.erase(m_keys.end() - size, m_keys.end());
+  m_values.erase(first, m_values.end());
+  m_values.emplace_back(std::move(object));
+}
+
+
+template<class Json>
+void
+dom_builder<Json>::
+end_array() {
+  const auto first = m_values.begin() + m_frames.back();
+  m_frames.pop_back();
+
+  array_type array(std::make_move_iterator(first),
+      std::make_move_iterator(m_values.end()), m_allocator);
+
+  m_values.erase(first, m_values.end());
+  m_values.emplace_back(std::move(array));
+}
+
+
+template<class Json>
+typename dom_builder<Json>::json_type
+dom_builder<Json>::
+release() {
+  if(m_values.empty())
+    return json_type();
+
+  auto root = std::move(m_values.back());
+  clear();
+  return root;
+}
+
+
+template<class Json>
+void
+dom_builder<Json>::
+clear() noexcept {
+  m_values.clear();
+  m_keys.clear();
+  m_frames.clear();
+}
+
+
+template<class Json>
+typename dom_builder<Json>::number_type
+dom_builder<Json>::
+to_number(const std::string_view _number) {
+  const auto value = bstd::json::number::parse(_number);
+
+  if constexpr(std::is_same_v<number_type, bstd::json::number>)
+    return value;
+  else if constexpr(std::is_arithmetic_v<number_type>)
+    return value.template get<number_type>();
+  else
+    return static_cast<number_type>(value.get_double());
+}
+
+
+}
+
+#endif
@@ -0,0 +1,219 @@
+#ifndef BSTD_JSON_GRAMMAR_HPP_
+#define BSTD_JSON_GRAMMAR_HPP_
+
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "token.hpp"
+
+namespace bstd::json::parser {
+
+/// \brief Push-down automaton for the JSON grammar (https://www.json.org/).
+/// Tokens are pushed one at a time, so the automaton can be driven by a
+/// scanner, a tape, or input that arrives in pieces. Nesting is tracked on an
+/// explicit stack, so deeply nested input does not use any call stack.
+/// Every accepted token is forwarded to the handler as an event:
+///   - `begin_object()`, `end_object()`, `begin_array()`, `end_array()`
+///   - `key(std::string_view)` and `string(std::string_view)` with the raw
+///     contents of the string, without quotes; unescape() decodes them
+///   - `number(std::string_view)` with the text of the number
+///   - `boolean(bool)` and `null()`
+/// \tparam Handler receives the events
+template<class Handler>
+class grammar final {
+
+  public:
+
+    /// \brief Construct with a handler.
+    /// \param _handler the event handler; must outlive this object
+    explicit grammar(Handler& _handler) : m_handler(_handler) {}
+
+    /// \brief Push the next token.
+    /// Whitespace is ignored. `end_json` is accepted only after a complete
+    /// value.
+    /// \param _type the token type
+    /// \param _text the text of the token; for strings this excludes quotes
+    /// \return false if the token is not allowed here, true otherwise
+    bool push(const token::type _type, const std::string_view _text);
+
+    /// \brief Discard all state so a new JSON value can be pushed.
+    void reset() noexcept {
+      m_state = state::root_value;
+      m_containers.clear();
+    }
+
+    /// \brief Check if a complete JSON value has been pushed.
+    /// \return true if the root value is complete
+    bool is_complete() const noexcept { return m_state == state::done; }
+
+    /// \brief Get the handler events are forwarded to.
+    Handler& get_handler() noexcept { return m_handler; }
+
+    /// \brief Get the current nesting depth.
+    /// \return the number of open objects and arrays
+    std::size_t get_depth() const noexcept { return m_containers.size(); }
+
+  private:
+
+    /// What is allowed next.
+    enum class state : std::uint8_t {
+      root_value,
+      done,
+      key_or_end_object,
+      key,
+      colon,
+      object_value,
+      comma_or_end_object,
+      value_or_end_array,
+      array_value,
+      comma_or_end_array
+    };
+
+    /// \brief Forward a value token to the handler.
+    /// \return false if _type does not start a value
+    bool value(const token::type _type, const std::string_view _text);
+
+    /// \brief Update the state after a complete value.
+    void end_value() noexcept;
+
+    Handler& m_handler;
+
+    state m_state{state::root_value};
+
+    /// true for objects, false for arrays.
+    std::vector<bool> m_containers;
+
+};
+
+
+template<class Handler>
+bool
+grammar<Handler>::
+push(const token::type _type, const std::string_view _text) {
+  if(_type == token::whitespace)
+    return true;
+
+  switch(m_state) {
+    case state::root_value:
+    case state::object_value:
+    case state::array_value:
+      return value(_type, _text);
+
+    case state::value_or_end_array:
+      if(_type == token::end_array) {
+        m_containers.pop_back();
+        m_handler.end_array();
+        end_value();
+        return true;
+      }
+      return value(_type, _text);
+
+    case state::key_or_end_object:
+      if(_type == token::end_object) {
+        m_containers.pop_back();
+        m_handler.end_object();
+        end_value();
+        return true;
+      }
+      [[fallthrough]];
+    case state::key:
+      if(_type != token::string)
+        return false;
+      m_handler.key(_text);
+      m_state = state::colon;
+      return true;
+
+    case state::colon:
+      if(_type != token::colon)
+        return false;
+      m_state = state::object_value;
+      return true;
+
+    case state::comma_or_end_object:
+      if(_type == token::comma) {
+        m_state = state::key;
+        return true;
+      }
+      if(_type != token::end_object)
+        return false;
+      m_containers.pop_back();
+      m_handler.end_object();
+      end_value();
+      return true;
+
+    case state::comma_or_end_array:
+      if(_type == token::comma) {
+        m_state = state::array_value;
+        return true;
+      }
+      if(_type != token::end_array)
+        return false;
+      m_containers.pop_back();
+      m_handler.end_array();
+      end_value();
+      return true;
+
+    case state::done:
+      return _type == token::end_json;
+  }
+
+  return false;
+}
+
+
+template<class Handler>
+bool
+grammar<Handler>::
+value(const token::type _type, const std::string_view _text) {
+  switch(_type) {
+    case token::begin_object:
+      m_containers.push_back(true);
+      m_handler.begin_object();
+      m_state = state::key_or_end_object;
+      return true;
+    case token::begin_array:
+      m_containers.push_back(false);
+      m_handler.begin_array();
+      m_state = state::value_or_end_array;
+      return true;
+    case token::string:
+      m_handler.string(_text);
+      break;
+    case token::number:
+      m_handler.number(_text);
+      break;
+    case token::true_literal:
+      m_handler.boolean(true);
+      break;
+    case token::false_literal:
+      m_handler.boolean(false);
+      break;
+    case token::null_literal:
+      m_handler.null();
+      break;
+    default:
+      return false;
+  }
+
+  end_value();
+  return true;
+}
+
+
+template<class Handler>
+void
+grammar<Handler>::
+end_value() noexcept {
+  if(m_containers.empty())
+    m_state = state::done;
+  else if(m_containers.back())
+    m_state = state::comma_or_end_object;
+  else
+    m_state = state::comma_or_end_array;
+}
+
+
+}
+
+#endif
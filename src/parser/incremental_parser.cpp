@@ -0,0 +1,300 @@
+#include "incremental_parser.hpp"
+
+#include <algorithm>
+
+
+namespace bstd::json::parser {
+
+
+namespace {
+
+
+/// \brief Check if a character can be part of a number token.
+bool
+is_number_character(const char _c) {
+  return is_class(_c, digit_class | sign_class | exponent_class) or _c == '.';
+}
+
+
+/// \brief Check the contents of a string token.
+/// \param _first the opening quote
+/// \param _last one past the closing quote
+/// \return the error, or nullptr if the contents are valid UTF-8 with valid
+///         escapes
+const char*
+check_string(const char* const _first, const char* const _last) {
+  if(validate_utf8(_first + 1, _last - 1) != _last - 1)
+    return "Invalid UTF-8";
+  if(find_invalid_escape(_first + 1, _last - 1) != _last - 1)
+    return "Invalid escape";
+  return nullptr;
+}
+
+
+/// \brief Get the literal a literal token must spell.
+std::string_view
+get_literal(const token::type _type) {
+  switch(_type) {
+    case token::true_literal:
+      return "true";
+    case token::false_literal:
+      return "false";
+    default:
+      return "null";
+  }
+}
+
+
+}
+
+
+void
+incremental_parser::
+feed(const std::string_view _chunk) {
+  if(m_failed)
+    return;
+
+  set_container(_chunk);
+
+  if(m_partial_type != token::invalid)
+    advance_index(resume_partial());
+
+  const auto data = _chunk.data();
+  const auto last = data + _chunk.size();
+
+  while(!m_failed and m_partial_type == token::invalid
+      and get_element() != _chunk.cend()) {
+    const auto first = std::to_address(get_element());
+    const auto type = start_token(*first);
+    const auto end = scan_token(type, first, last);
+
+    // Check if the token may continue in the next chunk.
+    auto split = false;
+    switch(type) {
+      case token::string:
+        split = end == nullptr;
+        break;
+      case token::number:
+        split = std::all_of(first, last, is_number_character);
+        break;
+      case token::true_literal:
+      case token::false_literal:
+      case token::null_literal:
+        split = end == nullptr and get_literal(type).starts_with(
+            std::string_view(first, last));
+        break;
+      default:
+        break;
+    }
+
+    if(split) {
+      m_partial_type = type;
+      m_partial.assign(first, last);
+
+      m_escaped = false;
+      if(type == token::string)
+        for(const auto c : std::string_view(m_partial).substr(1))
+          m_escaped = !m_escaped and c == '\\';
+
+      break;
+    }
+
+    if(end == nullptr) {
+      fail("Character does not match the start of any valid JSON value");
+      break;
+    }
+
+    if(const auto error = type == token::string ? check_string(first, end) :
+        nullptr) {
+      fail(error);
+      break;
+    }
+
+    if(!push(type, std::string_view(first, end))) {
+      fail("Unexpected token");
+      break;
+    }
+
+    advance_index(end - first);
+  }
+
+  // The chunk is not referenced after this returns. After a failure, fail()
+  // has already moved the offset to the error.
+  if(!m_failed)
+    m_offset += _chunk.size();
+  set_container(std::string_view());
+}
+
+
+std::shared_ptr<json>
+incremental_parser::
+finish() {
+  // The last chunk may not be valid anymore.
+  set_container(std::string_view());
+
+  if(!m_failed and m_partial_type != token::invalid) {
+    const auto partial = std::string_view(m_partial);
+    const auto complete = m_partial_type == token::number and
+      scan_number(partial.data(), partial.data() + partial.size()) ==
+        partial.data() + partial.size();
+
+    if(!complete or !push(m_partial_type, partial))
+      fail("Unexpected end of JSON");
+  }
+
+  if(!m_failed and !m_grammar.push(token::end_json, {}))
+    fail("Unexpected end of JSON");
+
+  auto result = std::make_shared<json>(m_failed ? json() : m_builder.release());
+
+  if(m_debug) {
+    std::cout << *result << std::endl;
+  }
+
+  reset();
+  return result;
+}
+
+
+void
+incremental_parser::
+reset() noexcept {
+  set_container(std::string_view());
+  m_builder.clear();
+  m_grammar.reset();
+  m_partial_type = token::invalid;
+  m_partial.clear();
+  m_escaped = false;
+  m_offset = 0;
+  m_failed = false;
+}
+
+
+std::size_t
+incremental_parser::
+get_offset() const noexcept {
+  return m_offset + (get_element() - get_container().cbegin());
+}
+
+
+const std::string
+incremental_parser::
+to_string() const noexcept {
+  return "incremental_parser(offset: " + std::to_string(get_offset()) +
+    ", depth: " + std::to_string(m_grammar.get_depth()) + ")";
+}
+
+
+std::size_t
+incremental_parser::
+resume_partial() {
+  const auto& chunk = get_container();
+  std::size_t consumed = 0;
+
+  switch(m_partial_type) {
+    case token::string: {
+      auto closed = false;
+      while(consumed < chunk.size() and !closed) {
+        const auto c = chunk[consumed++];
+        if(m_escaped)
+          m_escaped = false;
+        else if(c == '\\')
+          m_escaped = true;
+        else
+          closed = c == '"';
+      }
+
+      m_partial.append(chunk.substr(0, consumed));
+      if(!closed)
+        return consumed;
+      break;
+    }
+
+    case token::number: {
+      while(consumed < chunk.size() and is_number_character(chunk[consumed]))
+        ++consumed;
+
+      m_partial.append(chunk.substr(0, consumed));
+      if(consumed == chunk.size())
+        return consumed;
+
+      const auto partial = std::string_view(m_partial);
+      if(scan_number(partial.data(), partial.data() + partial.size()) !=
+          partial.data() + partial.size()) {
+        fail("Invalid number");
+        return consumed;
+      }
+      break;
+    }
+
+    default: {
+      const auto literal = get_literal(m_partial_type);
+      consumed = std::min(literal.size() - m_partial.size(), chunk.size());
+
+      m_partial.append(chunk.substr(0, consumed));
+      if(!literal.starts_with(m_partial)) {
+        fail("Character does not match the start of any valid JSON value");
+        return consumed;
+      }
+
+      if(m_partial.size() < literal.size())
+        return consumed;
+      break;
+    }
+  }
+
+  const auto type = m_partial_type;
+  m_partial_type = token::invalid;
+
+  const auto error = type == token::string ? check_string(m_partial.data(),
+      m_partial.data() + m_partial.size()) : nullptr;
+  if(error)
+    fail(error);
+  else if(!push(type, m_partial))
+    fail("Unexpected token");
+
+  m_partial.clear();
+  return consumed;
+}
+
+
+bool
+incremental_parser::
+push(const token::type _type, std::string_view _text) {
+  // Consume quotes.
+  if(_type == token::string)
+    _text = _text.substr(1, _text.size() - 2);
+
+  return m_grammar.push(_type, _text);
+}
+
+
+void
+incremental_parser::
+fail(const std::string& _message) {
+  m_failed = true;
+
+  // Earlier chunks are gone, so the context is the current chunk, or the
+  // split token once the input has ended. get_offset() gives the absolute
+  // position.
+  const auto& chunk = get_container();
+  std::string context;
+  std::size_t position;
+  if(chunk.empty()) {
+    context = m_partial;
+    position = context.size();
+  }
+  else {
+    context.assign(chunk.cbegin(), chunk.cend());
+    position = get_element() - chunk.cbegin();
+    m_offset += position;
+  }
+
+  set_container(std::string_view());
+
+  report_error(bstd::error::context_error(context,
+        context.cbegin() + position, _message));
+}
+
+
+}
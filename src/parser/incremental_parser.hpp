@@ -0,0 +1,107 @@
+#ifndef BSTD_JSON_INCREMENTAL_PARSER_HPP_
+#define BSTD_JSON_INCREMENTAL_PARSER_HPP_
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <bstd_error.hpp>
+
+#include "basic_json.hpp"
+#include "dom_builder.hpp"
+#include "grammar.hpp"
+#include "parser_base.hpp"
+#include "scanner.hpp"
+#include "utf8.hpp"
+
+namespace bstd::json::parser {
+
+/// \brief Parse JSON that arrives in chunks.
+/// Chunks are pushed with feed() as they arrive and the json value is built
+/// as soon as each token is complete. A token that is split between chunks
+/// (e.g. in the middle of a string or number) is the only input that is kept
+/// between calls, so memory use is bounded by the nesting depth, the value
+/// being built, and one partial token.
+///
+///     incremental_parser p;
+///     while(read(socket, buffer))
+///       p.feed(buffer);
+///     auto json = p.finish();
+class incremental_parser final : public parser_base<std::string_view> {
+
+  public:
+
+    /// \brief Construct an incremental_parser object.
+    /// \param _debug debug flag
+    /// \param _throw if true, this class will throw errors when applicable
+    incremental_parser(const bool _debug = false, const bool _throw = true)
+        : parser_base(std::string_view(), _debug, _throw),
+          m_grammar(m_builder) {}
+
+    /// \brief Parse the next chunk of input.
+    /// The chunk is not referenced after this returns.
+    /// \param _chunk the next part of the JSON string
+    /// \throws bstd::error::context_error if m_throw is true and errors in the
+    ///         JSON string are found; its position is within _chunk, and
+    ///         get_offset() gives the offset in the whole input
+    void feed(const std::string_view _chunk);
+
+    /// \brief Signal the end of the input.
+    /// \return the parsed json object, or a null value if the input was
+    ///         invalid or incomplete
+    /// \throws bstd::error::error if m_throw is true and the input ended
+    ///         before a complete JSON value
+    std::shared_ptr<json> finish();
+
+    /// \brief Discard all state so a new JSON string can be parsed.
+    void reset() noexcept;
+
+    /// \brief Get the number of bytes fed so far.
+    /// \return the number of bytes fed since construction or reset(), or the
+    ///         offset of the error once the input was found invalid
+    std::size_t get_offset() const noexcept;
+
+    const std::string to_string() const noexcept override;
+
+  private:
+
+    /// \brief Continue the token that was split at the end of the last chunk.
+    /// \return the number of bytes of the current chunk that were consumed
+    std::size_t resume_partial();
+
+    /// \brief Push a complete token to the grammar.
+    /// \param _type the token type
+    /// \param _text the full text of the token, including quotes for strings
+    /// \return false if the token is invalid here
+    bool push(const token::type _type, std::string_view _text);
+
+    /// \brief Report an error at the current position in the chunk.
+    /// The error's context is only the current chunk, or the split token at
+    /// the end of the input, so memory stays bounded however much was fed.
+    /// \param _message the error message
+    void fail(const std::string& _message);
+
+    dom_builder<json> m_builder;
+
+    grammar<dom_builder<json>> m_grammar;
+
+    /// Type of the token that was split at the end of the last chunk, or
+    /// token::invalid if no token was split.
+    token::type m_partial_type{token::invalid};
+
+    /// Text of the split token received so far.
+    std::string m_partial;
+
+    /// True if a split string ended with an unescaped backslash.
+    bool m_escaped{false};
+
+    /// Bytes fed before the current chunk, or the offset of the error.
+    std::size_t m_offset{0};
+
+    bool m_failed{false};
+
+};
+
+}
+
+#endif
@@ -0,0 +1,713 @@
+#include "json_path.hpp"
+
+#include <bit>
+#include <stdexcept>
+#include <utility>
+
+#include "grammar.hpp"
+#include "number.hpp"
+#include "scanner.hpp"
+#include "string_parser.hpp"
+
+
+namespace bstd::json::parser {
+
+
+namespace {
+
+
+constexpr auto npos = std::numeric_limits<std::size_t>::max();
+
+
+[[noreturn]] void
+invalid_path(const char* const _what) {
+  throw std::invalid_argument(std::string("json_path: ") + _what);
+}
+
+
+std::size_t
+skip_whitespace(const std::string_view _path, std::size_t _i) noexcept {
+  while(_i < _path.size() and is_class(_path[_i], whitespace_class))
+    ++_i;
+
+  return _i;
+}
+
+
+/// \brief Check if a byte may appear in a name after `.`.
+bool
+is_name_character(const char _c) noexcept {
+  return (_c >= 'a' and _c <= 'z') or (_c >= 'A' and _c <= 'Z') or
+    (_c >= '0' and _c <= '9') or _c == '_' or _c == '-' or _c == '$' or
+    static_cast<unsigned char>(_c) >= 0x80;
+}
+
+
+/// \brief Parse a name after `.`.
+/// \return one past the name
+std::size_t
+parse_name(const std::string_view _path, std::size_t _i, std::string& _name) {
+  const auto first = _i;
+  while(_i < _path.size() and is_name_character(_path[_i]))
+    ++_i;
+
+  if(_i == first)
+    invalid_path("expected a name");
+
+  _name.assign(_path.substr(first, _i - first));
+  return _i;
+}
+
+
+/// \brief Parse a string in single or double quotes, with JSON escapes.
+/// \param _i the position of the opening quote
+/// \return one past the closing quote
+std::size_t
+parse_quoted(const std::string_view _path, std::size_t _i,
+    std::string& _string) {
+  const auto quote = _path[_i];
+  const auto first = ++_i;
+  for(; _i < _path.size() and _path[_i] != quote; ++_i)
+    if(_path[_i] == '\\')
+      ++_i;
+
+  if(_i >= _path.size())
+    invalid_path("unterminated string");
+
+  // Unknown escapes, such as `\'`, are kept as the character escaped.
+  std::string buffer;
+  _string.assign(unescape(_path.substr(first, _i - first), buffer));
+  return _i + 1;
+}
+
+
+/// \brief Parse a non-negative integer.
+/// \return one past the integer
+std::size_t
+parse_integer(const std::string_view _path, std::size_t _i,
+    std::size_t& _integer) {
+  if(_i < _path.size() and _path[_i] == '-')
+    invalid_path("negative indices are not supported when streaming");
+
+  const auto first = _i;
+  for(_integer = 0; _i < _path.size() and is_class(_path[_i], digit_class);
+      ++_i)
+    _integer = _integer * 10 + static_cast<std::size_t>(_path[_i] - '0');
+
+  if(_i == first)
+    invalid_path("expected an integer");
+
+  return _i;
+}
+
+
+}
+
+
+/// \brief Matches the steps of a json_path against grammar events.
+/// Each open container that a step can continue into has a frame, holding the
+/// steps its children are matched against; containers no step continues into
+/// only move a depth counter.
+class path_matcher final {
+
+  public:
+
+    /// \brief Where matches go; shared by the matchers run over elements that
+    ///        passed a filter.
+    struct sink {
+
+      explicit sink(const json_path_callback& _callback)
+        : m_callback(_callback) {}
+
+      /// \brief Report a value, or hold it while a match containing it is
+      ///        open.
+      void add(const std::string_view _value) {
+        if(m_open == 0)
+          m_callback(_value);
+        else
+          m_pending.emplace_back(_value.data(), _value.data() + _value.size());
+      }
+
+      /// \brief Open a match of a container.
+      /// \return the match, for end()
+      std::size_t begin(const char* const _first) {
+        m_pending.emplace_back(_first, nullptr);
+        ++m_open;
+        return m_pending.size() - 1;
+      }
+
+      /// \brief Close a match of a container, and report everything held once
+      ///        no match is open.
+      void end(const std::size_t _match, const char* const _last) {
+        m_pending[_match].second = _last;
+        if(--m_open != 0)
+          return;
+
+        for(const auto& [first, last] : m_pending)
+          m_callback(std::string_view(first, last));
+        m_pending.clear();
+      }
+
+      const json_path_callback& m_callback;
+
+      /// Matches in the order they start; open ones have no end yet.
+      std::vector<std::pair<const char*, const char*>> m_pending;
+
+      std::size_t m_open{0};
+
+    };
+
+    /// \brief Construct a matcher.
+    /// \param _path the path
+    /// \param _sink where matches go
+    /// \param _root the steps the root value has matched, as a bit set
+    path_matcher(const json_path& _path, sink& _sink,
+        const std::uint64_t _root)
+      : m_path(_path), m_steps(_path.m_steps),
+        m_final(std::uint64_t{1} << m_steps.size()), m_sink(_sink),
+        m_root(_root) {}
+
+    void token_span(const std::string_view _token) noexcept {
+      m_token = _token;
+    }
+
+    void begin_object() { begin_container(true); }
+
+    void begin_array() { begin_container(false); }
+
+    void end_object() { end_container(); }
+
+    void end_array() { end_container(); }
+
+    void key(const std::string_view _key);
+
+    void string(const std::string_view _string) {
+      scalar(token::string, _string);
+    }
+
+    void number(const std::string_view _number) {
+      scalar(token::number, _number);
+    }
+
+    void boolean(const bool _boolean) {
+      scalar(_boolean ? token::true_literal : token::false_literal, m_token);
+    }
+
+    void null() { scalar(token::null_literal, m_token); }
+
+  private:
+
+    using step = json_path::step;
+
+    struct frame {
+      /// Steps the children are matched against, without the end of the path.
+      std::uint64_t m_states;
+
+      /// Filter steps that apply to this container, and those it passes.
+      std::uint64_t m_filters;
+      std::uint64_t m_passed;
+
+      /// Position of the next element, for arrays.
+      std::size_t m_index;
+
+      /// The current member name, raw, for objects.
+      std::string_view m_key;
+
+      /// The opening bracket.
+      const char* m_first;
+
+      /// This container's own match in the sink, or npos.
+      std::size_t m_match;
+
+      bool m_is_object;
+    };
+
+    /// \brief Get the steps the next value has matched, and the filters that
+    ///        apply to it.
+    std::pair<std::uint64_t, std::uint64_t> enter();
+
+    /// \brief Check if a step selects the next child of a container.
+    bool selects(const step& _step, const frame& _parent);
+
+    /// \brief Check if a raw key is a name.
+    bool is_key(const std::string_view _key, const std::string_view _name) {
+      return unescape(_key, m_unescaped) == _name;
+    }
+
+    /// \brief Evaluate the comparison of a filter with a scalar.
+    bool compare(const step& _step, const token::type _type,
+        const std::string_view _text);
+
+    void scalar(const token::type _type, const std::string_view _text);
+
+    void begin_container(const bool _is_object);
+
+    void end_container();
+
+    const json_path& m_path;
+
+    const std::vector<step>& m_steps;
+
+    /// The bit for the end of the path: a value with it is a match.
+    const std::uint64_t m_final;
+
+    sink& m_sink;
+
+    /// The steps the root value has matched; consumed by the root.
+    std::uint64_t m_root;
+
+    std::vector<frame> m_frames;
+
+    /// The number of containers open inside one that no step continues into.
+    std::size_t m_skip{0};
+
+    std::string_view m_token;
+
+    std::string m_unescaped;
+
+};
+
+
+void
+path_matcher::
+key(const std::string_view _key) {
+  if(m_skip != 0)
+    return;
+
+  auto& parent = m_frames.back();
+  parent.m_key = _key;
+
+  // Until a scalar value says otherwise, a member that is present exists, and
+  // compares only as unequal.
+  for(auto bits = parent.m_filters; bits != 0; bits &= bits - 1) {
+    const auto i = std::countr_zero(bits);
+    const auto& filter = m_steps[i];
+    if(!filter.m_member or !is_key(_key, filter.m_name))
+      continue;
+
+    const auto bit = std::uint64_t{1} << i;
+    if(filter.m_comparison == json_path::comparison::exists or
+        filter.m_comparison == json_path::comparison::not_equal)
+      parent.m_passed |= bit;
+    else
+      parent.m_passed &= ~bit;
+  }
+}
+
+
+std::pair<std::uint64_t, std::uint64_t>
+path_matcher::
+enter() {
+  if(m_frames.empty())
+    return {std::exchange(m_root, 0), 0};
+
+  auto& parent = m_frames.back();
+
+  std::uint64_t states = 0;
+  std::uint64_t filters = 0;
+  for(auto bits = parent.m_states; bits != 0; bits &= bits - 1) {
+    const auto i = std::countr_zero(bits);
+    const auto& next = m_steps[i];
+
+    if(next.m_descendant)
+      states |= std::uint64_t{1} << i;
+
+    if(next.m_selector == json_path::selector::filter)
+      filters |= std::uint64_t{1} << i;
+    else if(selects(next, parent))
+      states |= std::uint64_t{1} << (i + 1);
+  }
+
+  ++parent.m_index;
+  return {states, filters};
+}
+
+
+bool
+path_matcher::
+selects(const step& _step, const frame& _parent) {
+  switch(_step.m_selector) {
+    case json_path::selector::name:
+      return _parent.m_is_object and is_key(_parent.m_key, _step.m_name);
+    case json_path::selector::wildcard:
+      return true;
+    case json_path::selector::index:
+      return !_parent.m_is_object and _parent.m_index == _step.m_start;
+    case json_path::selector::slice:
+      return !_parent.m_is_object and _parent.m_index >= _step.m_start and
+        _parent.m_index < _step.m_end and
+        (_parent.m_index - _step.m_start) % _step.m_step == 0;
+    case json_path::selector::filter:
+    default:
+      return false;
+  }
+}
+
+
+bool
+path_matcher::
+compare(const step& _step, const token::type _type,
+    const std::string_view _text) {
+  using comparison = json_path::comparison;
+
+  if(_step.m_comparison == comparison::exists)
+    return true;
+
+  // The sign of the value compared with the literal; booleans and null are
+  // only equal or not.
+  auto order = 0;
+  auto ordered = true;
+  switch(_step.m_literal_type) {
+    case token::number:
+      if(_type != token::number)
+        return _step.m_comparison == comparison::not_equal;
+      {
+        const auto value = number::parse(_text).get_double();
+        order = (value > _step.m_literal_number) -
+          (value < _step.m_literal_number);
+      }
+      break;
+    case token::string:
+      if(_type != token::string)
+        return _step.m_comparison == comparison::not_equal;
+      order = unescape(_text, m_unescaped).compare(_step.m_literal);
+      break;
+    default:
+      if(_type != token::true_literal and _type != token::false_literal and
+          _type != token::null_literal)
+        return _step.m_comparison == comparison::not_equal;
+      order = _type == _step.m_literal_type ? 0 : 1;
+      ordered = order == 0;
+      break;
+  }
+
+  switch(_step.m_comparison) {
+    case comparison::equal:
+      return order == 0;
+    case comparison::not_equal:
+      return order != 0;
+    case comparison::less:
+      return ordered and order < 0;
+    case comparison::less_equal:
+      return ordered and order <= 0;
+    case comparison::greater:
+      return ordered and order > 0;
+    case comparison::greater_equal:
+      return ordered and order >= 0;
+    case comparison::exists:
+    default:
+      return true;
+  }
+}
+
+
+void
+path_matcher::
+scalar(const token::type _type, const std::string_view _text) {
+  if(m_skip != 0)
+    return;
+
+  // A member of an element being filtered decides a condition on it.
+  if(!m_frames.empty() and m_frames.back().m_filters != 0 and
+      m_frames.back().m_is_object) {
+    auto& parent = m_frames.back();
+    for(auto bits = parent.m_filters; bits != 0; bits &= bits - 1) {
+      const auto i = std::countr_zero(bits);
+      const auto& filter = m_steps[i];
+      if(!filter.m_member or
+          filter.m_comparison == json_path::comparison::exists or
+          !is_key(parent.m_key, filter.m_name))
+        continue;
+
+      const auto bit = std::uint64_t{1} << i;
+      if(compare(filter, _type, _text))
+        parent.m_passed |= bit;
+      else
+        parent.m_passed &= ~bit;
+    }
+  }
+
+  auto [states, filters] = enter();
+  for(; filters != 0; filters &= filters - 1) {
+    const auto i = std::countr_zero(filters);
+    const auto& filter = m_steps[i];
+
+    // A scalar has no members, so only unequal compares true with one.
+    if(filter.m_member ?
+        filter.m_comparison == json_path::comparison::not_equal :
+        compare(filter, _type, _text))
+      states |= std::uint64_t{1} << (i + 1);
+  }
+
+  if(states & m_final)
+    m_sink.add(m_token);
+}
+
+
+void
+path_matcher::
+begin_container(const bool _is_object) {
+  if(m_skip != 0) {
+    ++m_skip;
+    return;
+  }
+
+  const auto [states, filters] = enter();
+  if(states == 0 and filters == 0) {
+    m_skip = 1;
+    return;
+  }
+
+  // Until its members are seen, a container exists and has no member to
+  // compare, except that a missing member is unequal to anything.
+  std::uint64_t passed = 0;
+  for(auto bits = filters; bits != 0; bits &= bits - 1) {
+    const auto i = std::countr_zero(bits);
+    const auto& filter = m_steps[i];
+    if(filter.m_member ?
+        filter.m_comparison == json_path::comparison::not_equal :
+        filter.m_comparison == json_path::comparison::exists)
+      passed |= std::uint64_t{1} << i;
+  }
+
+  const auto first = m_token.data();
+  m_frames.push_back(frame{states & ~m_final, filters, passed, 0, {}, first,
+      states & m_final ? m_sink.begin(first) : npos, _is_object});
+}
+
+
+void
+path_matcher::
+end_container() {
+  if(m_skip != 0) {
+    --m_skip;
+    return;
+  }
+
+  const auto ended = m_frames.back();
+  m_frames.pop_back();
+
+  const auto last = m_token.data() + 1;
+  if(ended.m_match != npos)
+    m_sink.end(ended.m_match, last);
+
+  // The steps after the filters the container passed are run over it again.
+  if(const auto passed = ended.m_passed & ended.m_filters; passed != 0) {
+    path_matcher matcher(m_path, m_sink, passed << 1);
+    grammar<path_matcher> element_grammar(matcher);
+    push_tokens(std::string_view(ended.m_first, last), element_grammar);
+    element_grammar.push(token::end_json, {});
+  }
+}
+
+
+json_path::
+json_path(const std::string_view _path) {
+  if(_path.empty() or _path.front() != '$')
+    invalid_path("a path must start with '$'");
+
+  for(std::size_t i = 1; i < _path.size(); ) {
+    step next;
+    if(_path[i] == '.') {
+      if(++i < _path.size() and _path[i] == '.') {
+        next.m_descendant = true;
+        ++i;
+      }
+
+      if(i < _path.size() and _path[i] == '*')
+        ++i;
+      else if(next.m_descendant and i < _path.size() and _path[i] == '[')
+        i = parse_bracket(_path, i + 1, next);
+      else {
+        i = parse_name(_path, i, next.m_name);
+        next.m_selector = selector::name;
+      }
+    }
+    else if(_path[i] == '[')
+      i = parse_bracket(_path, i + 1, next);
+    else
+      invalid_path("expected '.' or '['");
+
+    if(m_steps.size() == max_steps)
+      invalid_path("too many steps");
+
+    m_steps.push_back(std::move(next));
+  }
+}
+
+
+sax_result
+json_path::
+query(const std::string_view _json, const json_path_callback& _callback,
+    const bool _throw) const {
+  path_matcher::sink matches(_callback);
+  path_matcher matcher(*this, matches, 1);
+  grammar<path_matcher> json_grammar(matcher);
+
+  auto result = push_tokens(_json, json_grammar);
+  if(!result.error and !json_grammar.push(token::end_json, {}))
+    result.error = "Unexpected end of JSON";
+
+  if(!result and _throw) {
+    const std::string context(_json);
+    throw bstd::error::context_error(context, context.cbegin() + result.offset,
+        result.error);
+  }
+
+  return result;
+}
+
+
+std::vector<std::string_view>
+json_path::
+select(const std::string_view _json) const {
+  std::vector<std::string_view> values;
+  query(_json, [&values](const std::string_view _value) {
+      values.push_back(_value);
+    });
+
+  return values;
+}
+
+
+std::size_t
+json_path::
+parse_bracket(const std::string_view _path, std::size_t _i, step& _step) {
+  _i = skip_whitespace(_path, _i);
+  if(_i == _path.size())
+    invalid_path("unterminated '['");
+
+  const auto c = _path[_i];
+  if(c == '*')
+    ++_i;
+  else if(c == '\'' or c == '"') {
+    _i = parse_quoted(_path, _i, _step.m_name);
+    _step.m_selector = selector::name;
+  }
+  else if(c == '?') {
+    _i = parse_filter(_path, _i + 1, _step);
+    _step.m_selector = selector::filter;
+  }
+  else {
+    if(c != ':')
+      _i = skip_whitespace(_path, parse_integer(_path, _i, _step.m_start));
+
+    if(_i < _path.size() and _path[_i] == ':') {
+      _step.m_selector = selector::slice;
+
+      _i = skip_whitespace(_path, _i + 1);
+      if(_i < _path.size() and _path[_i] != ':' and _path[_i] != ']')
+        _i = skip_whitespace(_path, parse_integer(_path, _i, _step.m_end));
+
+      if(_i < _path.size() and _path[_i] == ':') {
+        _i = skip_whitespace(_path, _i + 1);
+        if(_i < _path.size() and _path[_i] != ']')
+          _i = parse_integer(_path, _i, _step.m_step);
+        if(_step.m_step == 0)
+          invalid_path("a slice step must be positive");
+      }
+    }
+    else
+      _step.m_selector = selector::index;
+  }
+
+  _i = skip_whitespace(_path, _i);
+  if(_i == _path.size() or _path[_i] != ']')
+    invalid_path("expected ']'");
+
+  return _i + 1;
+}
+
+
+std::size_t
+json_path::
+parse_filter(const std::string_view _path, std::size_t _i, step& _step) {
+  _i = skip_whitespace(_path, _i);
+  const auto parenthesized = _i < _path.size() and _path[_i] == '(';
+  if(parenthesized)
+    _i = skip_whitespace(_path, _i + 1);
+
+  if(_i == _path.size() or _path[_i] != '@')
+    invalid_path("a filter must test '@'");
+
+  ++_i;
+  if(_i < _path.size() and _path[_i] == '.') {
+    _i = parse_name(_path, _i + 1, _step.m_name);
+    _step.m_member = true;
+  }
+  else if(_i < _path.size() and _path[_i] == '[') {
+    _i = skip_whitespace(_path, _i + 1);
+    if(_i == _path.size() or (_path[_i] != '\'' and _path[_i] != '"'))
+      invalid_path("expected a quoted name");
+
+    _i = skip_whitespace(_path, parse_quoted(_path, _i, _step.m_name));
+    if(_i == _path.size() or _path[_i] != ']')
+      invalid_path("expected ']'");
+
+    ++_i;
+    _step.m_member = true;
+  }
+
+  _i = skip_whitespace(_path, _i);
+
+  constexpr std::pair<std::string_view, comparison> comparisons[] = {
+    {"==", comparison::equal},
+    {"!=", comparison::not_equal},
+    {"<=", comparison::less_equal},
+    {">=", comparison::greater_equal},
+    {"<", comparison::less},
+    {">", comparison::greater}
+  };
+
+  for(const auto& [text, type] : comparisons) {
+    if(_path.substr(_i, text.size()) != text)
+      continue;
+
+    _step.m_comparison = type;
+    _i = skip_whitespace(_path, _i + text.size());
+    if(_i == _path.size())
+      invalid_path("expected a literal");
+
+    const auto first = _path.data() + _i;
+    const auto last = _path.data() + _path.size();
+    if(_path[_i] == '\'' or _path[_i] == '"') {
+      _i = parse_quoted(_path, _i, _step.m_literal);
+      _step.m_literal_type = token::string;
+    }
+    else if(const auto end = scan_literal(first, last, "true")) {
+      _i += static_cast<std::size_t>(end - first);
+      _step.m_literal_type = token::true_literal;
+    }
+    else if(const auto end = scan_literal(first, last, "false")) {
+      _i += static_cast<std::size_t>(end - first);
+      _step.m_literal_type = token::false_literal;
+    }
+    else if(const auto end = scan_literal(first, last, "null")) {
+      _i += static_cast<std::size_t>(end - first);
+      _step.m_literal_type = token::null_literal;
+    }
+    else if(const auto end = start_token(*first) == token::number ?
+        scan_number(first, last) : nullptr) {
+      _i += static_cast<std::size_t>(end - first);
+      _step.m_literal_type = token::number;
+      _step.m_literal_number =
+        number::parse(std::string_view(first, end)).get_double();
+    }
+    else
+      invalid_path("expected a literal");
+
+    break;
+  }
+
+  _i = skip_whitespace(_path, _i);
+  if(parenthesized) {
+    if(_i == _path.size() or _path[_i] != ')')
+      invalid_path("expected ')'");
+    _i = skip_whitespace(_path, _i + 1);
+  }
+
+  return _i;
+}
+
+
+}
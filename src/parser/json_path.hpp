@@ -0,0 +1,137 @@
+#ifndef BSTD_JSON_JSON_PATH_HPP_
+#define BSTD_JSON_JSON_PATH_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "sax.hpp"
+#include "token.hpp"
+
+namespace bstd::json::parser {
+
+/// \brief Receives the values matched by json_path::query(), as their text in
+///        the JSON string, including quotes and brackets.
+using json_path_callback = std::function<void(std::string_view)>;
+
+/// \brief A JSONPath query, compiled once and run over JSON strings as they
+///        are scanned.
+/// The supported subset is:
+///   - `$`, the root
+///   - `.name` and `['name']`, a member
+///   - `.*` and `[*]`, every member or element
+///   - `[2]`, an element
+///   - `[start:end:step]`, a slice, with non-negative bounds
+///   - `..name`, `..*` and `..[...]`, recursive descent
+///   - `[?(@.name op literal)]`, `[?(@ op literal)]` and `[?(@.name)]`,
+///     filters, where op is one of `==`, `!=`, `<`, `<=`, `>` and `>=`, and
+///     the literal is a number, a quoted string, `true`, `false` or `null`
+/// The path is compiled into a list of steps, and a query tracks which steps
+/// the current value has matched as a bit set, so it never builds a DOM.
+/// A container that no step can continue into is skipped by counting its
+/// brackets. An element that a filter applies to is matched against the
+/// filter as it is scanned, and only if it passes are the steps after the
+/// filter run over its text.
+class json_path final {
+
+  public:
+
+    /// \brief Compile a path.
+    /// \param _path a JSONPath expression starting with `$`
+    /// \throws std::invalid_argument if _path is not in the supported subset
+    explicit json_path(const std::string_view _path);
+
+    /// \brief Find the values a JSON string has at the path.
+    /// Values are reported in the order they start in the JSON string, each
+    /// as soon as it and every match containing it have ended; only values
+    /// found past a filter wait for the end of the element that passed it,
+    /// and follow the other values found in that element. A value that
+    /// matches more than one way is reported once per way.
+    /// \param _json the JSON string
+    /// \param _callback receives each value
+    /// \param _throw if true, errors are thrown instead of only being returned
+    /// \return the result of parsing _json; values reported before an error
+    ///         are not undone
+    /// \throws bstd::error::context_error if _throw is true and the JSON string
+    ///         is invalid
+    sax_result query(const std::string_view _json,
+        const json_path_callback& _callback, const bool _throw = true) const;
+
+    /// \brief Find the values a JSON string has at the path.
+    /// \param _json the JSON string
+    /// \return views of the values in _json
+    /// \throws bstd::error::context_error if the JSON string is invalid
+    std::vector<std::string_view> select(const std::string_view _json) const;
+
+  private:
+
+    friend class path_matcher;
+
+    /// The steps a path can be made of.
+    enum class selector : std::uint8_t {
+      name,
+      wildcard,
+      index,
+      slice,
+      filter
+    };
+
+    /// Filter comparisons; `exists` is a filter with no comparison.
+    enum class comparison : std::uint8_t {
+      exists,
+      equal,
+      not_equal,
+      less,
+      less_equal,
+      greater,
+      greater_equal
+    };
+
+    struct step {
+      selector m_selector{selector::wildcard};
+
+      /// Whether the step matches at any depth rather than only children.
+      bool m_descendant{false};
+
+      /// The member name, unescaped.
+      std::string m_name;
+
+      /// The element, or the bounds of a slice.
+      std::size_t m_start{0};
+      std::size_t m_end{std::numeric_limits<std::size_t>::max()};
+      std::size_t m_step{1};
+
+      /// For filters: whether the condition tests a member of the element
+      /// (m_name) rather than the element itself, and what it compares with.
+      bool m_member{false};
+      comparison m_comparison{comparison::exists};
+      token::type m_literal_type{token::null_literal};
+      std::string m_literal;
+      double m_literal_number{0};
+    };
+
+    /// Steps are tracked in 64-bit sets, with one more bit for the end of the
+    /// path.
+    static constexpr std::size_t max_steps = 63;
+
+    /// \brief Parse the text after `[`.
+    /// \return one past the closing `]`
+    std::size_t parse_bracket(const std::string_view _path, std::size_t _i,
+        step& _step);
+
+    /// \brief Parse the text after `[?`.
+    /// \return one past the end of the filter, before `]`
+    std::size_t parse_filter(const std::string_view _path, std::size_t _i,
+        step& _step);
+
+    std::vector<step> m_steps;
+
+};
+
+}
+
+#endif
@@ -0,0 +1,271 @@
+#include "lazy_document.hpp"
+
+#include "dom_builder.hpp"
+#include "grammar.hpp"
+#include "sax.hpp"
+#include "string_parser.hpp"
+#include "utilities/json_file_util.hpp"
+
+
+namespace bstd::json::parser {
+
+
+json::value_type
+lazy_value::
+get_type() const noexcept {
+  switch(m_tape->get_type(m_index)) {
+    case token::begin_object:
+      return json::value_type::object;
+    case token::begin_array:
+      return json::value_type::array;
+    case token::string:
+      return json::value_type::string;
+    case token::number:
+      return json::value_type::number;
+    case token::true_literal:
+    case token::false_literal:
+      return json::value_type::boolean;
+    default:
+      return json::value_type::null;
+  }
+}
+
+
+std::optional<lazy_value>
+lazy_value::
+find(const std::string_view _key) const {
+  require(token::begin_object, "find is only defined for objects.");
+
+  // Later duplicates replace earlier ones, so keep looking after a match.
+  std::optional<lazy_value> found;
+  std::string unescaped;
+  auto index = skip_whitespace(m_index + 1);
+  while(m_tape->get_type(index) == token::string) {
+    const auto key = m_tape->get_text(index);
+    // Skip the key, whitespace, colon and whitespace.
+    const auto value = skip_whitespace(skip_whitespace(index + 1) + 1);
+
+    if(unescape(key.substr(1, key.size() - 2), unescaped) == _key)
+      found = lazy_value(*m_tape, value);
+
+    index = skip_value(value);
+    if(m_tape->get_type(index) == token::comma)
+      index = skip_whitespace(index + 1);
+  }
+
+  return found;
+}
+
+
+lazy_value
+lazy_value::
+at(const std::string_view _key) const {
+  const auto value = find(_key);
+  if(!value)
+    throw std::out_of_range("lazy_value::at: no member named " +
+        std::string(_key));
+
+  return *value;
+}
+
+
+lazy_value
+lazy_value::
+at(const std::size_t _index) const {
+  require(token::begin_array, "at(index) is only defined for arrays.");
+
+  auto index = skip_whitespace(m_index + 1);
+  for(std::size_t i = 0; m_tape->get_type(index) != token::end_array; ++i) {
+    if(i == _index)
+      return lazy_value(*m_tape, index);
+
+    index = skip_value(index);
+    if(m_tape->get_type(index) == token::comma)
+      index = skip_whitespace(index + 1);
+  }
+
+  throw std::out_of_range("lazy_value::at: index " + std::to_string(_index) +
+      " is out of range");
+}
+
+
+std::size_t
+lazy_value::
+size() const {
+  const auto type = m_tape->get_type(m_index);
+  if(type != token::begin_object and type != token::begin_array)
+    throw std::domain_error("size is only defined for objects and arrays.");
+
+  auto index = skip_whitespace(m_index + 1);
+  const auto end = m_tape->get_matching(m_index);
+  if(index == end)
+    return 0;
+
+  // Every child but the last is followed by a comma. Commas inside children
+  // are skipped along with them.
+  std::size_t size = 1;
+  for(; index != end; ++index) {
+    const auto child = m_tape->get_type(index);
+    if(child == token::comma)
+      ++size;
+    else if(child == token::begin_object or child == token::begin_array)
+      index = m_tape->get_matching(index);
+  }
+
+  return size;
+}
+
+
+std::string_view
+lazy_value::
+get_text() const noexcept {
+  const auto type = m_tape->get_type(m_index);
+  if(type != token::begin_object and type != token::begin_array)
+    return m_tape->get_text(m_index);
+
+  const auto first = m_tape->get_offset(m_index);
+  const auto last = m_tape->get_offset(m_tape->get_matching(m_index)) + 1;
+  return m_tape->get_json().substr(first, last - first);
+}
+
+
+json
+lazy_value::
+get_json() const {
+  dom_builder<json> builder;
+  grammar<dom_builder<json>> json_grammar(builder);
+
+  const auto type = m_tape->get_type(m_index);
+  const auto last = type == token::begin_object or type == token::begin_array ?
+    m_tape->get_matching(m_index) : m_index;
+
+  for(auto index = m_index; index <= last; ++index) {
+    auto text = m_tape->get_text(index);
+    // Consume quotes.
+    if(m_tape->get_type(index) == token::string)
+      text = text.substr(1, text.size() - 2);
+
+    json_grammar.push(m_tape->get_type(index), text);
+  }
+
+  return builder.release();
+}
+
+
+std::size_t
+lazy_value::
+skip_value(const std::size_t _index) const noexcept {
+  const auto type = m_tape->get_type(_index);
+  if(type == token::begin_object or type == token::begin_array)
+    return skip_whitespace(m_tape->get_matching(_index) + 1);
+
+  return skip_whitespace(_index + 1);
+}
+
+
+std::size_t
+lazy_value::
+skip_whitespace(std::size_t _index) const noexcept {
+  while(m_tape->get_type(_index) == token::whitespace)
+    ++_index;
+
+  return _index;
+}
+
+
+void
+lazy_value::
+require(const token::type _type, const char* const _what) const {
+  if(m_tape->get_type(m_index) != _type)
+    throw std::domain_error(_what);
+}
+
+
+lazy_document::
+lazy_document(const std::string_view _json_string, const bool _debug,
+    const bool _throw) : m_lexer(_json_string, _debug, _throw) {
+  validate(_throw);
+}
+
+
+lazy_document::
+lazy_document(const std::string_view _json_string,
+    std::shared_ptr<const void> _owner, const bool _debug, const bool _throw)
+    : m_owner(std::move(_owner)), m_lexer(_json_string, _debug, _throw) {
+  validate(_throw);
+}
+
+
+bool
+lazy_document::
+is_valid() const noexcept {
+  return m_valid;
+}
+
+
+lazy_value
+lazy_document::
+get_root() const {
+  if(!m_valid)
+    throw std::domain_error("lazy_document::get_root: invalid JSON");
+
+  const lazy_value first(get_tape(), 0);
+  return lazy_value(get_tape(), first.skip_whitespace(0));
+}
+
+
+const tape&
+lazy_document::
+get_tape() const noexcept {
+  return m_lexer.get_tape();
+}
+
+
+void
+lazy_document::
+validate(const bool _throw) {
+  m_lexer.lex();
+
+  const auto& t = get_tape();
+
+  // Only token types matter to the grammar.
+  null_handler handler;
+  grammar<null_handler> json_grammar(handler);
+
+  std::size_t index = 0;
+  while(index < t.size() and json_grammar.push(t.get_type(index), {}))
+    ++index;
+
+  m_valid = index == t.size();
+
+  // The lexer has already reported invalid tokens.
+  if(m_valid or t.get_type(index) == token::invalid)
+    return;
+
+  const std::string context(t.get_json());
+  const auto error = bstd::error::context_error(context,
+      context.cbegin() + t.get_offset(index), "Unexpected token");
+
+  if(_throw)
+    throw error;
+
+  std::cerr << error.what() << std::endl;
+}
+
+
+std::shared_ptr<lazy_document>
+parse_lazy(const std::string_view _string, const bool _debug,
+    const bool _throw) {
+  // Could be a .json file path or a JSON string.
+  auto file = std::make_shared<utilities::mapped_file>(
+      utilities::map_json_file(_string));
+
+  if(file->is_open())
+    return std::make_shared<lazy_document>(file->get_view(), file, _debug,
+        _throw);
+
+  return std::make_shared<lazy_document>(_string, _debug, _throw);
+}
+
+
+}
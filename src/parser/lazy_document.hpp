@@ -0,0 +1,179 @@
+#ifndef BSTD_JSON_LAZY_DOCUMENT_HPP_
+#define BSTD_JSON_LAZY_DOCUMENT_HPP_
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <bstd_error.hpp>
+
+#include "basic_json.hpp"
+#include "lexer.hpp"
+#include "tape.hpp"
+
+namespace bstd::json::parser {
+
+class lazy_document;
+
+/// \brief A view of one value in a lazy_document.
+/// Nothing is decoded until it is asked for: members and elements are found by
+/// walking the tape and skipping whole subtrees through their matching-bracket
+/// links, and values are only converted to json by get_json() or get().
+/// A lazy_value is only valid while its lazy_document is alive.
+class lazy_value final {
+
+  public:
+
+    /// \brief Get the type of the value.
+    /// \return the type of the value
+    json::value_type get_type() const noexcept;
+
+    /// \brief Find a member of an object.
+    /// Keys are compared after decoding their escapes, and of duplicate keys
+    /// the last one is found, as when the document is parsed into a
+    /// basic_json.
+    /// \param _key the member name, decoded
+    /// \return the member's value, or std::nullopt if there is no such member
+    /// \throws std::domain_error if the value is not an object
+    std::optional<lazy_value> find(const std::string_view _key) const;
+
+    /// \brief Access a member of an object.
+    /// Keys are compared as by find(), so the last of duplicate keys is found.
+    /// \param _key the member name, decoded
+    /// \return the member's value
+    /// \throws std::domain_error if the value is not an object
+    /// \throws std::out_of_range if there is no such member
+    lazy_value at(const std::string_view _key) const;
+
+    /// \brief Access an element of an array.
+    /// \param _index the element index
+    /// \return the element
+    /// \throws std::domain_error if the value is not an array
+    /// \throws std::out_of_range if _index is out of range
+    lazy_value at(const std::size_t _index) const;
+
+    /// \copydoc at(const std::string_view) const
+    lazy_value operator[](const std::string_view _key) const {
+      return at(_key);
+    }
+
+    /// \copydoc at(const std::size_t) const
+    lazy_value operator[](const std::size_t _index) const {
+      return at(_index);
+    }
+
+    /// \brief Count the members of an object or the elements of an array.
+    /// This walks the children but does not decode them.
+    /// \return the number of children
+    /// \throws std::domain_error if the value is not an object or an array
+    std::size_t size() const;
+
+    /// \brief Get the text of the value in the JSON string.
+    /// \return a view of the value, including quotes for strings and brackets
+    ///         for containers
+    std::string_view get_text() const noexcept;
+
+    /// \brief Decode the value, and everything in it, into a json value.
+    /// \return the decoded value
+    json get_json() const;
+
+    /// \brief Decode a value.
+    /// \tparam T one of json's object_type, array_type, string_type,
+    ///           number_type, boolean_type, or null_type
+    /// \return the decoded value
+    /// \throws std::bad_variant_access if the value is not a T
+    template<class T>
+    T get() const { return get_json().template get<T>(); }
+
+  private:
+
+    friend class lazy_document;
+
+    lazy_value(const tape& _tape, const std::size_t _index)
+      : m_tape(&_tape), m_index(_index) {}
+
+    /// \brief Get the index following a value, after any whitespace.
+    std::size_t skip_value(std::size_t _index) const noexcept;
+
+    /// \brief Get the first index at or after _index that is not whitespace.
+    std::size_t skip_whitespace(std::size_t _index) const noexcept;
+
+    /// \brief Throw unless this value is a container of type _type.
+    void require(const token::type _type, const char* const _what) const;
+
+    const tape* m_tape;
+
+    std::size_t m_index;
+
+};
+
+
+/// \brief A validated JSON string that is decoded on demand.
+/// Constructing a lazy_document lexes the JSON string into a tape and checks it
+/// against the JSON grammar, but builds no json values. Reading a few members
+/// of a large document therefore costs time proportional to the path walked,
+/// not to the size of the document.
+/// The JSON string is borrowed; an owner can be given to keep it alive.
+class lazy_document final {
+
+  public:
+
+    /// \brief Construct a lazy_document.
+    /// \param _json_string the JSON string; must outlive this object
+    /// \param _debug debug flag
+    /// \param _throw if true, this class will throw errors when applicable
+    lazy_document(const std::string_view _json_string,
+        const bool _debug = false, const bool _throw = true);
+
+    /// \brief Construct a lazy_document that keeps its JSON string alive.
+    /// \param _json_string the JSON string
+    /// \param _owner the owner of the storage _json_string refers to
+    /// \param _debug debug flag
+    /// \param _throw if true, this class will throw errors when applicable
+    lazy_document(const std::string_view _json_string,
+        std::shared_ptr<const void> _owner, const bool _debug = false,
+        const bool _throw = true);
+
+    lazy_document(const lazy_document&) = delete;
+    lazy_document& operator=(const lazy_document&) = delete;
+
+    /// \brief Check if the JSON string is valid.
+    /// \return true if the JSON string was lexed and validated
+    bool is_valid() const noexcept;
+
+    /// \brief Get the root value.
+    /// \return the root value
+    /// \throws std::domain_error if the JSON string is invalid
+    lazy_value get_root() const;
+
+    /// \brief Get the tape of tokens.
+    /// \return the tape
+    const tape& get_tape() const noexcept;
+
+  private:
+
+    /// \brief Check the tape against the JSON grammar.
+    void validate(const bool _throw);
+
+    std::shared_ptr<const void> m_owner;
+
+    lexer m_lexer;
+
+    bool m_valid{false};
+
+};
+
+
+/// \brief Parse a .json file or a JSON string without decoding it.
+/// \param _string the .json file or JSON string; a JSON string is borrowed and
+///                must outlive the result
+/// \param _debug debug flag
+/// \param _throw if true, errors will be thrown
+/// \return a shared_ptr to a lazy_document
+std::shared_ptr<lazy_document> parse_lazy(const std::string_view _string,
+    const bool _debug = false, const bool _throw = true);
+
+}
+
+#endif
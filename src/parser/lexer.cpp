@@ -4,27 +4,27 @@
 namespace bstd::json::parser {
 
 
-const std::unordered_map<char, token::type> lexer::m_char_value_tokens = {
-  { '{', token::begin_object },
-  { '}', token::end_object },
-  { '[', token::begin_array},
-  { ']', token::end_array },
-  { ',', token::comma },
-  { ':', token::colon },
-};
-
-
 const std::vector<token>&
 lexer::
-get_tokens() const noexcept {
+get_tokens() const {
+  if(m_tokens.size() != m_tape.size())
+    m_tokens.assign(m_tape.begin(), m_tape.end());
+
   return m_tokens;
 }
 
 
+const tape&
+lexer::
+get_tape() const noexcept {
+  return m_tape;
+}
+
+
 const lexer::CVIT
 lexer::
 next_token() {
-  if(m_index == m_tokens.cend())
+  if(m_index == m_tape.end())
     throw bstd::error::error("lexer::next_token()",
         "Attempt to process a token after all have been retrieved.");
 
@@ -32,72 +32,85 @@ next_token() {
 }
 
 
-const auto
-lexer::
-apply_regex_filter(const token::type& _type, const std::regex& _regex) {
-  std::smatch results;
-  if(!std::regex_search(get_element(), get_container()->cend(), results, _regex))
-    return token(token::invalid);
-
-  if(results.empty())
-    return token(token::invalid);
-
-  if(results.position() != 0)
-    return token(token::invalid);
-
-  const auto& match = results.cbegin();
-
-  advance_index(match->length());
-
-  if(token::is_value_required(_type)) {
-    std::string value = *match;
-    // Consume quotes.
-    if(_type == token::string)
-      value = value.substr(1, match->length() - 2);
-
-    return token(_type, value);
-  }
-
-  return token(_type);
-}
-
-
 void
 lexer::
 lex() {
-  while(get_element() != get_container()->cend()) {
-    token t;
+  const auto& container = get_container();
+  const auto data = container.data();
+  const auto last = data + container.size();
+
+  // Strings are skipped by jumping straight to their closing quote, which the
+  // structural index records as the next position after the opening quote.
+  const auto indexed = container.size() <= structural_index::max_size;
+  const structural_index index(indexed ? container : "");
+  const auto& positions = index.get_positions();
+  auto next_position = positions.cbegin();
+
+  const auto find_string_end = [&](const char* _first) -> const char* {
+    const auto position = static_cast<std::size_t>(_first - data);
+    while(next_position != positions.cend() and *next_position <= position)
+      ++next_position;
+
+    if(next_position == positions.cend())
+      return nullptr;
+
+    return data + *next_position++ + 1;
+  };
+
+  // Input that is all ASCII, as the index tells, is valid UTF-8.
+  const auto check_utf8 = !indexed or index.has_non_ascii();
+
+  m_tape.clear();
+  m_tokens.clear();
+
+  const char* error = nullptr;
+  const char* error_position = nullptr;
+  while(get_element() != container.cend()) {
+    const auto first = std::to_address(get_element());
+    const auto type = start_token(*first);
+    const auto end = type == token::string and indexed ?
+      find_string_end(first) : scan_token(type, first, last);
+
+    if(end == nullptr) {
+      m_tape.push(token::invalid, first - data);
+      error = "Character does not match the start of any valid JSON value";
+      error_position = first;
+      break;
+    }
 
-    const auto cmit = m_char_value_tokens.find(*get_element());
-    if(cmit != m_char_value_tokens.cend()) {
-      t = token(cmit->second);
-      next_element();
+    // Bytes that are not ASCII can only be valid inside of strings.
+    if(type == token::string and check_utf8) {
+      if(const auto invalid = validate_utf8(first + 1, end - 1);
+          invalid != end - 1) {
+        m_tape.push(token::invalid, first - data);
+        error = "Invalid UTF-8";
+        error_position = invalid;
+        break;
+      }
     }
-    else if(*get_element() == '\"')
-      t = apply_regex_filter(token::string, STRING_REGEX);
-    else if(std::isdigit(*get_element()) or *get_element()== '+'
-        or *get_element() == '-')
-      t = apply_regex_filter(token::number, NUMBER_REGEX);
-    else if(*get_element() == 't')
-      t = apply_regex_filter(token::true_literal, TRUE_LITERAL_REGEX);
-    else if(*get_element() == 'f')
-      t = apply_regex_filter(token::false_literal, FALSE_LITERAL_REGEX);
-    else if(*get_element() == 'n')
-      t = apply_regex_filter(token::null_literal, NULL_LITERAL_REGEX);
-    else if(isspace(*get_element()))
-      t = apply_regex_filter(token::whitespace, WHITESPACE_REGEX);
-
-    m_tokens.push_back(t);
-
-    if(!t.is_valid()) {
-      report_error(bstd::error::context_error(*get_container(), get_element(),
-            "Character does not match the start of any valid JSON value"));
-      break;
+
+    if(type == token::string) {
+      if(const auto invalid = find_invalid_escape(first + 1, end - 1);
+          invalid != end - 1) {
+        m_tape.push(token::invalid, first - data);
+        error = "Invalid escape";
+        error_position = invalid;
+        break;
+      }
     }
+
+    m_tape.push(type, first - data);
+    advance_index(end - first);
   }
 
-  m_tokens.push_back(token(token::end_json));
-  m_index = m_tokens.cbegin();
+  m_tape.finish(get_element() - container.cbegin());
+  m_index = m_tape.begin();
+
+  if(error) {
+    const std::string context(container);
+    report_error(bstd::error::context_error(context,
+          context.cbegin() + (error_position - data), error));
+  }
 
   if(m_debug) {
     std::cout << *this << std::endl;
@@ -108,7 +121,7 @@ lex() {
 void
 lexer::
 reset() noexcept {
-  m_index = m_tokens.cbegin();
+  m_index = m_tape.begin();
 }
 
 
@@ -117,11 +130,11 @@ lexer::
 to_string() const noexcept {
   std::string result = "[";
 
-  for(int i = 0; i < m_tokens.size(); ++i) {
+  for(auto it = m_tape.begin(); it != m_tape.end(); ++it) {
     result += ' ';
-    result += m_tokens.at(i).to_string();
+    result += (*it).to_string();
 
-    if(i != m_tokens.size() - 1)
+    if(it.index() != m_tape.size() - 1)
       result += ',';
   }
 
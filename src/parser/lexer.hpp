@@ -1,45 +1,62 @@
 #ifndef BSTD_JSON_LEXER_HPP_
 #define BSTD_JSON_LEXER_HPP_
 
+#include <memory>
 #include <stdexcept>
 #include <sstream>
-#include <unordered_map>
+#include <string_view>
 #include <vector>
 
 #include <bstd_error.hpp>
 
 #include "parser_base.hpp"
-#include "regex.hpp"
+#include "scanner.hpp"
+#include "structural_index.hpp"
+#include "tape.hpp"
 #include "token.hpp"
+#include "utf8.hpp"
 
 namespace bstd::json::parser {
 
 /// \brief Tokenize a JSON string.
-class lexer final : public parser_base<std::string> {
+/// The lexer borrows the JSON string and the tokens it produces refer to it,
+/// so the JSON string must outlive both the lexer and its tokens.
+/// Tokens are stored in a compact tape; get_tokens(), next_token() and
+/// to_string() are adapters over it. The contents of strings are validated as
+/// UTF-8 as they are lexed.
+class lexer final : public parser_base<std::string_view> {
 
   public:
 
-    using CVIT = typename std::vector<token>::const_iterator;
+    using CVIT = tape::const_iterator;
 
     /// \brief Construct a lexer object.
     /// \param _json_string a JSON string
     /// \param _debug debug flag
     /// \param _throw if true, this class will throw exceptions when applicable
-    lexer(const std::string& _json_string, const bool _debug = false,
-        const bool _throw = true) : parser_base(_json_string, _debug, _throw) {}
+    lexer(const std::string_view _json_string, const bool _debug = false,
+        const bool _throw = true) : parser_base(_json_string, _debug, _throw),
+        m_tape(_json_string) {}
 
     ~lexer() {}
 
     /// \brief Get tokens.
+    /// The tokens are expanded from m_tape on the first call.
     /// \return m_tokens
-    const std::vector<token>& get_tokens() const noexcept;
+    const std::vector<token>& get_tokens() const;
 
-    /// \brief Process the next token from m_tokens.
+    /// \brief Get the tape of tokens.
+    /// \return m_tape
+    const tape& get_tape() const noexcept;
+
+    /// \brief Process the next token from m_tape.
     /// \return the next token to be processed, determined by m_index
     const CVIT next_token();
 
     /// \brief Tokenize a JSON string.
-    /// This populates m_tokens with tokens that represent the JSON provided.
+    /// This populates m_tape with tokens that represent the JSON provided.
+    /// A structural_index is built first so that strings can be skipped
+    /// without visiting each of their characters.
     /// \throws bstd::error::context_error if m_throw is true and errors in the
     ///         JSON string are found
     void lex();
@@ -51,18 +68,11 @@ class lexer final : public parser_base<std::string> {
 
   private:
 
-    /// \brief Apply regex to a character.
-    /// \param _type the token type to filter
-    /// \param _regex the regex to apply
-    /// \return true if a match was found starting at the current element
-    const auto apply_regex_filter(const token::type& _type,
-        const std::regex& _regex);
-
-    CVIT m_index; ///< The index of m_tokens used when iterating using get_next_token().
+    CVIT m_index; ///< The index of m_tape used when iterating using next_token().
 
-    std::vector<token> m_tokens;
+    tape m_tape;
 
-    static const std::unordered_map<char, token::type> m_char_value_tokens; ///< This map stores the single character token types.
+    mutable std::vector<token> m_tokens; ///< Cache for get_tokens().
 
 };
 
@@ -0,0 +1,233 @@
+#include "ndjson.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "dom_builder.hpp"
+#include "sax.hpp"
+#include "scanner.hpp"
+
+
+namespace bstd::json::parser {
+
+
+namespace {
+
+
+/// Batches in flight per worker; enough to keep every worker busy while the
+/// calling thread delivers results.
+constexpr std::size_t batches_per_worker = 4;
+
+
+/// \brief An invalid record.
+struct ndjson_error {
+  std::size_t offset;
+  const char* message;
+};
+
+
+/// \brief A run of whole lines parsed by one task.
+struct ndjson_batch {
+  std::string_view text;
+  std::size_t offset;
+  std::vector<std::pair<std::size_t, json>> records;
+  std::vector<ndjson_error> errors;
+  bool ready{false};
+};
+
+
+/// \brief Batches that have finished parsing, shared with the workers.
+struct completion_queue {
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  std::deque<std::size_t> m_done;
+  std::size_t m_running{0};
+};
+
+
+/// \brief Parse every line of a batch.
+/// \param _batch the batch
+/// \param _stop_on_error if true, stop at the first invalid record
+void
+parse_batch(ndjson_batch& _batch, const bool _stop_on_error) {
+  dom_builder<json> builder;
+
+  auto first = _batch.text.data();
+  const auto last = first + _batch.text.size();
+
+  while(first != last) {
+    auto end = static_cast<const char*>(std::memchr(first, '\n', last - first));
+    if(end == nullptr)
+      end = last;
+
+    if(scan_whitespace(first, end) != end) {
+      const std::string_view line(first, end - first);
+      const auto offset = _batch.offset + (first - _batch.text.data());
+      const auto result = parse_sax(line, builder, false);
+
+      if(result)
+        _batch.records.emplace_back(offset, builder.release());
+      else {
+        builder.clear();
+        _batch.errors.push_back({offset + result.offset, result.error});
+        if(_stop_on_error)
+          return;
+      }
+    }
+
+    first = end == last ? last : end + 1;
+  }
+}
+
+
+}
+
+
+std::size_t
+parse_ndjson(const std::string_view _records, const ndjson_callback& _callback,
+    const ndjson_options& _options, const bool _throw) {
+  auto& pool = _options.pool ? *_options.pool :
+    utilities::thread_pool::get_default();
+  const auto window = batches_per_worker * pool.size();
+  const auto batch_size = std::max<std::size_t>(_options.batch_size, 1);
+
+  completion_queue completed;
+  std::map<std::size_t, std::unique_ptr<ndjson_batch>> batches;
+  std::size_t submitted = 0;
+  std::size_t next_delivery = 0;
+  std::size_t split = 0;
+  std::size_t delivered = 0;
+
+  // The first batch with an invalid record, once one has been parsed.
+  constexpr auto no_batch = std::numeric_limits<std::size_t>::max();
+  auto failed = no_batch;
+
+  // The whole input, copied only once an invalid record is reported.
+  std::string context;
+
+  const auto submit = [&] {
+    auto end = std::min(split + batch_size, _records.size());
+    const auto newline = _records.find('\n', end);
+    end = newline == std::string_view::npos ? _records.size() : newline + 1;
+
+    auto batch = std::make_unique<ndjson_batch>();
+    batch->text = _records.substr(split, end - split);
+    batch->offset = split;
+    split = end;
+
+    auto& target = *batch;
+    const auto index = submitted++;
+    batches.emplace(index, std::move(batch));
+
+    {
+      std::lock_guard lock(completed.m_mutex);
+      ++completed.m_running;
+    }
+
+    pool.submit([&target, &completed, index, _throw] {
+      parse_batch(target, _throw);
+
+      // Notify while holding the lock: the calling thread may return, and
+      // destroy the queue, as soon as it sees the last batch finish.
+      std::lock_guard lock(completed.m_mutex);
+      completed.m_done.push_back(index);
+      --completed.m_running;
+      completed.m_condition.notify_one();
+    });
+  };
+
+  const auto deliver = [&](const std::size_t _index) {
+    auto batch = std::move(batches.at(_index));
+    batches.erase(_index);
+
+    // When throwing, a batch stops at its first error, so every record in it
+    // comes before the error.
+    for(auto& [offset, record] : batch->records) {
+      _callback(offset, std::move(record));
+      ++delivered;
+    }
+
+    for(const auto& error : batch->errors) {
+      if(context.empty())
+        context.assign(_records);
+
+      const bstd::error::context_error e(context,
+          context.cbegin() + error.offset, error.message);
+
+      if(_throw)
+        throw e;
+      std::cerr << e.what() << std::endl;
+    }
+  };
+
+  const auto complete = [&](const std::size_t _index) {
+    auto& batch = *batches.at(_index);
+    batch.ready = true;
+
+    if(_throw and !batch.errors.empty() and _index < failed) {
+      if(!_options.ordered and batches.count(failed))
+        batches.erase(failed);
+      failed = _index;
+    }
+
+    if(_options.ordered) {
+      while(batches.count(next_delivery) and batches.at(next_delivery)->ready)
+        deliver(next_delivery++);
+      return;
+    }
+
+    // Nothing after an invalid record is delivered, and it is only thrown
+    // once every batch before it has been.
+    if(_index > failed)
+      batches.erase(_index);
+    else if(_index < failed)
+      deliver(_index);
+
+    if(!batches.empty() and batches.begin()->first == failed)
+      deliver(failed);
+  };
+
+  try {
+    while((split < _records.size() and failed == no_batch)
+        or !batches.empty()) {
+      while(split < _records.size() and failed == no_batch
+          and batches.size() < window)
+        submit();
+
+      // Waiting runs queued batches on this thread, so a worker of the pool
+      // can call this too.
+      std::size_t index;
+      {
+        std::unique_lock lock(completed.m_mutex);
+        pool.wait(lock, completed.m_condition,
+            [&] { return !completed.m_done.empty(); });
+        index = completed.m_done.front();
+        completed.m_done.pop_front();
+      }
+
+      complete(index);
+    }
+  }
+  catch(...) {
+    // Batches still being parsed refer to this frame.
+    std::unique_lock lock(completed.m_mutex);
+    pool.wait(lock, completed.m_condition,
+        [&] { return completed.m_running == 0; });
+    throw;
+  }
+
+  return delivered;
+}
+
+
+}
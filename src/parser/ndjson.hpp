@@ -0,0 +1,61 @@
+#ifndef BSTD_JSON_NDJSON_HPP_
+#define BSTD_JSON_NDJSON_HPP_
+
+#include <cstddef>
+#include <functional>
+#include <string_view>
+
+#include <bstd_error.hpp>
+
+#include "basic_json.hpp"
+#include "utilities/thread_pool.hpp"
+
+namespace bstd::json::parser {
+
+/// \brief Options for parse_ndjson().
+struct ndjson_options {
+
+  /// If true, records are delivered in input order. Otherwise each batch is
+  /// delivered as soon as it has been parsed.
+  bool ordered{true};
+
+  /// The approximate number of bytes in a batch. Batches always end at a
+  /// newline.
+  std::size_t batch_size{1 << 20};
+
+  /// The pool to parse on, or nullptr to use thread_pool::get_default().
+  utilities::thread_pool* pool{nullptr};
+
+};
+
+/// \brief Receives the records parsed by parse_ndjson().
+/// The first argument is the byte offset of the record in the input.
+using ndjson_callback = std::function<void(std::size_t, json&&)>;
+
+/// \brief Parse newline-delimited JSON (NDJSON, JSON Lines) in parallel.
+/// The input is split at newlines into batches of about
+/// ndjson_options::batch_size bytes, and the batches are parsed on a thread
+/// pool. The callback is only ever called on the calling thread, so it needs
+/// no synchronization. Only a few batches per worker are in flight at once, so
+/// memory use does not grow with the size of the input. Blank lines are
+/// skipped. A .ndjson file can be parsed in place through a
+/// utilities::mapped_file. While it waits, the calling thread parses queued
+/// batches itself, so it may be called from a task on the same pool.
+/// \param _records the records, one JSON value per line
+/// \param _callback receives each record
+/// \param _options how to split, order, and schedule the work
+/// \param _throw if true, the first invalid record is thrown once the records
+///               before it have been delivered, and no record after it is
+///               delivered once it has been parsed (unordered, some may have
+///               been before); otherwise invalid records are reported to
+///               std::cerr and skipped
+/// \return the number of records delivered
+/// \throws bstd::error::context_error if _throw is true and a record is
+///         invalid
+std::size_t parse_ndjson(const std::string_view _records,
+    const ndjson_callback& _callback, const ndjson_options& _options = {},
+    const bool _throw = true);
+
+}
+
+#endif
@@ -0,0 +1,264 @@
+#include "number_parser.hpp"
+
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#include "number.hpp"
+
+
+namespace bstd::json::parser {
+
+
+namespace {
+
+
+/// Any run of this many digits fits in an std::uint64_t.
+constexpr std::ptrdiff_t max_digits = 19;
+
+/// Any run of this many digits is exactly representable as a double.
+constexpr std::ptrdiff_t max_exact_digits = 15;
+
+/// The largest power of ten that is exactly representable as a double.
+constexpr std::int64_t max_exact_exponent = 22;
+
+constexpr double exact_powers_of_ten[max_exact_exponent + 1] = {
+  1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13,
+  1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+/// Exponents beyond this overflow or underflow any double however many
+/// digits precede them, so larger ones need not be accumulated exactly.
+constexpr std::int64_t max_exponent = 100000;
+
+
+constexpr bool
+is_digit(const char _c) noexcept {
+  return static_cast<unsigned char>(_c - '0') < 10;
+}
+
+
+/// \brief Check if all eight bytes of a little-endian word are digits.
+/// A byte is a digit if its high nibble is 3, and adding 6 to it does not
+/// carry out of its low nibble.
+constexpr bool
+is_eight_digits(const std::uint64_t _chars) noexcept {
+  return ((_chars & 0xF0F0F0F0F0F0F0F0) |
+      (((_chars + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4)) ==
+    0x3333333333333333;
+}
+
+
+/// \brief Get the value of eight digits stored in a little-endian word.
+/// Adjacent digits are combined into pairs, then pairs into groups of four,
+/// then the two groups, with one multiplication each.
+constexpr std::uint32_t
+parse_eight_digits(std::uint64_t _chars) noexcept {
+  _chars = (_chars & 0x0F0F0F0F0F0F0F0F) * 2561 >> 8;
+  _chars = (_chars & 0x00FF00FF00FF00FF) * 6553601 >> 16;
+  return static_cast<std::uint32_t>(
+      (_chars & 0x0000FFFF0000FFFF) * 42949672960001 >> 32);
+}
+
+
+/// \brief Append a run of digits to a mantissa.
+/// The mantissa wraps if the digits do not fit; callers count the digits.
+/// \return one past the last digit
+const char*
+parse_digits(const char* _it, const char* const _last,
+    std::uint64_t& _mantissa) noexcept {
+  // Accumulate in a local: the digits are chars, which may alias _mantissa,
+  // so updating it in place would store it on every iteration.
+  auto mantissa = _mantissa;
+
+  if constexpr(std::endian::native == std::endian::little) {
+    while(_last - _it >= 8) {
+      std::uint64_t chars;
+      std::memcpy(&chars, _it, sizeof(chars));
+      if(!is_eight_digits(chars))
+        break;
+
+      mantissa = mantissa * 100000000 + parse_eight_digits(chars);
+      _it += 8;
+    }
+  }
+
+  for(; _it != _last and is_digit(*_it); ++_it)
+    mantissa = mantissa * 10 + static_cast<std::uint64_t>(*_it - '0');
+
+  _mantissa = mantissa;
+  return _it;
+}
+
+
+decoded_number
+make_integer(const std::int64_t _integer) noexcept {
+  return {static_cast<std::uint64_t>(_integer),
+    static_cast<std::uint8_t>(number::kind::integer)};
+}
+
+
+/// \brief Decode an unsigned integer, as a signed one if it fits.
+decoded_number
+make_unsigned(const std::uint64_t _integer) noexcept {
+  if(_integer > static_cast<std::uint64_t>(
+        std::numeric_limits<std::int64_t>::max()))
+    return {_integer,
+      static_cast<std::uint8_t>(number::kind::unsigned_integer)};
+
+  return make_integer(static_cast<std::int64_t>(_integer));
+}
+
+
+decoded_number
+make_double(const double _floating_point) noexcept {
+  return {std::bit_cast<std::uint64_t>(_floating_point),
+    static_cast<std::uint8_t>(number::kind::floating_point)};
+}
+
+
+/// \brief Get the decimal exponent of the leading significant digit of a
+///        number, plus one, or 0 if the number is zero.
+/// Only needed to tell overflow from underflow, so exponents are clamped.
+std::int64_t
+get_magnitude(const char* _it, const char* const _last) noexcept {
+  std::int64_t magnitude = 0;
+  auto significant = false;
+
+  for(; _it != _last and is_digit(*_it); ++_it)
+    if(significant or *_it != '0') {
+      significant = true;
+      ++magnitude;
+    }
+
+  if(_it != _last and *_it == '.')
+    for(++_it; _it != _last and is_digit(*_it); ++_it) {
+      if(significant)
+        continue;
+      if(*_it != '0')
+        significant = true;
+      else
+        --magnitude;
+    }
+
+  if(!significant)
+    return 0;
+
+  if(_it != _last and (*_it == 'e' or *_it == 'E')) {
+    ++_it;
+    const auto negative = _it != _last and *_it == '-';
+    if(_it != _last and (*_it == '-' or *_it == '+'))
+      ++_it;
+
+    std::int64_t exponent = 0;
+    for(; _it != _last and is_digit(*_it); ++_it)
+      if(exponent < max_exponent)
+        exponent = exponent * 10 + (*_it - '0');
+
+    magnitude += negative ? -exponent : exponent;
+  }
+
+  return magnitude;
+}
+
+
+/// \brief Parse a number as a double.
+/// \param _first the first character after any '+', which std::from_chars
+///               does not accept
+double
+parse_double(const char* const _first, const char* const _last) noexcept {
+  double value{};
+  const auto [end, error] = std::from_chars(_first, _last, value);
+  if(error != std::errc::result_out_of_range)
+    return value;
+
+  const auto negative = *_first == '-';
+  value = get_magnitude(_first + negative, _last) > 0 ?
+    std::numeric_limits<double>::infinity() : 0.0;
+  return negative ? -value : value;
+}
+
+
+}
+
+
+decoded_number
+decode_number(const std::string_view _text) noexcept {
+  auto it = _text.data();
+  const auto last = it + _text.size();
+
+  if(*it == '+')
+    ++it;
+  const auto first = it;
+
+  const auto negative = *it == '-';
+  if(negative)
+    ++it;
+
+  // Leading zeros are not significant.
+  while(it != last and *it == '0')
+    ++it;
+
+  std::uint64_t mantissa = 0;
+  const auto significant = it;
+  it = parse_digits(it, last, mantissa);
+  const auto digits = it - significant;
+
+  // Anything after the digits is a fraction or an exponent.
+  if(it == last) {
+    if(digits <= max_digits) {
+      if(!negative)
+        return make_unsigned(mantissa);
+
+      // No integer holds the sign of -0.
+      if(mantissa == 0)
+        return make_double(-0.0);
+
+      // The magnitude of std::int64_t's minimum is one past its maximum.
+      if(mantissa <= std::uint64_t{1} << 63)
+        return make_integer(static_cast<std::int64_t>(0 - mantissa));
+    }
+    else if(digits == max_digits + 1 and !negative) {
+      // Up to 18446744073709551615.
+      std::uint64_t value{};
+      const auto [end, error] = std::from_chars(significant, it, value);
+      if(error == std::errc())
+        return make_unsigned(value);
+    }
+  }
+  else if(*it == '.' and digits + (last - it - 1) <= max_exact_digits) {
+    // Clinger's fast path: the mantissa and the power of ten are both exact
+    // doubles, so their product or quotient is correctly rounded. This covers
+    // the short fractions most documents hold without parsing them a second
+    // time. Longer numbers are not scanned twice either.
+    const auto fraction = ++it;
+    it = parse_digits(it, last, mantissa);
+    std::int64_t exponent = fraction - it;
+
+    if(it != last) {
+      const auto exponent_negative = *++it == '-';
+      if(*it == '-' or *it == '+')
+        ++it;
+
+      std::int64_t written = 0;
+      for(; it != last; ++it)
+        if(written < max_exponent)
+          written = written * 10 + (*it - '0');
+      exponent += exponent_negative ? -written : written;
+    }
+
+    if(exponent >= -max_exact_exponent and exponent <= max_exact_exponent) {
+      auto value = static_cast<double>(mantissa);
+      value = exponent < 0 ? value / exact_powers_of_ten[-exponent] :
+        value * exact_powers_of_ten[exponent];
+      return make_double(negative ? -value : value);
+    }
+  }
+
+  return make_double(parse_double(first, last));
+}
+
+
+}
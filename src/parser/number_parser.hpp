@@ -0,0 +1,34 @@
+#ifndef BSTD_JSON_NUMBER_PARSER_HPP_
+#define BSTD_JSON_NUMBER_PARSER_HPP_
+
+#include <cstdint>
+#include <string_view>
+
+namespace bstd::json::parser {
+
+/// \brief A decoded number.
+struct decoded_number {
+
+  /// The bits of an std::int64_t, std::uint64_t or double.
+  std::uint64_t m_bits;
+
+  /// The number::kind that m_bits holds.
+  std::uint8_t m_kind;
+
+};
+
+/// \brief Decode the text of a number.
+/// Integers are read eight digits at a time and kept exact when they fit in
+/// an std::int64_t or std::uint64_t; -0 is the double -0.0. Other numbers
+/// become the closest double: short ones with one exact multiplication or
+/// division by a power of ten, and the rest through std::from_chars, which
+/// libstdc++ implements with the Eisel-Lemire algorithm from GCC 12 on.
+/// Values too large for a double become infinite, and values too small
+/// become zero.
+/// \param _text the text of a number as accepted by scan_number()
+/// \return the number
+decoded_number decode_number(const std::string_view _text) noexcept;
+
+}
+
+#endif
@@ -0,0 +1,244 @@
+#include "parallel_parser.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "dom_builder.hpp"
+#include "grammar.hpp"
+#include "parser.hpp"
+#include "sax.hpp"
+#include "scanner.hpp"
+#include "structural_index.hpp"
+
+
+namespace bstd::json::parser {
+
+
+namespace {
+
+
+/// Chunks per worker; more than one so uneven chunks can be balanced by
+/// stealing.
+constexpr std::size_t chunks_per_worker = 4;
+
+
+/// \brief The members or elements of the top-level container between two
+///        splitting commas.
+struct parallel_chunk {
+  std::string_view text;
+  std::size_t offset;
+  json value;
+  sax_result result;
+};
+
+
+/// \brief Parse a chunk as the contents of a container.
+/// \param _chunk the chunk
+/// \param _object true if the top-level container is an object
+void
+parse_chunk(parallel_chunk& _chunk, const bool _object) {
+  dom_builder<json> builder;
+  grammar<dom_builder<json>> json_grammar(builder);
+
+  const auto begin = _object ? token::begin_object : token::begin_array;
+  const auto end = _object ? token::end_object : token::end_array;
+  json_grammar.push(begin, {});
+
+  // The commas around a chunk are not part of it, and there are always at
+  // least two chunks, so an empty chunk means there is a missing member or
+  // element, or a trailing comma.
+  const auto first = _chunk.text.data();
+  const auto last = first + _chunk.text.size();
+  if(scan_whitespace(first, last) == last) {
+    _chunk.result.error = "Unexpected token";
+    _chunk.result.offset = _chunk.text.size();
+    return;
+  }
+
+  _chunk.result = push_tokens(_chunk.text, json_grammar);
+
+  if(_chunk.result and (!json_grammar.push(end, {}) or
+        !json_grammar.push(token::end_json, {})))
+    _chunk.result.error = "Unexpected end of JSON";
+
+  if(_chunk.result)
+    _chunk.value = builder.release();
+}
+
+
+/// \brief Split the top-level container at commas between its members.
+/// \param _json the JSON string
+/// \param _target the preferred number of bytes per chunk
+/// \param _chunks receives the chunks
+/// \param _object set to true if the top-level value is an object
+/// \return false if the JSON string is not a single, balanced object or array
+bool
+split(const std::string_view _json, const std::size_t _target,
+    std::vector<parallel_chunk>& _chunks, bool& _object) {
+  if(_json.size() > structural_index::max_size)
+    return false;
+
+  const structural_index index(_json);
+  const auto& positions = index.get_positions();
+  if(index.is_unterminated() or positions.empty())
+    return false;
+
+  const auto data = _json.data();
+  const auto last = data + _json.size();
+
+  // The top-level value must be the first token.
+  const std::size_t open = positions.front();
+  if(scan_whitespace(data, data + open) != data + open)
+    return false;
+  if(data[open] != '{' and data[open] != '[')
+    return false;
+  _object = data[open] == '{';
+
+  std::size_t depth = 0;
+  std::size_t chunk_start = open + 1;
+  std::size_t close = 0;
+  for(const std::size_t position : positions) {
+    switch(data[position]) {
+      case '{':
+      case '[':
+        ++depth;
+        break;
+      case '}':
+      case ']':
+        --depth;
+        break;
+      case ',':
+        if(depth == 1 and position - chunk_start >= _target) {
+          _chunks.push_back({_json.substr(chunk_start, position - chunk_start),
+              chunk_start, json(), sax_result()});
+          chunk_start = position + 1;
+        }
+        break;
+      default:
+        break;
+    }
+
+    if(depth == 0) {
+      close = position;
+      break;
+    }
+  }
+
+  if(depth != 0 or data[close] != (_object ? '}' : ']') or
+      scan_whitespace(data + close + 1, last) != last)
+    return false;
+
+  _chunks.push_back({_json.substr(chunk_start, close - chunk_start),
+      chunk_start, json(), sax_result()});
+  return true;
+}
+
+
+/// \brief Move the partial containers into one.
+/// \param _chunks the parsed chunks, in order
+/// \param _object true if the chunks hold objects
+/// \return the container
+json
+stitch(std::vector<parallel_chunk>& _chunks, const bool _object) {
+  if(_object) {
+    // std::map::merge keeps existing keys, so merge from the back to let the
+    // last duplicate win, as parse() does.
+    auto result = std::move(_chunks.back().value);
+    auto& members = result.get<json::object_type>();
+    for(auto chunk = _chunks.rbegin() + 1; chunk != _chunks.rend(); ++chunk)
+      members.merge(chunk->value.get<json::object_type>());
+
+    return result;
+  }
+
+  std::size_t size = 0;
+  for(const auto& chunk : _chunks)
+    size += chunk.value.size();
+
+  json::array_type elements;
+  elements.reserve(size);
+  for(auto& chunk : _chunks) {
+    auto& part = chunk.value.get<json::array_type>();
+    std::move(part.begin(), part.end(), std::back_inserter(elements));
+  }
+
+  return json(std::move(elements));
+}
+
+
+}
+
+
+std::shared_ptr<json>
+parse_parallel(const std::string_view _string,
+    const parallel_options& _options, const bool _debug, const bool _throw) {
+  auto json_as_string = _string;
+
+  // Try to open string as a path.
+  const auto file = utilities::map_json_file(_string);
+  if(file.is_open())
+    json_as_string = file.get_view();
+
+  auto& pool = _options.pool ? *_options.pool :
+    utilities::thread_pool::get_default();
+  const auto target = std::max(_options.min_chunk_size,
+      json_as_string.size() / (chunks_per_worker * pool.size()));
+
+  std::vector<parallel_chunk> chunks;
+  bool object = false;
+  if(json_as_string.size() < 2 * _options.min_chunk_size or
+      !split(json_as_string, target, chunks, object) or chunks.size() < 2)
+    return parse(json_as_string, _debug, _throw);
+
+  std::mutex mutex;
+  std::condition_variable condition;
+  auto remaining = chunks.size();
+
+  for(auto& chunk : chunks)
+    pool.submit([&, object] {
+      parse_chunk(chunk, object);
+
+      // Notify while holding the lock: the calling thread may return as soon
+      // as it sees the last chunk finish.
+      std::lock_guard lock(mutex);
+      --remaining;
+      condition.notify_one();
+    });
+
+  // Waiting runs queued chunks on this thread, so a worker of the pool can
+  // call this too.
+  {
+    std::unique_lock lock(mutex);
+    pool.wait(lock, condition, [&] { return remaining == 0; });
+  }
+
+  const auto failed = std::find_if(chunks.cbegin(), chunks.cend(),
+      [](const parallel_chunk& _chunk) { return !_chunk.result; });
+
+  if(failed != chunks.cend()) {
+    const std::string context(json_as_string);
+    const bstd::error::context_error e(context,
+        context.cbegin() + failed->offset + failed->result.offset,
+        failed->result.error);
+
+    if(_throw)
+      throw e;
+    std::cerr << e.what() << std::endl;
+    return std::make_shared<json>();
+  }
+
+  auto result = std::make_shared<json>(stitch(chunks, object));
+
+  if(_debug)
+    std::cout << *result << std::endl;
+
+  return result;
+}
+
+
+}
@@ -0,0 +1,50 @@
+#ifndef BSTD_JSON_PARALLEL_PARSER_HPP_
+#define BSTD_JSON_PARALLEL_PARSER_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+#include <bstd_error.hpp>
+
+#include "basic_json.hpp"
+#include "utilities/thread_pool.hpp"
+
+namespace bstd::json::parser {
+
+/// \brief Options for parse_parallel().
+struct parallel_options {
+
+  /// The smallest chunk worth a task of its own. Documents too small to be
+  /// split into at least two chunks are parsed sequentially.
+  std::size_t min_chunk_size{1 << 20};
+
+  /// The pool to parse on, or nullptr to use thread_pool::get_default().
+  utilities::thread_pool* pool{nullptr};
+
+};
+
+/// \brief Parse a .json file or a JSON string on several threads.
+/// A structural index of the JSON string is used to find the commas that
+/// separate the members or elements of the top-level object or array. The
+/// members are split at those commas into chunks of similar size, each chunk
+/// is parsed on a thread pool as the contents of its own container, and the
+/// partial containers are then moved into one json value. Inputs that cannot
+/// be split this way (scalars, small or malformed documents, or documents
+/// larger than structural_index::max_size) are given to parse(). While it
+/// waits, the calling thread parses queued chunks itself, so it may be called
+/// from a task on the same pool.
+/// \param _string the .json file or JSON string
+/// \param _options how to split and schedule the work
+/// \param _debug debug flag
+/// \param _throw if true, errors will be thrown
+/// \return a shared_ptr to a json object; a null value if the JSON is invalid
+/// \throws bstd::error::context_error if _throw is true and errors in the
+///         JSON string are found
+std::shared_ptr<json> parse_parallel(const std::string_view _string,
+    const parallel_options& _options = {}, const bool _debug = false,
+    const bool _throw = true);
+
+}
+
+#endif
@@ -1,41 +1,151 @@
 #include "parser.hpp"
 
+#include <algorithm>
+
 namespace bstd::json::parser {
 
 
 std::shared_ptr<json>
 parse(const char* _string, const bool _debug, const bool _throw) {
-  return parse(std::string(_string), _debug, _throw);
+  return parse(std::string_view(_string), _debug, _throw);
 }
 
 
 std::shared_ptr<json>
 parse(const std::string& _string, const bool _debug, const bool _throw) {
-  // Could be a .json file path or a JSON string.
+  return parse(std::string_view(_string), _debug, _throw);
+}
+
+
+std::shared_ptr<json>
+parse(const std::string_view _string, const bool _debug, const bool _throw) {
+  return parse(_string, number_mode::eager, _debug, _throw);
+}
+
+
+std::shared_ptr<json>
+parse(const std::string_view _string, const number_mode _numbers,
+    const bool _debug, const bool _throw) {
+  // Could be a .json file path or a JSON string. JSON strings are borrowed
+  // and files are mapped into memory, so neither is copied.
   auto json_as_string = _string;
 
   // Try to open string as a path.
-  auto ifs = utilities::open_json_file(_string, std::fstream::in);
-
-  if(ifs.is_open()) {
-    json_as_string = std::string((std::istreambuf_iterator<char>(ifs)),
-        std::istreambuf_iterator<char>());
-  }
+  const auto file = utilities::map_json_file(_string);
+  if(file.is_open())
+    json_as_string = file.get_view();
 
   // Now we are certain we have a JSON string.
 
   if(_debug)
     std::cout << json_as_string << std::endl;
 
-  lexer l(json_as_string, _debug, _throw);
-  l.lex();
-
-  parser p(l.get_tokens(), _debug, _throw);
+  parser p(json_as_string, _debug, _throw, _numbers);
+  p.parse();
 
   return p.get_json();
 }
 
 
+namespace {
+
+
+/// \brief Parse a JSON string into a pmr_json allocated from _resource.
+pmr_json
+build_pmr(const std::string_view _json, std::pmr::memory_resource* _resource,
+    const bool _debug, const bool _throw) {
+  if(_debug)
+    std::cout << _json << std::endl;
+
+  const std::pmr::polymorphic_allocator<pmr_json> allocator(_resource);
+  dom_builder<pmr_json> builder(allocator);
+  const auto result = parse_sax(_json, builder, false);
+
+  if(!result) {
+    const std::string context(_json);
+    const bstd::error::context_error e(context,
+        context.cbegin() + result.offset, result.error);
+
+    if(_throw)
+      throw e;
+    std::cerr << e.what() << std::endl;
+    return pmr_json();
+  }
+
+  return builder.release();
+}
+
+
+}
+
+
+std::shared_ptr<pmr_json>
+parse_pmr(const std::string_view _string, std::pmr::memory_resource* _resource,
+    const bool _debug, const bool _throw) {
+  if(_resource == nullptr)
+    _resource = std::pmr::get_default_resource();
+
+  auto json_as_string = _string;
+
+  // Try to open string as a path.
+  const auto file = utilities::map_json_file(_string);
+  if(file.is_open())
+    json_as_string = file.get_view();
+
+  return std::allocate_shared<pmr_json>(
+      std::pmr::polymorphic_allocator<pmr_json>(_resource),
+      build_pmr(json_as_string, _resource, _debug, _throw));
+}
+
+
+std::shared_ptr<arena_document>
+parse_arena(const std::string_view _string, const bool _debug,
+    const bool _throw) {
+  auto json_as_string = _string;
+
+  // Try to open string as a path.
+  const auto file = utilities::map_json_file(_string);
+  if(file.is_open())
+    json_as_string = file.get_view();
+
+  // A parsed document is typically a small multiple of its text. The first
+  // block is only as large as the text, and at most 1 MiB, so a large file
+  // does not reserve twice its size up front; the arena grows geometrically
+  // from there.
+  constexpr std::size_t max_first_block = 1 << 20;
+  auto document = std::make_shared<arena_document>(
+      std::min(json_as_string.size(), max_first_block));
+  document->get_root() = build_pmr(json_as_string, document->get_resource(),
+      _debug, _throw);
+
+  return document;
+}
+
+
+void
+parser::
+parse() {
+  const auto& container = get_container();
+
+  dom_builder<json> builder({}, m_numbers);
+  const auto result = parse_sax(container, builder, false);
+
+  if(!result) {
+    *m_json = json();
+    const std::string context(container);
+    report_error(bstd::error::context_error(context,
+          context.cbegin() + result.offset, result.error));
+    return;
+  }
+
+  *m_json = builder.release();
+
+  if(m_debug) {
+    std::cout << *this << std::endl;
+  }
+}
+
+
 std::shared_ptr<json>
 parser::
 get_json() const noexcept {
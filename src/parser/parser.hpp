@@ -4,13 +4,17 @@
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <memory_resource>
 #include <string_view>
 #include <sstream>
 
 #include <bstd_error.hpp>
 
 #include "basic_json.hpp"
-#include "lexer.hpp"
+#include "pmr_json.hpp"
+#include "dom_builder.hpp"
+#include "parser_base.hpp"
+#include "sax.hpp"
 #include "utilities/json_file_util.hpp"
 
 namespace bstd::json::parser {
@@ -27,19 +31,75 @@ std::shared_ptr<json> parse(const char* _string,
 /// \copydoc parse()
 std::shared_ptr<json> parse(const std::string& _string,
     const bool _debug = false, const bool _throw = true);
+/// \copydoc parse()
+/// A JSON string is borrowed rather than copied while it is parsed.
+std::shared_ptr<json> parse(const std::string_view _string,
+    const bool _debug = false, const bool _throw = true);
+
+/// \brief Parse a .json file or a JSON string, choosing when numbers are
+///        decoded.
+/// With number_mode::lazy, short numbers keep their text, and are decoded
+/// when they are read; see number.
+/// \param _string the .json file or JSON string
+/// \param _numbers when to decode numbers
+/// \copydetails parser_base::parser_base()
+/// \return a shared_ptr to a json object
+std::shared_ptr<json> parse(const std::string_view _string,
+    const number_mode _numbers, const bool _debug = false,
+    const bool _throw = true);
+
+/// \brief Parse a .json file or a JSON string into a pmr_json.
+/// Every string, array and object in the result, and the result itself, is
+/// allocated from _resource. With a std::pmr::monotonic_buffer_resource the
+/// whole document is released at once when the resource is. This is not an
+/// overload of parse(), where a literal 0 or nullptr resource would be
+/// ambiguous with the debug flag.
+/// \param _string the .json file or JSON string
+/// \param _resource the memory resource; nullptr uses
+///                  std::pmr::get_default_resource()
+/// \param _debug debug flag
+/// \param _throw if true, errors will be thrown
+/// \return a shared_ptr to a pmr_json; a null value if the JSON is invalid
+/// \throws bstd::error::context_error if _throw is true and errors in the
+///         JSON string are found
+std::shared_ptr<pmr_json> parse_pmr(const std::string_view _string,
+    std::pmr::memory_resource* _resource, const bool _debug = false,
+    const bool _throw = true);
+
+/// \brief Parse a .json file or a JSON string into an arena_document.
+/// The arena's first block is sized from the input, so small and medium
+/// documents are built without any further allocation from the heap.
+/// \copydetails parse_pmr()
+/// \return a shared_ptr to an arena_document
+std::shared_ptr<arena_document> parse_arena(const std::string_view _string,
+    const bool _debug = false, const bool _throw = true);
 
 /// \brief Parse JSON according to its grammar (https://www.json.org/).
-class parser final : public parser_base<std::vector<token>> {
+/// The parser scans the JSON string and builds the json value in a single
+/// pass: it runs parse_sax() with a dom_builder as the handler, so no token
+/// vector is built and nesting depth does not consume call stack.
+/// The parser borrows the JSON string, which must outlive it.
+class parser final : public parser_base<std::string_view> {
 
   public:
 
     /// \brief Construct a parser object.
-    /// \param _tokens tokenized JSON
+    /// \param _json_string a JSON string
     /// \param _debug debug flag
     /// \param _throw if true, this class will throw errors when applicable
-    parser(const std::vector<token>& _tokens, const bool _debug = false,
-        const bool _throw = true) : parser_base(_tokens, _debug, _throw),
-        m_json(std::make_shared<json>()) {}
+    /// \param _numbers when to decode numbers
+    parser(const std::string_view _json_string, const bool _debug = false,
+        const bool _throw = true,
+        const number_mode _numbers = number_mode::eager)
+      : parser_base(_json_string, _debug, _throw),
+        m_json(std::make_shared<json>()), m_numbers(_numbers) {}
+
+    /// \brief Parse the JSON string.
+    /// This populates m_json. If the JSON string is invalid, m_json is left
+    /// as a null value.
+    /// \throws bstd::error::context_error if m_throw is true and errors in the
+    ///         JSON string are found
+    void parse();
 
     /// \brief Get the parsed json object.
     /// \return the parsed json object
@@ -51,6 +111,8 @@ class parser final : public parser_base<std::vector<token>> {
 
     std::shared_ptr<json> m_json;
 
+    number_mode m_numbers;
+
 };
 
 }
@@ -2,7 +2,9 @@
 #define BSTD_JSON_PARSER_BASE_HPP_
 
 #include <iostream>
+#include <iterator>
 #include <string>
+#include <utility>
 
 #include <bstd_error.hpp>
 
@@ -10,24 +12,26 @@ namespace bstd::json::parser {
 
 /// \brief Parser base class to manage some of the common functionality between
 /// parser-like classes.
-/// \tparam Container stores the objects we are parsing
+/// The container is borrowed, not copied: Container should be a cheap view
+/// type (e.g. std::string_view or std::span) over storage owned by the caller,
+/// and that storage must outlive the parser.
+/// \tparam Container a view of the objects we are parsing
 template<class Container>
 class parser_base {
 
   protected:
 
-    using CCIT = typename Container::const_iterator;
+    using CCIT = decltype(std::cbegin(std::declval<const Container&>()));
 
     /// \brief Construct with a container to parse.
-    /// \param _container the collection of elements to parse
+    /// \param _container a view of the collection of elements to parse
     /// \param _debug debug mode flag
     /// \param _throw if true errors will be thrown, otherwise they will be
     ///               written to standard error
     parser_base(const Container& _container, const bool _debug = false,
         const bool _throw = true)
-        : m_debug(_debug), m_throw(_throw),
-          m_container(std::make_shared<Container>(_container)),
-          m_index(m_container->cbegin()) {}
+        : m_debug(_debug), m_throw(_throw), m_container(_container),
+          m_index(std::cbegin(m_container)) {}
 
     /// \brief Deleted copy constructor.
     parser_base(const parser_base&) = delete;
@@ -38,11 +42,11 @@ class parser_base {
 
     /// \brief Get the container.
     /// \returns m_container
-    const auto get_container() const noexcept;
+    const Container& get_container() const noexcept;
 
-    /// \brief Set the container.
+    /// \brief Set the container and reset the index.
     /// \param _container the container to set
-    void set_container(const Container& _container) const noexcept;
+    void set_container(const Container& _container) noexcept;
 
     // TODO: think about changing the name from element since these functions
     // return iterators.
@@ -95,7 +99,7 @@ class parser_base {
     /// problem is detected.
     bool m_error_reported{false};
 
-    std::shared_ptr<Container> m_container;
+    Container m_container;
 
     /// This allows the parser to keep track of its place as it analyzes the
     /// elements in m_container.
@@ -110,7 +114,7 @@ parser_base<Container>::
 
 
 template<class Container>
-const auto
+const Container&
 parser_base<Container>::
 get_container() const noexcept {
   return m_container;
@@ -120,8 +124,9 @@ get_container() const noexcept {
 template<class Container>
 void
 parser_base<Container>::
-set_container(const Container& _container) const noexcept {
-  m_container = std::make_unique<>(_container);
+set_container(const Container& _container) noexcept {
+  m_container = _container;
+  reset();
 }
 
 
@@ -137,7 +142,7 @@ template<class Container>
 const auto
 parser_base<Container>::
 next_element() {
-  if(m_index == m_container->cend())
+  if(m_index == std::cend(m_container))
     throw bstd::error::error("parser_base::next_elemnt()",
         "Attempt to process an element after all have been retrieved.");
 
@@ -149,8 +154,8 @@ template<class Container>
 const auto
 parser_base<Container>::
 peek_next_element() noexcept {
-  if(m_index == m_container->cend())
-    return m_container->cend();
+  if(m_index == std::cend(m_container))
+    return std::cend(m_container);
 
   return std::next(m_index);
 }
@@ -168,7 +173,7 @@ template<class Container>
 void
 parser_base<Container>::
 reset() noexcept {
-  m_index = m_container->cbegin();
+  m_index = std::cbegin(m_container);
   m_error_reported = false;
 }
 
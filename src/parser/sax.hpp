@@ -0,0 +1,175 @@
+#ifndef BSTD_JSON_SAX_HPP_
+#define BSTD_JSON_SAX_HPP_
+
+#include <concepts>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+#include <bstd_error.hpp>
+
+#include "grammar.hpp"
+#include "scanner.hpp"
+#include "utf8.hpp"
+
+namespace bstd::json::parser {
+
+/// \brief Requirements for a parse_sax() event handler.
+/// String and key events receive views of the raw string contents in the
+/// JSON string (without quotes, escape sequences untouched); number events
+/// receive the text of the number. push_tokens() also calls
+/// `token_span(std::string_view)`, if the handler has it, with the whole text
+/// of every token but whitespace just before the token's event, so a handler
+/// can tell where in the JSON string its values are.
+template<class Handler>
+concept sax_handler = requires(Handler& _handler, std::string_view _text) {
+  _handler.begin_object();
+  _handler.end_object();
+  _handler.begin_array();
+  _handler.end_array();
+  _handler.key(_text);
+  _handler.string(_text);
+  _handler.number(_text);
+  _handler.boolean(true);
+  _handler.null();
+};
+
+/// \brief A sax_handler that ignores all events.
+/// Useful for validating JSON without building anything.
+struct null_handler {
+  void begin_object() noexcept {}
+  void end_object() noexcept {}
+  void begin_array() noexcept {}
+  void end_array() noexcept {}
+  void key(std::string_view) noexcept {}
+  void string(std::string_view) noexcept {}
+  void number(std::string_view) noexcept {}
+  void boolean(bool) noexcept {}
+  void null() noexcept {}
+};
+
+/// \brief The outcome of parse_sax().
+struct sax_result {
+
+  /// A description of the error, or nullptr if the JSON string is valid.
+  const char* error{nullptr};
+
+  /// The byte offset of the error in the JSON string.
+  std::size_t offset{0};
+
+  /// \brief Check for success.
+  /// \return true if the JSON string is valid
+  explicit operator bool() const noexcept { return error == nullptr; }
+
+};
+
+/// \brief Scan a JSON string and push its tokens into a grammar.
+/// This is the scanning loop of parse_sax(). It does not push `end_json`, so
+/// the text may be a fragment of a larger JSON value whose surrounding tokens
+/// are pushed by the caller.
+/// Strings are scanned by scan_string() rather than skipped with a
+/// structural_index as lexer::lex() does: building the index is a pass over
+/// the whole input that is slower on its own than this loop, and it does not
+/// tell which strings hold escapes, so each would be searched again.
+/// \tparam Handler a sax_handler
+/// \param _json the JSON text
+/// \param _grammar the grammar to push the tokens into
+/// \return the result; offset is where scanning stopped
+template<sax_handler Handler>
+sax_result
+push_tokens(const std::string_view _json, grammar<Handler>& _grammar) {
+  const auto data = _json.data();
+  const auto last = data + _json.size();
+
+  sax_result result;
+
+  auto first = data;
+  for(; first != last; ) {
+    const auto type = start_token(*first);
+    auto non_ascii = false;
+    auto escaped = false;
+    const auto end = type == token::string ?
+      scan_string(first, last, non_ascii, escaped) :
+      scan_token(type, first, last);
+
+    if(end == nullptr) {
+      result.error =
+        "Character does not match the start of any valid JSON value";
+      break;
+    }
+
+    // Consume quotes.
+    const auto text = type == token::string ?
+      std::string_view(first + 1, end - 1) : std::string_view(first, end);
+
+    // Bytes that are not ASCII can only be valid inside of strings, and are
+    // noticed while scanning them.
+    if(non_ascii) {
+      if(const auto error = validate_utf8(text.data(), end - 1);
+          error != end - 1) {
+        result.error = "Invalid UTF-8";
+        first = error;
+        break;
+      }
+    }
+
+    if(escaped) {
+      if(const auto error = find_invalid_escape(text.data(), end - 1);
+          error != end - 1) {
+        result.error = "Invalid escape";
+        first = error;
+        break;
+      }
+    }
+
+    if constexpr(requires { _grammar.get_handler().token_span(text); })
+      if(type != token::whitespace)
+        _grammar.get_handler().token_span(std::string_view(first, end));
+
+    if(!_grammar.push(type, text)) {
+      result.error = "Unexpected token";
+      break;
+    }
+
+    first = end;
+  }
+
+  result.offset = static_cast<std::size_t>(first - data);
+  return result;
+}
+
+/// \brief Parse a JSON string and report its contents as events.
+/// The handler is a template parameter, so its methods can be inlined into the
+/// scanning loop. Events are emitted as soon as each token is scanned, and no
+/// memory is allocated per event. Strings are validated as UTF-8 as they are
+/// scanned.
+/// \tparam Handler a sax_handler
+/// \param _json the JSON string; events refer to it, so it must outlive any
+///              views the handler keeps
+/// \param _handler the event handler
+/// \param _throw if true, errors are thrown instead of only being returned
+/// \return the result; events emitted before an error are not undone
+/// \throws bstd::error::context_error if _throw is true and the JSON string
+///         is invalid
+template<sax_handler Handler>
+sax_result
+parse_sax(const std::string_view _json, Handler& _handler,
+    const bool _throw = true) {
+  grammar<Handler> json_grammar(_handler);
+  auto result = push_tokens(_json, json_grammar);
+
+  if(!result.error and !json_grammar.push(token::end_json, {}))
+    result.error = "Unexpected end of JSON";
+
+  if(!result and _throw) {
+    const std::string context(_json);
+    throw bstd::error::context_error(context, context.cbegin() + result.offset,
+        result.error);
+  }
+
+  return result;
+}
+
+}
+
+#endif
@@ -0,0 +1,232 @@
+#ifndef BSTD_JSON_SCANNER_HPP_
+#define BSTD_JSON_SCANNER_HPP_
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <string_view>
+
+#include "string_parser.hpp"
+#include "token.hpp"
+
+namespace bstd::json::parser {
+
+/// \brief Character class flags used by the scanner state machines.
+enum char_class : std::uint8_t {
+  other_class      = 0,
+  digit_class      = 1 << 0, // 0-9
+  whitespace_class = 1 << 1, // ' ' \t \n \r
+  sign_class       = 1 << 2, // + -
+  exponent_class   = 1 << 3  // e E
+};
+
+/// \brief 256-entry table mapping every byte to its char_class flags.
+inline constexpr std::array<std::uint8_t, 256> char_classes = [] {
+  std::array<std::uint8_t, 256> table{};
+
+  for(char c = '0'; c <= '9'; ++c)
+    table[static_cast<unsigned char>(c)] = digit_class;
+
+  for(const char c : {' ', '\t', '\n', '\r'})
+    table[static_cast<unsigned char>(c)] = whitespace_class;
+
+  table['+'] = table['-'] = sign_class;
+  table['e'] = table['E'] = exponent_class;
+
+  return table;
+}();
+
+/// \brief 256-entry table mapping the first byte of a token to its type.
+/// Bytes that cannot start any token map to token::invalid.
+inline constexpr std::array<token::type, 256> start_tokens = [] {
+  std::array<token::type, 256> table{};
+  table.fill(token::invalid);
+
+  table['{'] = token::begin_object;
+  table['}'] = token::end_object;
+  table['['] = token::begin_array;
+  table[']'] = token::end_array;
+  table[','] = token::comma;
+  table[':'] = token::colon;
+  table['"'] = token::string;
+  table['t'] = token::true_literal;
+  table['f'] = token::false_literal;
+  table['n'] = token::null_literal;
+
+  for(char c = '0'; c <= '9'; ++c)
+    table[static_cast<unsigned char>(c)] = token::number;
+  table['+'] = table['-'] = token::number;
+
+  for(const char c : {' ', '\t', '\n', '\r'})
+    table[static_cast<unsigned char>(c)] = token::whitespace;
+
+  return table;
+}();
+
+/// \brief Check a byte against a set of char_class flags.
+/// \param _c the byte to check
+/// \param _class one or more char_class flags
+/// \return true if _c belongs to any of the classes in _class
+constexpr bool
+is_class(const char _c, const std::uint8_t _class) noexcept {
+  return char_classes[static_cast<unsigned char>(_c)] & _class;
+}
+
+/// \brief Get the type of the token starting with a byte.
+/// \param _c the first byte of a token
+/// \return the token type, or token::invalid if no token starts with _c
+constexpr token::type
+start_token(const char _c) noexcept {
+  return start_tokens[static_cast<unsigned char>(_c)];
+}
+
+/// \brief Scan a string token.
+/// Plain text is skipped in blocks by find_special_character(), and escaped
+/// characters are skipped so that `\"` does not end the string.
+/// \param _first points at the opening quote
+/// \param _last the end of the input
+/// \param _non_ascii set if the string may contain bytes that are not ASCII,
+///                   and so needs validate_utf8(); left as it is otherwise
+/// \param _escaped set if the string contains escapes, and so needs
+///                 find_invalid_escape(); left as it is otherwise
+/// \return one past the closing quote, or nullptr if the string is
+///         unterminated
+constexpr const char*
+scan_string(const char* _first, const char* const _last, bool& _non_ascii,
+    bool& _escaped) noexcept {
+  for(++_first; ; ++_first) {
+    _first = find_special_character(_first, _last, _non_ascii);
+    if(_first == _last)
+      return nullptr;
+
+    if(*_first == '"')
+      return _first + 1;
+
+    if(*_first == '\\') {
+      _escaped = true;
+      if(++_first == _last)
+        return nullptr;
+    }
+  }
+}
+
+/// \copydoc scan_string()
+constexpr const char*
+scan_string(const char* const _first, const char* const _last) noexcept {
+  auto non_ascii = false;
+  auto escaped = false;
+  return scan_string(_first, _last, non_ascii, escaped);
+}
+
+/// \brief Scan a number token.
+/// Accepts an optional sign, a mantissa with an optional fraction and an
+/// optional exponent. At least one mantissa digit is required.
+/// \param _first points at the first character of the number
+/// \param _last the end of the input
+/// \return one past the last character of the number, or nullptr if no
+///         number starts at _first
+constexpr const char*
+scan_number(const char* _first, const char* const _last) noexcept {
+  auto skip_digits = [_last](const char* _it) {
+    while(_it != _last and is_class(*_it, digit_class))
+      ++_it;
+    return _it;
+  };
+
+  auto it = _first;
+  if(is_class(*it, sign_class))
+    ++it;
+
+  const auto integer_end = skip_digits(it);
+  auto digits = integer_end - it;
+  it = integer_end;
+
+  if(it != _last and *it == '.') {
+    const auto fraction_end = skip_digits(it + 1);
+    digits += fraction_end - (it + 1);
+    it = fraction_end;
+  }
+
+  if(digits == 0)
+    return nullptr;
+
+  // The exponent is only consumed if it is followed by at least one digit.
+  if(it != _last and is_class(*it, exponent_class)) {
+    auto exponent = it + 1;
+    if(exponent != _last and is_class(*exponent, sign_class))
+      ++exponent;
+
+    if(exponent != _last and is_class(*exponent, digit_class))
+      it = skip_digits(exponent);
+  }
+
+  return it;
+}
+
+/// \brief Scan a literal token (`true`, `false` or `null`).
+/// \param _first points at the first character of the literal
+/// \param _last the end of the input
+/// \param _literal the expected literal
+/// \return one past the literal, or nullptr if the input does not match
+constexpr const char*
+scan_literal(const char* const _first, const char* const _last,
+    const std::string_view _literal) noexcept {
+  if(static_cast<std::size_t>(_last - _first) < _literal.size())
+    return nullptr;
+
+  if(std::string_view(_first, _literal.size()) != _literal)
+    return nullptr;
+
+  return _first + _literal.size();
+}
+
+/// \brief Scan a run of whitespace.
+/// \param _first points at the first whitespace character
+/// \param _last the end of the input
+/// \return one past the last whitespace character
+constexpr const char*
+scan_whitespace(const char* _first, const char* const _last) noexcept {
+  while(_first != _last and is_class(*_first, whitespace_class))
+    ++_first;
+
+  return _first;
+}
+
+/// \brief Scan a single token of a known type.
+/// \param _type the token type, as returned by start_token()
+/// \param _first points at the first character of the token
+/// \param _last the end of the input
+/// \return one past the end of the token, or nullptr if the input is not a
+///         valid token of type _type
+constexpr const char*
+scan_token(const token::type _type, const char* const _first,
+    const char* const _last) noexcept {
+  switch(_type) {
+    case token::begin_object:
+    case token::end_object:
+    case token::begin_array:
+    case token::end_array:
+    case token::comma:
+    case token::colon:
+      return _first + 1;
+    case token::whitespace:
+      return scan_whitespace(_first, _last);
+    case token::string:
+      return scan_string(_first, _last);
+    case token::number:
+      return scan_number(_first, _last);
+    case token::true_literal:
+      return scan_literal(_first, _last, "true");
+    case token::false_literal:
+      return scan_literal(_first, _last, "false");
+    case token::null_literal:
+      return scan_literal(_first, _last, "null");
+    default:
+      return nullptr;
+  }
+}
+
+}
+
+#endif
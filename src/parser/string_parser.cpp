@@ -0,0 +1,187 @@
+#include "string_parser.hpp"
+
+#include <array>
+#include <cstdint>
+
+
+namespace bstd::json::parser {
+
+
+namespace {
+
+
+/// \brief 256-entry table mapping the character after a backslash to the
+///        byte it stands for, or 0 if it is 'u' or not a valid escape.
+constexpr std::array<char, 256> unescapes = [] {
+  std::array<char, 256> table{};
+
+  table['"'] = '"';
+  table['\\'] = '\\';
+  table['/'] = '/';
+  table['b'] = '\b';
+  table['f'] = '\f';
+  table['n'] = '\n';
+  table['r'] = '\r';
+  table['t'] = '\t';
+
+  return table;
+}();
+
+
+/// The code point written for lone surrogates.
+constexpr std::uint32_t replacement_character = 0xFFFD;
+
+
+/// \brief Read the four hex digits of a `\u` escape.
+/// \param _first the first digit; four bytes must be readable
+/// \return the code unit, or -1 if a digit is not hex
+constexpr std::int32_t
+parse_hex4(const char* const _first) noexcept {
+  std::int32_t value = 0;
+
+  for(auto it = _first; it != _first + 4; ++it) {
+    const auto c = *it;
+    std::int32_t digit;
+    if(c >= '0' and c <= '9')
+      digit = c - '0';
+    else if(c >= 'a' and c <= 'f')
+      digit = c - 'a' + 10;
+    else if(c >= 'A' and c <= 'F')
+      digit = c - 'A' + 10;
+    else
+      return -1;
+
+    value = value << 4 | digit;
+  }
+
+  return value;
+}
+
+
+/// \brief Write a code point as UTF-8.
+/// \return one past the last byte written
+char*
+write_utf8(const std::uint32_t _code_point, char* _out) noexcept {
+  if(_code_point < 0x80) {
+    *_out++ = static_cast<char>(_code_point);
+  }
+  else if(_code_point < 0x800) {
+    *_out++ = static_cast<char>(0xC0 | _code_point >> 6);
+    *_out++ = static_cast<char>(0x80 | (_code_point & 0x3F));
+  }
+  else if(_code_point < 0x10000) {
+    *_out++ = static_cast<char>(0xE0 | _code_point >> 12);
+    *_out++ = static_cast<char>(0x80 | (_code_point >> 6 & 0x3F));
+    *_out++ = static_cast<char>(0x80 | (_code_point & 0x3F));
+  }
+  else {
+    *_out++ = static_cast<char>(0xF0 | _code_point >> 18);
+    *_out++ = static_cast<char>(0x80 | (_code_point >> 12 & 0x3F));
+    *_out++ = static_cast<char>(0x80 | (_code_point >> 6 & 0x3F));
+    *_out++ = static_cast<char>(0x80 | (_code_point & 0x3F));
+  }
+
+  return _out;
+}
+
+
+/// \brief Decode a `\u` escape, and the low surrogate after it if it starts a
+///        surrogate pair.
+/// \param _it points after the 'u'; updated to one past the escape
+/// \return the code point, or -1 if the digits are not hex
+std::int32_t
+parse_unicode_escape(const char*& _it, const char* const _last) noexcept {
+  if(_last - _it < 4)
+    return -1;
+
+  const auto unit = parse_hex4(_it);
+  if(unit < 0)
+    return -1;
+  _it += 4;
+
+  if(unit < 0xD800 or unit > 0xDFFF)
+    return unit;
+  if(unit > 0xDBFF)
+    return replacement_character;
+
+  // A high surrogate must be followed by an escaped low surrogate.
+  if(_last - _it < 6 or _it[0] != '\\' or _it[1] != 'u')
+    return replacement_character;
+
+  const auto low = parse_hex4(_it + 2);
+  if(low < 0xDC00 or low > 0xDFFF)
+    return replacement_character;
+
+  _it += 6;
+  return 0x10000 + ((unit - 0xD800) << 10 | (low - 0xDC00));
+}
+
+
+}
+
+
+char*
+unescape(const std::string_view _text, char* _out) noexcept {
+  auto it = _text.data();
+  const auto last = it + _text.size();
+
+  while(true) {
+    // Copy the plain run up to the next escape.
+    const auto escape = static_cast<const char*>(
+        std::memchr(it, '\\', static_cast<std::size_t>(last - it)));
+    const auto run_end = escape == nullptr ? last : escape;
+
+    const auto length = static_cast<std::size_t>(run_end - it);
+    std::memcpy(_out, it, length);
+    _out += length;
+
+    if(escape == nullptr or escape + 1 == last)
+      return _out;
+
+    it = escape + 2;
+    const auto c = escape[1];
+    if(const auto unescaped = unescapes[static_cast<unsigned char>(c)];
+        unescaped != 0) {
+      *_out++ = unescaped;
+      continue;
+    }
+
+    if(c == 'u') {
+      if(const auto code_point = parse_unicode_escape(it, last);
+          code_point >= 0) {
+        _out = write_utf8(static_cast<std::uint32_t>(code_point), _out);
+        continue;
+      }
+    }
+
+    // Scanned strings have no unknown escapes; other callers, such as
+    // JSONPath's `\'`, get the character after the backslash.
+    *_out++ = c;
+  }
+}
+
+
+const char*
+find_invalid_escape(const char* _first, const char* const _last) noexcept {
+  while(true) {
+    const auto escape = static_cast<const char*>(
+        std::memchr(_first, '\\', static_cast<std::size_t>(_last - _first)));
+    if(escape == nullptr)
+      return _last;
+    if(escape + 1 == _last)
+      return escape;
+
+    const auto c = escape[1];
+    if(unescapes[static_cast<unsigned char>(c)] != 0) {
+      _first = escape + 2;
+      continue;
+    }
+
+    if(c != 'u' or _last - escape < 6 or parse_hex4(escape + 2) < 0)
+      return escape;
+    _first = escape + 6;
+  }
+}
+
+
+}
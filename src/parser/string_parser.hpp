@@ -0,0 +1,151 @@
+#ifndef BSTD_JSON_STRING_PARSER_HPP_
+#define BSTD_JSON_STRING_PARSER_HPP_
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace bstd::json::parser {
+
+/// \brief Check if a byte must be escaped in a JSON string.
+/// \return true for quotes, backslashes and control characters
+constexpr bool
+is_special_character(const char _c) noexcept {
+  return _c == '"' or _c == '\\' or static_cast<unsigned char>(_c) < 0x20;
+}
+
+/// \brief Find the first quote, backslash or control character.
+/// The input is compared 32 bytes at a time with AVX2, or 16 with SSE2, so
+/// long runs of plain text cost a few instructions per block.
+/// \param _first the first byte to check
+/// \param _last the end of the input
+/// \param _non_ascii set if a byte before the one found, or in the same
+///                   block, is not ASCII; left as it is otherwise
+/// \return the first special character, or _last if there is none
+constexpr const char*
+find_special_character(const char* _first, const char* const _last,
+    bool& _non_ascii) noexcept {
+#if defined(__AVX2__)
+  if(!std::is_constant_evaluated()) {
+    const auto quote = _mm256_set1_epi8('"');
+    const auto backslash = _mm256_set1_epi8('\\');
+    const auto control = _mm256_set1_epi8(0x1F);
+    auto high_bits = _mm256_setzero_si256();
+
+    for(; _last - _first >= 32; _first += 32) {
+      const auto chunk =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_first));
+      high_bits = _mm256_or_si256(high_bits, chunk);
+
+      // A byte is a control character if it is its maximum with 0x1F.
+      const auto special = _mm256_or_si256(
+          _mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote),
+            _mm256_cmpeq_epi8(chunk, backslash)),
+          _mm256_cmpeq_epi8(_mm256_max_epu8(chunk, control), control));
+
+      if(const auto mask = static_cast<std::uint32_t>(
+            _mm256_movemask_epi8(special)); mask != 0) {
+        _non_ascii |= _mm256_movemask_epi8(high_bits) != 0;
+        return _first + std::countr_zero(mask);
+      }
+    }
+
+    _non_ascii |= _mm256_movemask_epi8(high_bits) != 0;
+  }
+#elif defined(__SSE2__)
+  if(!std::is_constant_evaluated()) {
+    const auto quote = _mm_set1_epi8('"');
+    const auto backslash = _mm_set1_epi8('\\');
+    const auto control = _mm_set1_epi8(0x1F);
+    auto high_bits = _mm_setzero_si128();
+
+    for(; _last - _first >= 16; _first += 16) {
+      const auto chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(_first));
+      high_bits = _mm_or_si128(high_bits, chunk);
+
+      // A byte is a control character if it is its maximum with 0x1F.
+      const auto special = _mm_or_si128(
+          _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+            _mm_cmpeq_epi8(chunk, backslash)),
+          _mm_cmpeq_epi8(_mm_max_epu8(chunk, control), control));
+
+      if(const auto mask = static_cast<std::uint32_t>(
+            _mm_movemask_epi8(special)); mask != 0) {
+        _non_ascii |= _mm_movemask_epi8(high_bits) != 0;
+        return _first + std::countr_zero(mask);
+      }
+    }
+
+    _non_ascii |= _mm_movemask_epi8(high_bits) != 0;
+  }
+#endif
+
+  for(; _first != _last and !is_special_character(*_first); ++_first)
+    _non_ascii |= static_cast<unsigned char>(*_first) >= 0x80;
+
+  return _first;
+}
+
+/// \copydoc find_special_character()
+constexpr const char*
+find_special_character(const char* const _first,
+    const char* const _last) noexcept {
+  auto non_ascii = false;
+  return find_special_character(_first, _last, non_ascii);
+}
+
+/// \brief Find the first escape that is not valid JSON.
+/// A valid escape is a backslash followed by one of `"\/bfnrt`, or by `u` and
+/// four hex digits.
+/// \param _first the first byte of the contents of a string
+/// \param _last one past the last byte of the contents
+/// \return the backslash of the first invalid escape, or _last if there is
+///         none
+const char* find_invalid_escape(const char* _first, const char* const _last)
+  noexcept;
+
+/// \brief Decode the escapes of the contents of a string.
+/// Plain runs are copied in bulk between escapes. A `\uXXXX` escape is
+/// written as UTF-8, and a high surrogate followed by a low one as a single
+/// code point. Lone surrogates become U+FFFD. The scanners reject invalid
+/// escapes with find_invalid_escape(); any that reach unescape() are written
+/// as the characters after the backslash.
+/// \param _text the contents of a string, without quotes
+/// \param _out where to write; unescaping never lengthens a string, so
+///             _text.size() bytes are enough
+/// \return one past the last byte written
+char* unescape(const std::string_view _text, char* _out) noexcept;
+
+/// \brief Decode the escapes of the contents of a string, if it has any.
+/// Strings without a backslash are returned as they are, without copying.
+/// \param _text the contents of a string, without quotes
+/// \param _buffer where to decode a string with escapes; reused between calls
+/// \return _text, or a view of _buffer holding the decoded string
+inline std::string_view
+unescape(const std::string_view _text, std::string& _buffer) {
+  const auto escape = static_cast<const char*>(
+      std::memchr(_text.data(), '\\', _text.size()));
+  if(escape == nullptr)
+    return _text;
+
+  // Everything before the first escape is plain.
+  const auto plain = static_cast<std::size_t>(escape - _text.data());
+  _buffer.resize(_text.size());
+  std::memcpy(_buffer.data(), _text.data(), plain);
+
+  const auto end = unescape(_text.substr(plain), _buffer.data() + plain);
+  _buffer.resize(static_cast<std::size_t>(end - _buffer.data()));
+  return _buffer;
+}
+
+}
+
+#endif
@@ -0,0 +1,238 @@
+#include "structural_index.hpp"
+
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+
+namespace bstd::json::parser {
+
+
+namespace {
+
+
+constexpr std::size_t block_size = 64;
+
+/// Bitmaps for one 64-byte block; bit i corresponds to byte i.
+struct block_masks {
+  std::uint64_t structural;
+  std::uint64_t quote;
+  std::uint64_t backslash;
+  std::uint64_t non_ascii;
+};
+
+
+#if defined(__AVX2__)
+
+std::uint64_t
+match_mask(const __m256i _lo, const __m256i _hi, const char _c) {
+  const auto c = _mm256_set1_epi8(_c);
+  const std::uint64_t lo =
+    static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_lo, c)));
+  const std::uint64_t hi =
+    static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_hi, c)));
+  return lo | (hi << 32);
+}
+
+
+block_masks
+classify(const char* _block) {
+  const auto lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_block));
+  const auto hi =
+    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(_block + 32));
+
+  return {
+    match_mask(lo, hi, '{') | match_mask(lo, hi, '}') |
+    match_mask(lo, hi, '[') | match_mask(lo, hi, ']') |
+    match_mask(lo, hi, ',') | match_mask(lo, hi, ':'),
+    match_mask(lo, hi, '"'),
+    match_mask(lo, hi, '\\'),
+    static_cast<std::uint32_t>(_mm256_movemask_epi8(lo)) |
+      static_cast<std::uint64_t>(
+          static_cast<std::uint32_t>(_mm256_movemask_epi8(hi))) << 32
+  };
+}
+
+#elif defined(__SSE2__)
+
+std::uint64_t
+match_mask(const __m128i (&_chunks)[4], const char _c) {
+  const auto c = _mm_set1_epi8(_c);
+  std::uint64_t mask = 0;
+  for(int i = 0; i < 4; ++i)
+    mask |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(
+          _mm_movemask_epi8(_mm_cmpeq_epi8(_chunks[i], c)))) << (16 * i);
+  return mask;
+}
+
+
+std::uint64_t
+high_bit_mask(const __m128i (&_chunks)[4]) {
+  std::uint64_t mask = 0;
+  for(int i = 0; i < 4; ++i)
+    mask |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(
+          _mm_movemask_epi8(_chunks[i]))) << (16 * i);
+  return mask;
+}
+
+
+block_masks
+classify(const char* _block) {
+  const __m128i chunks[4] = {
+    _mm_loadu_si128(reinterpret_cast<const __m128i*>(_block)),
+    _mm_loadu_si128(reinterpret_cast<const __m128i*>(_block + 16)),
+    _mm_loadu_si128(reinterpret_cast<const __m128i*>(_block + 32)),
+    _mm_loadu_si128(reinterpret_cast<const __m128i*>(_block + 48))
+  };
+
+  return {
+    match_mask(chunks, '{') | match_mask(chunks, '}') |
+    match_mask(chunks, '[') | match_mask(chunks, ']') |
+    match_mask(chunks, ',') | match_mask(chunks, ':'),
+    match_mask(chunks, '"'),
+    match_mask(chunks, '\\'),
+    high_bit_mask(chunks)
+  };
+}
+
+#else
+
+block_masks
+classify(const char* _block) {
+  block_masks masks{0, 0, 0, 0};
+
+  for(std::size_t i = 0; i < block_size; ++i) {
+    const auto bit = std::uint64_t{1} << i;
+    if(static_cast<unsigned char>(_block[i]) >= 0x80)
+      masks.non_ascii |= bit;
+
+    switch(_block[i]) {
+      case '{': case '}': case '[': case ']': case ',': case ':':
+        masks.structural |= bit;
+        break;
+      case '"':
+        masks.quote |= bit;
+        break;
+      case '\\':
+        masks.backslash |= bit;
+        break;
+      default:
+        break;
+    }
+  }
+
+  return masks;
+}
+
+#endif
+
+
+/// \brief Compute the XOR of all preceding bits for every bit in a mask.
+/// Bits between an opening and a closing quote end up set.
+std::uint64_t
+prefix_xor(const std::uint64_t _mask) {
+#if defined(__PCLMUL__)
+  const auto product = _mm_clmulepi64_si128(
+      _mm_set_epi64x(0, static_cast<long long>(_mask)), _mm_set1_epi8(-1), 0);
+  return static_cast<std::uint64_t>(_mm_cvtsi128_si64(product));
+#else
+  auto mask = _mask;
+  mask ^= mask << 1;
+  mask ^= mask << 2;
+  mask ^= mask << 4;
+  mask ^= mask << 8;
+  mask ^= mask << 16;
+  mask ^= mask << 32;
+  return mask;
+#endif
+}
+
+
+/// \brief Find the characters escaped by an odd-length run of backslashes.
+/// \param _backslash the backslash bitmap of the current block
+/// \param _prev_escaped carry: 1 if the first byte of the block is escaped by
+///                      the previous block
+/// \return a bitmap of the escaped characters
+std::uint64_t
+find_escaped(std::uint64_t _backslash, std::uint64_t& _prev_escaped) {
+  constexpr std::uint64_t even_bits = 0x5555555555555555ULL;
+
+  _backslash &= ~_prev_escaped;
+  const auto follows_escape = _backslash << 1 | _prev_escaped;
+  const auto odd_sequence_starts = _backslash & ~even_bits & ~follows_escape;
+
+  std::uint64_t sequences_starting_on_even_bits;
+  _prev_escaped = __builtin_add_overflow(odd_sequence_starts, _backslash,
+      &sequences_starting_on_even_bits);
+
+  const auto invert_mask = sequences_starting_on_even_bits << 1;
+  return (even_bits ^ invert_mask) & follows_escape;
+}
+
+
+}
+
+
+structural_index::
+structural_index(const std::string_view _json) {
+  m_positions.reserve(_json.size() / 8);
+
+  std::uint64_t prev_escaped = 0;
+  std::uint64_t prev_in_string = 0;
+
+  for(std::size_t offset = 0; offset < _json.size(); offset += block_size) {
+    const char* block = _json.data() + offset;
+
+    // Pad the last partial block with spaces.
+    char padded[block_size];
+    if(_json.size() - offset < block_size) {
+      std::memset(padded, ' ', block_size);
+      std::memcpy(padded, block, _json.size() - offset);
+      block = padded;
+    }
+
+    const auto masks = classify(block);
+    m_non_ascii = m_non_ascii or masks.non_ascii != 0;
+
+    const auto escaped = find_escaped(masks.backslash, prev_escaped);
+    const auto quotes = masks.quote & ~escaped;
+    const auto in_string = prefix_xor(quotes) ^ prev_in_string;
+    prev_in_string = static_cast<std::uint64_t>(
+        static_cast<std::int64_t>(in_string) >> 63);
+
+    auto structurals = (masks.structural & ~in_string) | quotes;
+    while(structurals != 0) {
+      m_positions.push_back(static_cast<position_type>(
+            offset + __builtin_ctzll(structurals)));
+      structurals &= structurals - 1;
+    }
+  }
+
+  m_unterminated = prev_in_string != 0;
+}
+
+
+const std::vector<structural_index::position_type>&
+structural_index::
+get_positions() const noexcept {
+  return m_positions;
+}
+
+
+bool
+structural_index::
+is_unterminated() const noexcept {
+  return m_unterminated;
+}
+
+
+bool
+structural_index::
+has_non_ascii() const noexcept {
+  return m_non_ascii;
+}
+
+
+}
@@ -0,0 +1,60 @@
+#ifndef BSTD_JSON_STRUCTURAL_INDEX_HPP_
+#define BSTD_JSON_STRUCTURAL_INDEX_HPP_
+
+#include <cstdint>
+#include <limits>
+#include <string_view>
+#include <vector>
+
+namespace bstd::json::parser {
+
+/// \brief Index of the structural characters in a JSON string.
+/// The input is processed in 64-byte blocks. Each block is reduced to
+/// bitmaps of structural characters (`{}[],:`), quotes and backslashes using
+/// AVX2 or SSE2 when available, and portable code otherwise. Escaped quotes
+/// are removed and the regions inside strings are masked out with a prefix
+/// XOR (carry-less multiplication when available), so the index contains:
+///   - every structural character outside of strings, and
+///   - every unescaped quote, i.e. the first and last character of every
+///     string.
+/// Consumers can therefore jump from the opening quote of a string directly
+/// to its closing quote, or from one structural character to the next.
+class structural_index final {
+
+  public:
+
+    using position_type = std::uint32_t;
+
+    /// The largest input that can be indexed.
+    static constexpr std::size_t max_size =
+      std::numeric_limits<position_type>::max();
+
+    /// \brief Index a JSON string.
+    /// \param _json the JSON string; must not be larger than max_size
+    explicit structural_index(const std::string_view _json);
+
+    /// \brief Get the indexed positions.
+    /// \return the byte offsets of all structural characters, in order
+    const std::vector<position_type>& get_positions() const noexcept;
+
+    /// \brief Check if the input ends inside of a string.
+    /// \return true if the last string in the input is unterminated
+    bool is_unterminated() const noexcept;
+
+    /// \brief Check if the input has any bytes that are not ASCII.
+    /// \return true if the input may need UTF-8 validation
+    bool has_non_ascii() const noexcept;
+
+  private:
+
+    std::vector<position_type> m_positions;
+
+    bool m_unterminated{false};
+
+    bool m_non_ascii{false};
+
+};
+
+}
+
+#endif
@@ -0,0 +1,136 @@
+#include "tape.hpp"
+
+
+namespace bstd::json::parser {
+
+
+void
+tape::
+push(const token::type _type, const size_type _offset) {
+  if(is_begin(_type)) {
+    // The matching end is filled in when it is pushed.
+    m_open.push_back(m_entries.size());
+    m_entries.push_back(make_entry(_type, m_containers.size()));
+    m_containers.push_back({_offset, 0});
+    return;
+  }
+
+  if((_type == token::end_object or _type == token::end_array)
+      and !m_open.empty()) {
+    const auto begin = m_open.back();
+    const auto expected = _type == token::end_object ?
+      token::begin_object : token::begin_array;
+
+    if(get_type(begin) == expected) {
+      m_containers[get_payload(begin)].m_matching = m_entries.size();
+      m_open.pop_back();
+    }
+  }
+
+  m_entries.push_back(make_entry(_type, _offset));
+}
+
+
+void
+tape::
+finish(const size_type _offset) {
+  for(const auto begin : m_open)
+    m_containers[get_payload(begin)].m_matching = m_entries.size();
+  m_open.clear();
+
+  m_entries.push_back(make_entry(token::end_json, _offset));
+}
+
+
+void
+tape::
+clear() noexcept {
+  m_entries.clear();
+  m_containers.clear();
+  m_open.clear();
+}
+
+
+tape::size_type
+tape::
+size() const noexcept {
+  return m_entries.size();
+}
+
+
+std::string_view
+tape::
+get_json() const noexcept {
+  return m_json;
+}
+
+
+token::type
+tape::
+get_type(const size_type _index) const noexcept {
+  return static_cast<token::type>(m_entries[_index] >> payload_bits);
+}
+
+
+tape::size_type
+tape::
+get_offset(const size_type _index) const noexcept {
+  if(is_begin(get_type(_index)))
+    return m_containers[get_payload(_index)].m_offset;
+
+  return get_payload(_index);
+}
+
+
+tape::size_type
+tape::
+get_matching(const size_type _index) const noexcept {
+  return m_containers[get_payload(_index)].m_matching;
+}
+
+
+std::string_view
+tape::
+get_text(const size_type _index) const noexcept {
+  const auto offset = get_offset(_index);
+
+  if(_index + 1 == size())
+    return m_json.substr(offset, 0);
+
+  return m_json.substr(offset, get_offset(_index + 1) - offset);
+}
+
+
+token
+tape::
+get_token(const size_type _index) const {
+  const auto type = get_type(_index);
+
+  if(!token::is_value_required(type))
+    return token(type);
+
+  const auto text = get_text(_index);
+
+  // Consume quotes.
+  if(type == token::string)
+    return token(type, text.substr(1, text.size() - 2));
+
+  return token(type, text);
+}
+
+
+tape::const_iterator
+tape::
+begin() const noexcept {
+  return const_iterator(this, 0);
+}
+
+
+tape::const_iterator
+tape::
+end() const noexcept {
+  return const_iterator(this, size());
+}
+
+
+}
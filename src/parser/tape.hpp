@@ -0,0 +1,174 @@
+#ifndef BSTD_JSON_TAPE_HPP_
+#define BSTD_JSON_TAPE_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <string_view>
+#include <vector>
+
+#include "token.hpp"
+
+namespace bstd::json::parser {
+
+/// \brief Compact token storage produced by the lexer.
+/// Each token is a single 8-byte entry: the token type in the high 8 bits and
+/// a 56-bit payload. For every token but `begin_object` and `begin_array` the
+/// payload is the byte offset of the token in the JSON string. For those two
+/// it indexes a side array holding both their offset and the index of the
+/// matching `end_object`/`end_array` entry (or of the `end_json` entry if the
+/// container is never closed), so the offset of any entry is found and a
+/// whole subtree can be skipped in O(1).
+/// Tokens are contiguous in the JSON string, so a token's length is the
+/// distance to the next token's offset and does not need to be stored.
+/// Like token, a tape borrows the JSON string it was built from.
+class tape final {
+
+  public:
+
+    using entry_type = std::uint64_t;
+    using size_type = std::size_t;
+
+    /// \brief Iterate over the tape as token objects.
+    /// Tokens are produced on the fly, so dereferencing yields a token by
+    /// value.
+    class const_iterator final {
+
+      public:
+
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = token;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = token;
+
+        const_iterator() = default;
+
+        const_iterator(const tape* const _tape, const size_type _index)
+          : m_tape(_tape), m_index(_index) {}
+
+        /// \brief Get the tape index this iterator points to.
+        /// \return the index of the current entry
+        size_type index() const noexcept { return m_index; }
+
+        token operator*() const { return m_tape->get_token(m_index); }
+
+        const_iterator& operator++() { ++m_index; return *this; }
+        const_iterator& operator--() { --m_index; return *this; }
+
+        const_iterator operator++(int) {
+          auto copy = *this;
+          ++m_index;
+          return copy;
+        }
+
+        const_iterator operator--(int) {
+          auto copy = *this;
+          --m_index;
+          return copy;
+        }
+
+        bool operator==(const const_iterator& _rhs) const = default;
+
+      private:
+
+        const tape* m_tape{nullptr};
+
+        size_type m_index{0};
+
+    };
+
+    /// \brief Construct an empty tape for a JSON string.
+    /// \param _json the JSON string that will be tokenized into this tape
+    explicit tape(const std::string_view _json = {}) : m_json(_json) {}
+
+    /// \brief Append a token.
+    /// \param _type the token type
+    /// \param _offset the byte offset of the token in the JSON string
+    void push(const token::type _type, const size_type _offset);
+
+    /// \brief Append the `end_json` entry and point unmatched containers at it.
+    /// \param _offset the byte offset at which tokenizing stopped
+    void finish(const size_type _offset);
+
+    /// \brief Remove all entries.
+    void clear() noexcept;
+
+    /// \brief Get the number of entries.
+    /// \return the number of entries
+    size_type size() const noexcept;
+
+    /// \brief Get the JSON string this tape refers to.
+    /// \return the JSON string
+    std::string_view get_json() const noexcept;
+
+    /// \brief Get the type of an entry.
+    /// \param _index the entry index
+    /// \return the token type
+    token::type get_type(const size_type _index) const noexcept;
+
+    /// \brief Get the byte offset of an entry in the JSON string.
+    /// \param _index the entry index
+    /// \return the byte offset of the token
+    size_type get_offset(const size_type _index) const noexcept;
+
+    /// \brief Get the index of the entry closing a container.
+    /// \param _index the index of a `begin_object` or `begin_array` entry
+    /// \return the index of the matching end entry
+    size_type get_matching(const size_type _index) const noexcept;
+
+    /// \brief Get the source text of an entry.
+    /// \param _index the entry index
+    /// \return a view of the token in the JSON string, including quotes for
+    ///         strings
+    std::string_view get_text(const size_type _index) const noexcept;
+
+    /// \brief Get an entry as a token.
+    /// \param _index the entry index
+    /// \return the token, with the same value the lexer would give it
+    token get_token(const size_type _index) const;
+
+    const_iterator begin() const noexcept;
+    const_iterator end() const noexcept;
+
+  private:
+
+    static constexpr int payload_bits = 56;
+    static constexpr entry_type payload_mask =
+      (entry_type{1} << payload_bits) - 1;
+
+    static constexpr entry_type make_entry(const token::type _type,
+        const size_type _payload) noexcept {
+      return entry_type{_type} << payload_bits | (_payload & payload_mask);
+    }
+
+    static constexpr bool is_begin(const token::type _type) noexcept {
+      return _type == token::begin_object or _type == token::begin_array;
+    }
+
+    /// \brief Get the payload of an entry.
+    size_type get_payload(const size_type _index) const noexcept {
+      return m_entries[_index] & payload_mask;
+    }
+
+    /// Where a container begins and the entry it ends at.
+    struct container {
+      size_type m_offset;
+      size_type m_matching;
+    };
+
+    std::string_view m_json;
+
+    std::vector<entry_type> m_entries;
+
+    /// Every container, in the order they begin.
+    std::vector<container> m_containers;
+
+    /// Indices of containers that have not been closed yet.
+    std::vector<size_type> m_open;
+
+};
+
+}
+
+#endif
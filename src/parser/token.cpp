@@ -4,49 +4,6 @@
 namespace bstd::json::parser {
 
 
-const
-std::unordered_map<token::type, std::string> token::m_type_to_string = {
-    { token::invalid, "invalid" },
-    { token::begin_object, "begin_object" },
-    { token::end_object, "end_object" },
-    { token::begin_array, "begin_array" },
-    { token::end_array, "end_array" },
-    { token::comma, "comma" },
-    { token::colon, "colon" },
-    { token::whitespace, "whitespace" },
-    { token::string, "string" },
-    { token::number, "number" },
-    { token::true_literal, "true_literal" },
-    { token::false_literal, "false_literal" },
-    { token::null_literal, "null_literal" },
-    { token::end_json, "end_json" }
-};
-
-
-const
-std::unordered_map<token::type, std::string> token::m_type_to_default_value = {
-    { token::invalid, "invalid" },
-    { token::begin_object, "{" },
-    { token::end_object, "}" },
-    { token::begin_array, "[" },
-    { token::end_array, "]" },
-    { token::comma, "," },
-    { token::colon, ":" },
-    { token::whitespace, " " },
-    { token::string, "string" },
-    { token::number, "1" },
-    { token::true_literal, "true" },
-    { token::false_literal, "false" },
-    { token::null_literal, "null" },
-    { token::end_json, "end_json" }
-};
-
-
-token::
-token(const type _type)
-  : m_type(_type), m_value(m_type_to_default_value.at(m_type)) {}
-
-
 const token::type
 token::
 get_type() const {
@@ -57,7 +14,7 @@ get_type() const {
 const std::string
 token::
 get_type_as_string() const {
-  return m_type_to_string.at(m_type);
+  return std::string(m_type_to_string[m_type]);
 }
 
 
@@ -68,7 +25,7 @@ set_type(const type _type) {
 }
 
 
-const std::string
+std::string_view
 token::
 get_value() const {
   return m_value;
@@ -78,13 +35,22 @@ get_value() const {
 void
 token::
 set_value(const char _value) {
-  set_value(std::string(1, _value));
+  // Every possible character, so single character values can be viewed.
+  static constexpr auto characters = [] {
+    std::array<char, 256> characters{};
+    for(std::size_t i = 0; i < characters.size(); ++i)
+      characters[i] = static_cast<char>(i);
+    return characters;
+  }();
+
+  set_value(std::string_view(
+        &characters[static_cast<unsigned char>(_value)], 1));
 }
 
 
 void
 token::
-set_value(const std::string& _value) {
+set_value(const std::string_view _value) {
   m_value = _value;
 }
 
@@ -119,7 +85,9 @@ is_valid() const {
 const std::string
 token::
 to_string() const {
-  return std::string('(' + get_type_as_string() + ", " + get_value() + ')');
+  auto result = '(' + get_type_as_string() + ", ";
+  result += get_value();
+  return result += ')';
 }
 
 
@@ -1,14 +1,18 @@
 #ifndef BSTD_JSON_TOKEN_HPP_
 #define BSTD_JSON_TOKEN_HPP_
 
-#include <unordered_map>
+#include <array>
 #include <iostream>
 #include <string>
+#include <string_view>
 #include <utility>
 
 namespace bstd::json::parser {
 
 /// \brief Token object used by the parser.
+/// A token does not own its value. Values produced by the lexer refer to the
+/// JSON string being lexed, and default values refer to static storage, so
+/// the JSON string must outlive the tokens made from it.
 class token final {
 
   public:
@@ -38,18 +42,19 @@ class token final {
     /// \brief Constructor that covers default and only type construction.
     /// This can be used to construct tokens for the character valued tokens ({,
     /// }, [, ], etc.). The value will be populated from m_type_to_default_value.
-    token(const type _type = invalid);
+    token(const type _type = invalid)
+        : m_type(_type), m_value(m_type_to_default_value[_type]) {}
 
     /// \brief Construct a token from a string value.
     /// \param _type type
-    /// \param _value the sub string from the JSON string that this token
-    ///               represents
-    token(const type _type, const std::string& _value)
+    /// \param _value a view of the sub string from the JSON string that this
+    ///               token represents
+    token(const type _type, const std::string_view _value)
         : m_type(_type), m_value(_value) {}
 
     /// \brief Construct with a pair.
-    /// \param _pair a pair of token::type to std::string
-    token(const std::pair<type, std::string> _pair)
+    /// \param _pair a pair of token::type to std::string_view
+    token(const std::pair<type, std::string_view> _pair)
         : m_type(_pair.first), m_value(_pair.second) {}
 
     ~token() {}
@@ -68,14 +73,15 @@ class token final {
     void set_type(const type _type);
 
     /// \brief Get this token's value.
-    /// \return the value of this token
-    const std::string get_value() const;
+    /// \return a view of the value of this token
+    std::string_view get_value() const;
     /// \brief Set this token's value.
     /// \param _value a character to set as the value
     void set_value(const char _value);
     /// \brief Set this token's value.
-    /// \param _value a string to set as the value
-    void set_value(const std::string& _value);
+    /// \param _value a view of the string to set as the value; the viewed
+    ///               string must outlive this token
+    void set_value(const std::string_view _value);
 
     /// Operator overloads.
 
@@ -113,10 +119,22 @@ class token final {
 
     type m_type{invalid};
 
-    std::string m_value{"invalid"};
-
-    static const std::unordered_map<type, std::string> m_type_to_string;
-    static const std::unordered_map<type, std::string> m_type_to_default_value;
+    std::string_view m_value{"invalid"};
+
+    /// Indexed by type.
+    static constexpr std::array<std::string_view, end_json + 1>
+      m_type_to_string = {
+        "invalid", "begin_object", "end_object", "begin_array", "end_array",
+        "comma", "colon", "whitespace", "string", "number", "true_literal",
+        "false_literal", "null_literal", "end_json"
+      };
+
+    /// Indexed by type.
+    static constexpr std::array<std::string_view, end_json + 1>
+      m_type_to_default_value = {
+        "invalid", "{", "}", "[", "]", ",", ":", " ", "string", "1", "true",
+        "false", "null", "end_json"
+      };
 
 };
 
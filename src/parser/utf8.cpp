@@ -0,0 +1,416 @@
+#include "utf8.hpp"
+
+#include <array>
+#include <cstddef>
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+#include <immintrin.h>
+#endif
+
+
+namespace bstd::json::parser {
+
+
+namespace {
+
+
+constexpr bool
+is_continuation(const unsigned char _c) noexcept {
+  return (_c & 0xC0) == 0x80;
+}
+
+
+/// \brief Get the length of the sequence a lead byte starts.
+constexpr std::ptrdiff_t
+get_sequence_length(const unsigned char _c) noexcept {
+  return _c >= 0xF0 ? 4 : _c >= 0xE0 ? 3 : 2;
+}
+
+
+/// \brief Find the first invalid sequence by decoding one sequence at a time.
+/// \param _it the first byte of a sequence
+const char*
+decode_sequences(const char* _it, const char* const _last) noexcept {
+  while(_it != _last) {
+    if(_last - _it >= 8) {
+      std::uint64_t chars;
+      std::memcpy(&chars, _it, sizeof(chars));
+      if(!(chars & 0x8080808080808080)) {
+        _it += 8;
+        continue;
+      }
+    }
+
+    const auto c = static_cast<unsigned char>(*_it);
+    if(c < 0x80) {
+      ++_it;
+      continue;
+    }
+
+    // Continuation bytes, overlong two byte sequences, and lead bytes of
+    // code points above U+10FFFF.
+    if(c < 0xC2 or c > 0xF4)
+      return _it;
+
+    // The second byte excludes overlong encodings, surrogates and code
+    // points above U+10FFFF.
+    unsigned char min = 0x80;
+    unsigned char max = 0xBF;
+    if(c == 0xE0)
+      min = 0xA0;
+    else if(c == 0xED)
+      max = 0x9F;
+    else if(c == 0xF0)
+      min = 0x90;
+    else if(c == 0xF4)
+      max = 0x8F;
+
+    const auto length = get_sequence_length(c);
+    if(_last - _it < length)
+      return _it;
+
+    const auto second = static_cast<unsigned char>(_it[1]);
+    if(second < min or second > max)
+      return _it;
+
+    for(std::ptrdiff_t i = 2; i < length; ++i)
+      if(!is_continuation(static_cast<unsigned char>(_it[i])))
+        return _it;
+
+    _it += length;
+  }
+
+  return _last;
+}
+
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+
+
+#if defined(__AVX2__)
+
+using vector = __m256i;
+
+constexpr std::size_t vector_size = 32;
+
+vector
+load(const void* _data) {
+  return _mm256_loadu_si256(static_cast<const __m256i*>(_data));
+}
+
+/// \brief Load a 16-entry table into both lanes.
+vector
+load_table(const std::uint8_t* _table) {
+  return _mm256_broadcastsi128_si256(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(_table)));
+}
+
+vector
+splat(const std::uint8_t _c) {
+  return _mm256_set1_epi8(static_cast<char>(_c));
+}
+
+vector
+lookup(const vector _table, const vector _index) {
+  return _mm256_shuffle_epi8(_table, _index);
+}
+
+vector
+bit_and(const vector _a, const vector _b) { return _mm256_and_si256(_a, _b); }
+
+vector
+bit_or(const vector _a, const vector _b) { return _mm256_or_si256(_a, _b); }
+
+vector
+bit_xor(const vector _a, const vector _b) { return _mm256_xor_si256(_a, _b); }
+
+vector
+saturating_sub(const vector _a, const vector _b) {
+  return _mm256_subs_epu8(_a, _b);
+}
+
+vector
+shift_right_4(const vector _v) { return _mm256_srli_epi16(_v, 4); }
+
+/// \brief Get the input shifted right by _n bytes, with the last _n bytes of
+///        the previous input shifted in.
+template<int _n>
+vector
+shift_in(const vector _input, const vector _previous) {
+  return _mm256_alignr_epi8(_input,
+      _mm256_permute2x128_si256(_previous, _input, 0x21), 16 - _n);
+}
+
+bool
+is_ascii(const vector _v) { return _mm256_movemask_epi8(_v) == 0; }
+
+bool
+is_zero(const vector _v) { return _mm256_testz_si256(_v, _v); }
+
+#else
+
+using vector = __m128i;
+
+constexpr std::size_t vector_size = 16;
+
+vector
+load(const void* _data) {
+  return _mm_loadu_si128(static_cast<const __m128i*>(_data));
+}
+
+vector
+load_table(const std::uint8_t* _table) { return load(_table); }
+
+vector
+splat(const std::uint8_t _c) { return _mm_set1_epi8(static_cast<char>(_c)); }
+
+vector
+lookup(const vector _table, const vector _index) {
+  return _mm_shuffle_epi8(_table, _index);
+}
+
+vector
+bit_and(const vector _a, const vector _b) { return _mm_and_si128(_a, _b); }
+
+vector
+bit_or(const vector _a, const vector _b) { return _mm_or_si128(_a, _b); }
+
+vector
+bit_xor(const vector _a, const vector _b) { return _mm_xor_si128(_a, _b); }
+
+vector
+saturating_sub(const vector _a, const vector _b) {
+  return _mm_subs_epu8(_a, _b);
+}
+
+vector
+shift_right_4(const vector _v) { return _mm_srli_epi16(_v, 4); }
+
+/// \brief Get the input shifted right by _n bytes, with the last _n bytes of
+///        the previous input shifted in.
+template<int _n>
+vector
+shift_in(const vector _input, const vector _previous) {
+  return _mm_alignr_epi8(_input, _previous, 16 - _n);
+}
+
+bool
+is_ascii(const vector _v) { return _mm_movemask_epi8(_v) == 0; }
+
+bool
+is_zero(const vector _v) {
+  return _mm_movemask_epi8(_mm_cmpeq_epi8(_v, _mm_setzero_si128())) == 0xFFFF;
+}
+
+#endif
+
+
+/// Error flags for a pair of adjacent bytes. A pair is invalid if all three
+/// lookups, by the high and low nibble of the first byte and the high nibble
+/// of the second, share a flag.
+enum : std::uint8_t {
+  too_short      = 1 << 0, // 11______ 0_______ or 11______ 11______
+  too_long       = 1 << 1, // 0_______ 10______
+  overlong_3     = 1 << 2, // 11100000 100_____
+  too_large      = 1 << 3, // 11110100 1001____, 11110101+ 1001____ or 101_____
+  surrogate      = 1 << 4, // 11101101 101_____
+  overlong_2     = 1 << 5, // 1100000_ 10______
+  too_large_1000 = 1 << 6, // 11110101+ 1000____
+  overlong_4     = 1 << 6, // 11110000 1000____
+  two_continuations = 1 << 7, // 10______ 10______
+  carry = too_short | too_long | two_continuations
+};
+
+constexpr std::uint8_t byte_1_high[16] = {
+  // 0_______: ASCII
+  too_long, too_long, too_long, too_long,
+  too_long, too_long, too_long, too_long,
+  // 10______: continuation
+  two_continuations, two_continuations, two_continuations, two_continuations,
+  // 1100____, 1101____: two byte lead
+  too_short | overlong_2,
+  too_short,
+  // 1110____: three byte lead
+  too_short | overlong_3 | surrogate,
+  // 1111____: four byte lead
+  too_short | too_large | too_large_1000 | overlong_4
+};
+
+constexpr std::uint8_t byte_1_low[16] = {
+  // ____0000
+  carry | overlong_3 | overlong_2 | overlong_4,
+  // ____0001
+  carry | overlong_2,
+  // ____001_
+  carry,
+  carry,
+  // ____0100
+  carry | too_large,
+  // ____0101, ____011_, ____1___
+  carry | too_large | too_large_1000,
+  carry | too_large | too_large_1000,
+  carry | too_large | too_large_1000,
+  carry | too_large | too_large_1000,
+  carry | too_large | too_large_1000,
+  carry | too_large | too_large_1000,
+  carry | too_large | too_large_1000,
+  carry | too_large | too_large_1000,
+  // ____1101
+  carry | too_large | too_large_1000 | surrogate,
+  carry | too_large | too_large_1000,
+  carry | too_large | too_large_1000
+};
+
+constexpr std::uint8_t byte_2_high[16] = {
+  // 0_______: ASCII
+  too_short, too_short, too_short, too_short,
+  too_short, too_short, too_short, too_short,
+  // 1000____
+  too_long | overlong_2 | two_continuations | overlong_3 | too_large_1000 |
+    overlong_4,
+  // 1001____
+  too_long | overlong_2 | two_continuations | overlong_3 | too_large,
+  // 101_____
+  too_long | overlong_2 | two_continuations | surrogate | too_large,
+  too_long | overlong_2 | two_continuations | surrogate | too_large,
+  // 11______: lead
+  too_short, too_short, too_short, too_short
+};
+
+/// The largest byte each position may hold without starting a sequence that
+/// continues past the end of a vector.
+constexpr auto max_complete = [] {
+  std::array<std::uint8_t, vector_size> table{};
+  table.fill(0xFF);
+  table[vector_size - 3] = 0xF0 - 1;
+  table[vector_size - 2] = 0xE0 - 1;
+  table[vector_size - 1] = 0xC0 - 1;
+  return table;
+}();
+
+
+constexpr std::size_t block_size = 64;
+
+
+/// \brief Validates consecutive vectors, carrying sequences across them.
+class utf8_checker final {
+
+  public:
+
+    /// \brief Check the next block_size bytes.
+    void check(const char* const _block) {
+      for(std::size_t i = 0; i < block_size; i += vector_size)
+        check(load(_block + i));
+    }
+
+    /// \brief Check the end of the input: a sequence that was left
+    ///        incomplete is an error.
+    void finish() { m_error = bit_or(m_error, m_incomplete); }
+
+    /// \brief Check if an error was found, not counting a sequence that may
+    ///        continue in the next block.
+    bool has_error() const { return !is_zero(m_error); }
+
+  private:
+
+    void check(const vector _input) {
+      // A sequence left incomplete is an error if ASCII follows.
+      if(is_ascii(_input)) {
+        m_error = bit_or(m_error, m_incomplete);
+        m_incomplete = splat(0);
+        m_previous = _input;
+        return;
+      }
+
+      const auto low_nibble = splat(0x0F);
+      const auto previous_1 = shift_in<1>(_input, m_previous);
+      const auto special = bit_and(bit_and(
+            lookup(m_byte_1_high,
+              bit_and(shift_right_4(previous_1), low_nibble)),
+            lookup(m_byte_1_low, bit_and(previous_1, low_nibble))),
+          lookup(m_byte_2_high, bit_and(shift_right_4(_input), low_nibble)));
+
+      // The second and third bytes after a three or four byte lead must be
+      // continuations; the lookups only flag pairs.
+      const auto third = saturating_sub(shift_in<2>(_input, m_previous),
+          splat(0xE0 - 0x80));
+      const auto fourth = saturating_sub(shift_in<3>(_input, m_previous),
+          splat(0xF0 - 0x80));
+      const auto must_continue = bit_and(bit_or(third, fourth), splat(0x80));
+
+      m_error = bit_or(m_error, bit_xor(must_continue, special));
+      m_incomplete = saturating_sub(_input, m_max_complete);
+      m_previous = _input;
+    }
+
+    const vector m_byte_1_high{load_table(byte_1_high)};
+    const vector m_byte_1_low{load_table(byte_1_low)};
+    const vector m_byte_2_high{load_table(byte_2_high)};
+    const vector m_max_complete{load(max_complete.data())};
+
+    vector m_error{splat(0)};
+    vector m_incomplete{splat(0)};
+    vector m_previous{splat(0)};
+
+};
+
+
+/// \brief Skip the continuation bytes at the start of a block.
+const char*
+skip_continuations(const char* _it) noexcept {
+  for(auto i = 0; i < 3 and is_continuation(static_cast<unsigned char>(*_it));
+      ++i)
+    ++_it;
+
+  return _it;
+}
+
+
+#endif
+
+
+}
+
+
+const char*
+find_utf8_error(const char* const _first, const char* const _last) noexcept {
+  auto it = _first;
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+  if(_first == _last)
+    return _last;
+
+  utf8_checker checker;
+  auto block = _first;
+  for(; ; block += block_size) {
+    // Pad the last partial block with spaces.
+    auto data = block;
+    char padded[block_size];
+    if(_last - block < static_cast<std::ptrdiff_t>(block_size)) {
+      std::memset(padded, ' ', block_size);
+      std::memcpy(padded, block, static_cast<std::size_t>(_last - block));
+      data = padded;
+    }
+
+    checker.check(data);
+    if(checker.has_error() or
+        _last - block <= static_cast<std::ptrdiff_t>(block_size))
+      break;
+  }
+
+  checker.finish();
+  if(!checker.has_error())
+    return _last;
+
+  // An error involves the last block checked or the end of the one before
+  // it, and the input before that is valid, so decode from the block before.
+  if(block != _first)
+    it = block - block_size == _first ? _first :
+      skip_continuations(block - block_size);
+#endif
+
+  return decode_sequences(it, _last);
+}
+
+
+}
@@ -0,0 +1,60 @@
+#ifndef BSTD_JSON_UTF8_HPP_
+#define BSTD_JSON_UTF8_HPP_
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace bstd::json::parser {
+
+/// \brief Find the first byte that is not part of valid UTF-8.
+/// Called by validate_utf8() once a byte that is not ASCII is found.
+/// Blocks of 64 bytes are validated with the lookup table algorithm of
+/// Keiser and Lemire, with AVX2 or SSSE3 when available, and the exact
+/// position of an error is found by decoding the block it is in. Without
+/// either, sequences are decoded one at a time and ASCII is skipped eight
+/// bytes at a time.
+/// \param _first the first byte to check
+/// \param _last the end of the input
+/// \return the first byte of the first invalid sequence, or _last if the
+///         input is valid
+const char* find_utf8_error(const char* _first,
+    const char* const _last) noexcept;
+
+/// \brief Validate UTF-8.
+/// Overlong encodings, surrogates, code points above U+10FFFF and truncated
+/// sequences are all invalid. ASCII, which is most JSON, is checked inline
+/// 16 bytes at a time with SSE2, or eight bytes at a time without it.
+/// \param _first the first byte to check
+/// \param _last the end of the input
+/// \return the first byte of the first invalid sequence, or _last if the
+///         input is valid
+inline const char*
+validate_utf8(const char* _first, const char* const _last) noexcept {
+#if defined(__SSE2__)
+  for(; _last - _first >= 16; _first += 16)
+    if(_mm_movemask_epi8(
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(_first))) != 0)
+      return find_utf8_error(_first, _last);
+#endif
+
+  for(; _last - _first >= 8; _first += 8) {
+    std::uint64_t chars;
+    std::memcpy(&chars, _first, sizeof(chars));
+    if(chars & 0x8080808080808080)
+      return find_utf8_error(_first, _last);
+  }
+
+  for(; _first != _last; ++_first)
+    if(static_cast<unsigned char>(*_first) >= 0x80)
+      return find_utf8_error(_first, _last);
+
+  return _last;
+}
+
+}
+
+#endif
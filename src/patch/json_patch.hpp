@@ -0,0 +1,565 @@
+#ifndef BSTD_JSON_PATCH_HPP_
+#define BSTD_JSON_PATCH_HPP_
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "basic_json.hpp"
+#include "json_pointer.hpp"
+
+namespace bstd::json::patch {
+
+/// \brief Applies JSON Patch (RFC 6902) operations to a document in place.
+/// Each operation finds its target through a json_pointer and changes only
+/// the containers on the way to it, so its cost depends on the depth of the
+/// path and the size of the containers changed, not on the whole document.
+/// Values are moved into the document, and `move` takes the value out of its
+/// old place rather than copying it.
+/// \tparam Json a basic_json
+template<class Json>
+class patcher final {
+
+  public:
+
+    using json_type = Json;
+    using object_type = typename Json::object_type;
+    using array_type = typename Json::array_type;
+    using string_type = typename Json::string_type;
+    using value_type = typename Json::value_type;
+
+    /// \brief Construct a patcher for a document.
+    /// \param _document the document to change; must outlive the patcher
+    explicit patcher(Json& _document) noexcept : m_document(_document) {}
+
+    /// \brief Add a member, insert an element, or replace the document.
+    /// An existing member is replaced. `-` as the last token appends to an
+    /// array.
+    /// \param _path where to add
+    /// \param _value the value
+    /// \throws std::out_of_range if the parent does not exist, or an index is
+    ///         past the end of its array
+    void add(const json_pointer& _path, Json _value);
+
+    /// \brief Remove a member or element.
+    /// \param _path the value to remove; the whole document is left null
+    /// \return the value removed
+    /// \throws std::out_of_range if there is no such value
+    Json remove(const json_pointer& _path);
+
+    /// \brief Replace a value.
+    /// \param _path the value to replace
+    /// \param _value the new value
+    /// \throws std::out_of_range if there is no such value
+    void replace(const json_pointer& _path, Json _value);
+
+    /// \brief Move a value, by removing it and adding it at another path.
+    /// \param _from the value to move
+    /// \param _path where to add it
+    /// \throws std::invalid_argument if _path is inside _from
+    /// \throws std::out_of_range if either path does not exist
+    void move(const json_pointer& _from, const json_pointer& _path);
+
+    /// \brief Copy a value to another path.
+    /// \param _from the value to copy
+    /// \param _path where to add the copy
+    /// \throws std::out_of_range if either path does not exist
+    void copy(const json_pointer& _from, const json_pointer& _path);
+
+    /// \brief Check a value.
+    /// \param _path the value to check
+    /// \param _value the value it should equal
+    /// \return true if the value exists and equals _value
+    bool test(const json_pointer& _path, const Json& _value) const;
+
+    /// \brief Apply one operation, such as
+    ///        `{"op": "add", "path": "/a", "value": 1}`.
+    /// \param _operation the operation; its value is moved from
+    /// \throws std::invalid_argument if _operation is malformed
+    /// \throws std::domain_error if a `test` operation fails
+    /// \throws std::out_of_range if a path does not exist
+    void apply(Json&& _operation);
+
+  private:
+
+    /// \brief Get the member of an operation, or nullptr.
+    static Json* get_member(object_type& _operation, const char* const _name);
+
+    /// \brief Get the index of the last token of a path in an array.
+    static std::size_t get_index(const json_pointer& _path,
+        const array_type& _array, const bool _append);
+
+    Json& m_document;
+
+};
+
+/// \brief Apply a JSON Patch (RFC 6902) to a document in place.
+/// Operations are applied in order; if one fails, the ones before it stay
+/// applied, so patch a copy when an update must be all or nothing.
+/// \tparam Json a basic_json
+/// \param _document the document to change
+/// \param _patch an array of operations; pass an rvalue to move its values
+///               into the document instead of copying them
+/// \throws std::invalid_argument if the patch is malformed
+/// \throws std::domain_error if a `test` operation fails
+/// \throws std::out_of_range if a path does not exist
+template<class Json>
+void apply_patch(Json& _document, Json _patch);
+
+/// \brief Apply a JSON Merge Patch (RFC 7386) to a document in place.
+/// Members of an object patch replace or, if null, remove members of the
+/// document, recursively; any other patch replaces the document.
+/// \tparam Json a basic_json
+/// \param _document the document to change
+/// \param _patch the patch; pass an rvalue to move its values into the
+///               document instead of copying them
+template<class Json>
+void apply_merge_patch(Json& _document, Json _patch);
+
+/// \brief Find a JSON Patch that turns one document into another.
+/// Both documents are walked together. Members are compared by key, and
+/// arrays by trimming their common prefix and suffix and diffing the
+/// elements left pairwise, so an inserted or removed element is one
+/// operation. Containers whose hashes are memoized in both documents, and
+/// equal, are checked with a single == and skipped if it holds, rather than
+/// being walked for differences. Equal hashes alone are not trusted, since a
+/// memo goes stale when a value is changed through an earlier reference.
+/// \tparam Json a basic_json
+/// \param _source the document to change
+/// \param _target the document to change it into
+/// \return an array of `add`, `remove` and `replace` operations
+template<class Json>
+Json diff(const Json& _source, const Json& _target);
+
+
+template<class Json>
+void
+patcher<Json>::
+add(const json_pointer& _path, Json _value) {
+  if(_path.empty()) {
+    m_document = std::move(_value);
+    return;
+  }
+
+  const auto parent = _path.find_parent(m_document);
+  if(parent == nullptr)
+    throw std::out_of_range("json_patch: no value at " + _path.to_string());
+
+  const auto key = _path.key(_path.size() - 1);
+  switch (parent->get_type()) {
+    case value_type::object:
+      parent->template get<object_type>().insert_or_assign(string_type(key),
+          std::move(_value));
+      break;
+    case value_type::array: {
+      auto& array = parent->template get<array_type>();
+      const auto index = get_index(_path, array, true);
+      array.insert(array.begin() + static_cast<std::ptrdiff_t>(index),
+          std::move(_value));
+      break;
+    }
+    case value_type::string:
+    case value_type::number:
+    case value_type::boolean:
+    case value_type::null:
+    default:
+      throw std::out_of_range("json_patch: no container at " +
+          _path.to_string());
+  }
+}
+
+
+template<class Json>
+Json
+patcher<Json>::
+remove(const json_pointer& _path) {
+  if(_path.empty())
+    return std::exchange(m_document, Json());
+
+  const auto parent = _path.find_parent(m_document);
+  if(parent != nullptr and parent->get_type() == value_type::object) {
+    auto& object = parent->template get<object_type>();
+    const auto member =
+      object.find(string_type(_path.key(_path.size() - 1)));
+    if(member != object.end()) {
+      auto removed = std::move(member->second);
+      object.erase(member);
+      return removed;
+    }
+  }
+  else if(parent != nullptr and parent->get_type() == value_type::array) {
+    auto& array = parent->template get<array_type>();
+    const auto element =
+      array.begin() + static_cast<std::ptrdiff_t>(get_index(_path, array,
+            false));
+    auto removed = std::move(*element);
+    array.erase(element);
+    return removed;
+  }
+
+  throw std::out_of_range("json_patch: no value at " + _path.to_string());
+}
+
+
+template<class Json>
+void
+patcher<Json>::
+replace(const json_pointer& _path, Json _value) {
+  const auto target = _path.find(m_document);
+  if(target == nullptr)
+    throw std::out_of_range("json_patch: no value at " + _path.to_string());
+
+  *target = std::move(_value);
+}
+
+
+template<class Json>
+void
+patcher<Json>::
+move(const json_pointer& _from, const json_pointer& _path) {
+  if(_from.is_prefix_of(_path))
+    throw std::invalid_argument("json_patch: cannot move a value into "
+        "itself");
+
+  if(_from.to_string() == _path.to_string()) {
+    if(_from.find(m_document) == nullptr)
+      throw std::out_of_range("json_patch: no value at " + _from.to_string());
+    return;
+  }
+
+  add(_path, remove(_from));
+}
+
+
+template<class Json>
+void
+patcher<Json>::
+copy(const json_pointer& _from, const json_pointer& _path) {
+  const auto source = _from.find(m_document);
+  if(source == nullptr)
+    throw std::out_of_range("json_patch: no value at " + _from.to_string());
+
+  add(_path, Json(*source));
+}
+
+
+template<class Json>
+bool
+patcher<Json>::
+test(const json_pointer& _path, const Json& _value) const {
+  const auto target = _path.find(std::as_const(m_document));
+  return target != nullptr and *target == _value;
+}
+
+
+template<class Json>
+void
+patcher<Json>::
+apply(Json&& _operation) {
+  if(_operation.get_type() != value_type::object)
+    throw std::invalid_argument("json_patch: an operation must be an object");
+
+  auto& operation = _operation.template get<object_type>();
+
+  const auto get_pointer = [&operation](const char* const _name) {
+    const auto member = get_member(operation, _name);
+    if(member == nullptr or member->get_type() != value_type::string)
+      throw std::invalid_argument(std::string("json_patch: an operation "
+            "needs a \"") + _name + "\" string");
+    return json_pointer(member->get_string());
+  };
+
+  const auto get_value = [&operation]() -> Json& {
+    const auto member = get_member(operation, "value");
+    if(member == nullptr)
+      throw std::invalid_argument("json_patch: an operation needs a "
+          "\"value\"");
+    return *member;
+  };
+
+  const auto op = get_member(operation, "op");
+  if(op == nullptr or op->get_type() != value_type::string)
+    throw std::invalid_argument("json_patch: an operation needs an \"op\"");
+
+  const auto name = op->get_string();
+  const auto path = get_pointer("path");
+  if(name == "add")
+    add(path, std::move(get_value()));
+  else if(name == "remove")
+    remove(path);
+  else if(name == "replace")
+    replace(path, std::move(get_value()));
+  else if(name == "move")
+    move(get_pointer("from"), path);
+  else if(name == "copy")
+    copy(get_pointer("from"), path);
+  else if(name == "test") {
+    if(!test(path, get_value()))
+      throw std::domain_error("json_patch: test failed at " +
+          path.to_string());
+  }
+  else
+    throw std::invalid_argument("json_patch: unknown op \"" +
+        std::string(name) + "\"");
+}
+
+
+template<class Json>
+Json*
+patcher<Json>::
+get_member(object_type& _operation, const char* const _name) {
+  const auto member = _operation.find(string_type(_name));
+  return member == _operation.end() ? nullptr : &member->second;
+}
+
+
+template<class Json>
+std::size_t
+patcher<Json>::
+get_index(const json_pointer& _path, const array_type& _array,
+    const bool _append) {
+  const auto last = _path.size() - 1;
+  if(_append and _path.key(last) == "-")
+    return _array.size();
+
+  const auto index = _path.index(last);
+  if(index == json_pointer::npos or index > _array.size() or
+      (!_append and index == _array.size()))
+    throw std::out_of_range("json_patch: no element at " + _path.to_string());
+
+  return index;
+}
+
+
+template<class Json>
+void
+apply_patch(Json& _document, Json _patch) {
+  if(_patch.get_type() != Json::value_type::array)
+    throw std::invalid_argument("json_patch: a patch must be an array");
+
+  patcher<Json> document(_document);
+  for(auto& operation : _patch.template get<typename Json::array_type>())
+    document.apply(std::move(operation));
+}
+
+
+template<class Json>
+void
+apply_merge_patch(Json& _document, Json _patch) {
+  using object_type = typename Json::object_type;
+  using value_type = typename Json::value_type;
+
+  if(_patch.get_type() != value_type::object) {
+    _document = std::move(_patch);
+    return;
+  }
+
+  if(_document.get_type() != value_type::object)
+    _document = Json(object_type());
+
+  auto& object = _document.template get<object_type>();
+  for(auto& [key, value] : _patch.template get<object_type>()) {
+    const auto member = object.find(key);
+    if(value.get_type() == value_type::null) {
+      if(member != object.end())
+        object.erase(member);
+    }
+    else if(member != object.end())
+      apply_merge_patch(member->second, std::move(value));
+    else {
+      // Nulls in a new member are removed as from any other value.
+      Json added;
+      apply_merge_patch(added, std::move(value));
+      object.emplace(key, std::move(added));
+    }
+  }
+}
+
+
+/// \brief Builds the operations of diff().
+template<class Json>
+class differ final {
+
+  public:
+
+    using object_type = typename Json::object_type;
+    using array_type = typename Json::array_type;
+    using string_type = typename Json::string_type;
+    using value_type = typename Json::value_type;
+
+    /// \brief Add the operations that turn one value into another.
+    /// \param _source the value at the current path
+    /// \param _target the value it should become
+    void compare(const Json& _source, const Json& _target);
+
+    /// \brief Take the operations.
+    Json release() { return Json(std::move(m_operations)); }
+
+  private:
+
+    /// \brief Add an operation at the current path.
+    void emit(const char* const _op, const Json* const _value);
+
+    /// \brief Compare a child, with its token appended to the current path.
+    void compare_child(const std::string_view _token, const Json& _source,
+        const Json& _target) {
+      const auto size = push(_token);
+      compare(_source, _target);
+      m_path.resize(size);
+    }
+
+    /// \brief Append a token to the current path.
+    /// \return the length of the path before
+    std::size_t push(const std::string_view _token);
+
+    void compare_objects(const object_type& _source,
+        const object_type& _target);
+
+    void compare_arrays(const array_type& _source, const array_type& _target);
+
+    array_type m_operations;
+
+    /// The JSON Pointer of the current value, escaped.
+    std::string m_path;
+
+};
+
+
+template<class Json>
+void
+differ<Json>::
+compare(const Json& _source, const Json& _target) {
+  const auto type = _source.get_type();
+  if(type != _target.get_type() or
+      (type != value_type::object and type != value_type::array)) {
+    if(!(_source == _target))
+      emit("replace", &_target);
+    return;
+  }
+
+  // Equal memoized hashes are confirmed with ==, since a memo can be stale
+  // and the hash is not collision resistant.
+  if(&_source == &_target or (_source.is_hash_memoized() and
+        _target.is_hash_memoized() and _source.hash() == _target.hash() and
+        _source == _target))
+    return;
+
+  if(type == value_type::object)
+    compare_objects(_source.template get<object_type>(),
+        _target.template get<object_type>());
+  else
+    compare_arrays(_source.template get<array_type>(),
+        _target.template get<array_type>());
+}
+
+
+template<class Json>
+void
+differ<Json>::
+compare_objects(const object_type& _source, const object_type& _target) {
+  for(const auto& [key, value] : _source) {
+    const auto member = _target.find(key);
+    if(member != _target.end()) {
+      compare_child(std::string_view(key), value, member->second);
+      continue;
+    }
+
+    const auto size = push(std::string_view(key));
+    emit("remove", nullptr);
+    m_path.resize(size);
+  }
+
+  for(const auto& [key, value] : _target) {
+    if(_source.find(key) != _source.end())
+      continue;
+
+    const auto size = push(std::string_view(key));
+    emit("add", &value);
+    m_path.resize(size);
+  }
+}
+
+
+template<class Json>
+void
+differ<Json>::
+compare_arrays(const array_type& _source, const array_type& _target) {
+  // Elements equal at the start and the end are kept.
+  std::size_t first = 0;
+  auto source_last = _source.size();
+  auto target_last = _target.size();
+  while(first < source_last and first < target_last and
+      _source[first] == _target[first])
+    ++first;
+  while(source_last > first and target_last > first and
+      _source[source_last - 1] == _target[target_last - 1]) {
+    --source_last;
+    --target_last;
+  }
+
+  // The rest are diffed in pairs, and the unpaired removed or added where
+  // the pairs end.
+  auto i = first;
+  for(; i < source_last and i - first < target_last - first; ++i)
+    compare_child(std::to_string(i), _source[i], _target[i]);
+
+  const auto size = push(std::to_string(i));
+  for(auto j = i; j < source_last; ++j)
+    emit("remove", nullptr);
+  m_path.resize(size);
+
+  for(auto j = i; j < target_last; ++j) {
+    const auto size = push(std::to_string(j));
+    emit("add", &_target[j]);
+    m_path.resize(size);
+  }
+}
+
+
+template<class Json>
+void
+differ<Json>::
+emit(const char* const _op, const Json* const _value) {
+  object_type operation;
+  operation.emplace(string_type("op"), Json(_op));
+  operation.emplace(string_type("path"), Json(string_type(m_path)));
+  if(_value != nullptr)
+    operation.emplace(string_type("value"), *_value);
+
+  m_operations.emplace_back(std::move(operation));
+}
+
+
+template<class Json>
+std::size_t
+differ<Json>::
+push(const std::string_view _token) {
+  const auto size = m_path.size();
+  m_path += '/';
+  for(const auto c : _token) {
+    if(c == '~')
+      m_path += "~0";
+    else if(c == '/')
+      m_path += "~1";
+    else
+      m_path += c;
+  }
+
+  return size;
+}
+
+
+template<class Json>
+Json
+diff(const Json& _source, const Json& _target) {
+  differ<Json> operations;
+  operations.compare(_source, _target);
+  return operations.release();
+}
+
+
+}
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef BSTD_PMR_JSON_HPP_
+#define BSTD_PMR_JSON_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "basic_json.hpp"
+
+namespace bstd::json {
+
+/// \brief A basic_json whose strings, arrays and objects use polymorphic
+///        allocators.
+/// Values built by the parser allocate everything from the memory resource
+/// given to parse(), and moving a value keeps its allocator, so a whole
+/// document can live in one arena.
+using pmr_json = basic_json<std::pmr::map, std::pmr::vector, std::pmr::string>;
+
+/// \brief A pmr_json that lives, with all of its contents, in a monotonic
+///        arena.
+/// Destroying the document releases the arena in one step. The tree itself
+/// is never destroyed: its destructors would only return memory to the arena,
+/// which does nothing, so walking the tree to run them is skipped.
+class arena_document final {
+
+  public:
+
+    /// \brief Construct a document holding a null value.
+    /// \param _initial_size the size of the first block of the arena; a good
+    ///                      guess avoids growing it while parsing
+    explicit arena_document(const std::size_t _initial_size = 0)
+      : m_resource(std::max<std::size_t>(_initial_size, 1)),
+        m_root(new(m_resource.allocate(sizeof(pmr_json), alignof(pmr_json)))
+          pmr_json()) {}
+
+    arena_document(const arena_document&) = delete;
+    arena_document& operator=(const arena_document&) = delete;
+
+    /// \brief Get the root value.
+    /// \return the root value
+    pmr_json& get_root() noexcept { return *m_root; }
+    /// \copydoc get_root()
+    const pmr_json& get_root() const noexcept { return *m_root; }
+
+    /// \brief Get the arena.
+    /// \return the memory resource all values in this document should use
+    std::pmr::memory_resource* get_resource() noexcept { return &m_resource; }
+
+  private:
+
+    std::pmr::monotonic_buffer_resource m_resource;
+
+    /// Allocated in m_resource and deliberately never destroyed.
+    pmr_json* m_root;
+
+};
+
+}
+
+#endif
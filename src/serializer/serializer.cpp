@@ -0,0 +1,176 @@
+#include "serializer.hpp"
+
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include "parser/string_parser.hpp"
+
+
+namespace bstd::json::serializer {
+
+
+namespace {
+
+
+/// \brief 256-entry table mapping every special character to the character
+///        that follows the backslash in its escape sequence, or 'u' for
+///        control characters that need a \\u escape.
+constexpr std::array<char, 256> escapes = [] {
+  std::array<char, 256> table{};
+
+  for(auto c = 0; c < 0x20; ++c)
+    table[c] = 'u';
+
+  table['\b'] = 'b';
+  table['\f'] = 'f';
+  table['\n'] = 'n';
+  table['\r'] = 'r';
+  table['\t'] = 't';
+  table['"'] = '"';
+  table['\\'] = '\\';
+
+  return table;
+}();
+
+
+/// \brief Check if the text of a raw number is already valid JSON.
+/// The scanner also accepts a leading '+', leading zeros and a missing
+/// integer or fraction part, which must not be written.
+bool
+is_json_number(const std::string_view _text) noexcept {
+  auto is_digit = [](const char _c) { return _c >= '0' and _c <= '9'; };
+
+  auto it = _text.begin();
+  const auto last = _text.end();
+
+  if(it != last and *it == '-')
+    ++it;
+
+  if(it == last or !is_digit(*it))
+    return false;
+  if(*it++ == '0' and it != last and is_digit(*it))
+    return false;
+  while(it != last and is_digit(*it))
+    ++it;
+
+  if(it != last and *it == '.') {
+    if(++it == last or !is_digit(*it))
+      return false;
+    while(it != last and is_digit(*it))
+      ++it;
+  }
+
+  if(it != last and (*it == 'e' or *it == 'E')) {
+    if(++it != last and (*it == '+' or *it == '-'))
+      ++it;
+    if(it == last or !is_digit(*it))
+      return false;
+    while(it != last and is_digit(*it))
+      ++it;
+  }
+
+  return it == last;
+}
+
+
+}
+
+
+void
+serializer::
+write_string(const std::string_view _string) {
+  // Escaping at most multiplies the length by 6; reserve for the common case
+  // of few escapes, and again for each escape.
+  auto out = m_output.reserve(_string.size() + 2);
+  *out++ = '"';
+
+  auto run = _string.data();
+  const auto last = run + _string.size();
+  while(true) {
+    const auto it = parser::find_special_character(run, last);
+
+    const auto length = static_cast<std::size_t>(it - run);
+    std::memcpy(out, run, length);
+    out += length;
+    if(it == last)
+      break;
+
+    m_output.commit(out);
+
+    // Reserve for this escape and everything after it.
+    out = m_output.reserve(6 + static_cast<std::size_t>(last - it) + 1);
+    const auto escape = escapes[static_cast<unsigned char>(*it)];
+    *out++ = '\\';
+    *out++ = escape;
+    if(escape == 'u') {
+      constexpr char hex[] = "0123456789abcdef";
+      const auto c = static_cast<unsigned char>(*it);
+      *out++ = '0';
+      *out++ = '0';
+      *out++ = hex[c >> 4];
+      *out++ = hex[c & 0xF];
+    }
+
+    run = it + 1;
+  }
+
+  *out++ = '"';
+  m_output.commit(out);
+}
+
+
+void
+serializer::
+write_number(const number& _number) {
+  if(_number.get_kind() == number::kind::raw) {
+    if(const auto text = _number.get_raw(); is_json_number(text))
+      append(text);
+    else
+      write_number(number::parse(text));
+    return;
+  }
+
+  // Enough for any std::int64_t, std::uint64_t or shortest double.
+  constexpr std::size_t max_size = 32;
+  const auto out = m_output.reserve(max_size);
+  std::to_chars_result result;
+
+  switch(_number.get_kind()) {
+    case number::kind::integer:
+      result = std::to_chars(out, out + max_size, _number.get_int64());
+      break;
+    case number::kind::unsigned_integer:
+      result = std::to_chars(out, out + max_size, _number.get_uint64());
+      break;
+    default:
+      if(!std::isfinite(_number.get_double())) {
+        append(std::string_view("null"));
+        return;
+      }
+
+      result = std::to_chars(out, out + max_size, _number.get_double());
+      break;
+  }
+
+  m_output.commit(result.ptr);
+}
+
+
+void
+serializer::
+write_newline(const std::size_t _depth) {
+  if(m_indent == 0)
+    return;
+
+  const auto spaces = m_indent * _depth;
+  const auto out = m_output.reserve(1 + spaces);
+  out[0] = '\n';
+  std::memset(out + 1, ' ', spaces);
+  m_output.commit(out + 1 + spaces);
+}
+
+
+}
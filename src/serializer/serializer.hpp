@@ -0,0 +1,243 @@
+#ifndef BSTD_JSON_SERIALIZER_HPP_
+#define BSTD_JSON_SERIALIZER_HPP_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "number.hpp"
+#include "utilities/buffer_writer.hpp"
+
+namespace bstd::json::serializer {
+
+/// \brief Options for serialize().
+struct serialize_options {
+
+  /// Spaces of indentation per level of nesting. If 0, the output is
+  /// compact: one line with no whitespace at all. Otherwise every member and
+  /// element is on its own line.
+  std::size_t indent{0};
+
+};
+
+/// \brief Writes JSON text to the end of a caller's string.
+/// The string is used as a growable buffer by utilities::buffer_writer, so
+/// keeping one string and clearing it between documents means steady-state
+/// serialization does not allocate. Values are written without recursion, so nesting depth does not
+/// consume call stack, and without temporary strings.
+/// Integers are written with std::to_chars, and doubles with std::to_chars'
+/// shortest round-trip form (Ryu in libstdc++ and MSVC). Doubles that are not
+/// finite have no JSON form, and are written as null.
+class serializer final {
+
+  public:
+
+    /// \brief Construct a serializer that appends to a string.
+    /// \param _buffer the string to append to; must outlive the serializer
+    /// \param _options how to format the output
+    explicit serializer(std::string& _buffer,
+        const serialize_options& _options = {}) noexcept
+      : m_output(_buffer), m_indent(_options.indent) {}
+
+    /// \brief Write a JSON value.
+    /// \tparam Json a basic_json
+    /// \param _json the value
+    template<class Json>
+    void write(const Json& _json);
+
+    /// \brief Write a string, with quotes and escapes.
+    /// \param _string the unescaped string
+    void write_string(const std::string_view _string);
+
+    /// \brief Write a number.
+    /// \param _number the number
+    void write_number(const number& _number);
+
+    /// \copydoc write_number()
+    template<class T>
+      requires std::is_arithmetic_v<T>
+    void write_number(const T _number) { write_number(number(_number)); }
+
+    /// \brief Trim the string to the text written so far.
+    void finish() { m_output.finish(); }
+
+  private:
+
+    void append(const std::string_view _text) { m_output.append(_text); }
+
+    void append(const char _c) { m_output.append(_c); }
+
+    /// \brief Start a new line at a nesting depth, if the output is pretty.
+    void write_newline(const std::size_t _depth);
+
+    /// \brief Write a value, or open it and return true if it is a non-empty
+    ///        container.
+    template<class Json>
+    bool write_or_open(const Json& _json);
+
+    utilities::buffer_writer m_output;
+
+    std::size_t m_indent;
+
+};
+
+/// \brief Serialize a JSON value, appending it to a string.
+/// \tparam Json a basic_json
+/// \param _json the value
+/// \param _buffer the string to append to
+/// \param _options how to format the output
+template<class Json>
+void serialize(const Json& _json, std::string& _buffer,
+    const serialize_options& _options = {});
+
+/// \brief Serialize a JSON value to a new string.
+/// \tparam Json a basic_json
+/// \param _json the value
+/// \param _options how to format the output
+/// \return the JSON text
+template<class Json>
+std::string serialize(const Json& _json,
+    const serialize_options& _options = {});
+
+
+template<class Json>
+void
+serializer::
+write(const Json& _json) {
+  using object_type = typename Json::object_type;
+  using array_type = typename Json::array_type;
+  using object_iterator = typename object_type::const_iterator;
+  using array_iterator = typename array_type::const_iterator;
+
+  /// An open, non-empty container.
+  struct frame {
+    object_iterator m_member;
+    object_iterator m_members_end;
+    array_iterator m_element;
+    array_iterator m_elements_end;
+    bool m_is_object;
+    bool m_first;
+  };
+
+  const auto open = [](const Json& _container) {
+    frame opened{};
+    opened.m_is_object = _container.get_type() == Json::value_type::object;
+    opened.m_first = true;
+
+    if(opened.m_is_object) {
+      const auto& object = _container.template get<object_type>();
+      opened.m_member = object.begin();
+      opened.m_members_end = object.end();
+    }
+    else {
+      const auto& array = _container.template get<array_type>();
+      opened.m_element = array.begin();
+      opened.m_elements_end = array.end();
+    }
+
+    return opened;
+  };
+
+  if(!write_or_open(_json))
+    return;
+
+  std::vector<frame> frames{open(_json)};
+  while(!frames.empty()) {
+    auto& top = frames.back();
+    const auto end = top.m_is_object ? top.m_member == top.m_members_end :
+      top.m_element == top.m_elements_end;
+
+    if(end) {
+      const auto close = top.m_is_object ? '}' : ']';
+      frames.pop_back();
+      write_newline(frames.size());
+      append(close);
+      continue;
+    }
+
+    if(!top.m_first)
+      append(',');
+    top.m_first = false;
+    write_newline(frames.size());
+
+    const Json* value;
+    if(top.m_is_object) {
+      write_string(std::string_view(top.m_member->first));
+      append(':');
+      if(m_indent != 0)
+        append(' ');
+      value = &(top.m_member++)->second;
+    }
+    else
+      value = &*top.m_element++;
+
+    // top is invalidated by opening another container.
+    if(write_or_open(*value))
+      frames.push_back(open(*value));
+  }
+}
+
+
+template<class Json>
+bool
+serializer::
+write_or_open(const Json& _json) {
+  using value_type = typename Json::value_type;
+
+  switch(_json.get_type()) {
+    case value_type::object:
+      append('{');
+      if(_json.template get<typename Json::object_type>().empty()) {
+        append('}');
+        return false;
+      }
+      return true;
+    case value_type::array:
+      append('[');
+      if(_json.template get<typename Json::array_type>().empty()) {
+        append(']');
+        return false;
+      }
+      return true;
+    case value_type::string:
+      write_string(_json.get_string());
+      return false;
+    case value_type::number:
+      write_number(_json.template get<typename Json::number_type>());
+      return false;
+    case value_type::boolean:
+      append(_json.template get<typename Json::boolean_type>() ?
+          std::string_view("true") : std::string_view("false"));
+      return false;
+    case value_type::null:
+      append(std::string_view("null"));
+      return false;
+  }
+
+  return false;
+}
+
+
+template<class Json>
+void
+serialize(const Json& _json, std::string& _buffer,
+    const serialize_options& _options) {
+  serializer writer(_buffer, _options);
+  writer.write(_json);
+}
+
+
+template<class Json>
+std::string
+serialize(const Json& _json, const serialize_options& _options) {
+  std::string buffer;
+  serialize(_json, buffer, _options);
+  return buffer;
+}
+
+
+}
+
+#endif
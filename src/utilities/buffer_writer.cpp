@@ -0,0 +1,18 @@
+#include "buffer_writer.hpp"
+
+#include <algorithm>
+
+
+namespace bstd::json::utilities {
+
+
+void
+buffer_writer::
+grow(const std::size_t _size) {
+  // Grow from what has been written, not from the capacity: resize() fills
+  // every new byte, so a large reused buffer would be cleared on every call.
+  m_buffer.resize(std::max(m_size + _size, 2 * m_size));
+}
+
+
+}
@@ -0,0 +1,73 @@
+#ifndef BSTD_JSON_BUFFER_WRITER_HPP_
+#define BSTD_JSON_BUFFER_WRITER_HPP_
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace bstd::json::utilities {
+
+/// \brief Writes to the end of a caller's string.
+/// The string is used as a growable buffer: it is grown geometrically, output
+/// is written into it directly, and it is trimmed to what was written by
+/// finish() or on destruction. Keeping one string and clearing it between
+/// documents reuses its capacity, so steady-state writing does not allocate.
+class buffer_writer final {
+
+  public:
+
+    /// \brief Construct a writer that appends to a string.
+    /// \param _buffer the string to append to; must outlive the writer
+    explicit buffer_writer(std::string& _buffer) noexcept
+      : m_buffer(_buffer), m_size(_buffer.size()) {}
+
+    buffer_writer(const buffer_writer&) = delete;
+    buffer_writer& operator=(const buffer_writer&) = delete;
+
+    ~buffer_writer() { finish(); }
+
+    /// \brief Make room for at least _size more characters.
+    /// Pointers returned before are invalidated.
+    /// \return where to write them, to be passed to commit() once written
+    char* reserve(const std::size_t _size) {
+      if(m_buffer.size() - m_size < _size)
+        grow(_size);
+
+      return m_buffer.data() + m_size;
+    }
+
+    /// \brief Mark what was written after reserve() as part of the output.
+    /// \param _end one past the last character written
+    void commit(const char* const _end) noexcept {
+      m_size = static_cast<std::size_t>(_end - m_buffer.data());
+    }
+
+    void append(const std::string_view _text) {
+      std::memcpy(reserve(_text.size()), _text.data(), _text.size());
+      m_size += _text.size();
+    }
+
+    void append(const char _c) {
+      *reserve(1) = _c;
+      ++m_size;
+    }
+
+    /// \brief Trim the string to what was written so far.
+    void finish() { m_buffer.resize(m_size); }
+
+  private:
+
+    void grow(const std::size_t _size);
+
+    std::string& m_buffer;
+
+    /// The length of what was written, including what the buffer held
+    /// before; m_buffer may be longer.
+    std::size_t m_size;
+
+};
+
+}
+
+#endif
@@ -12,6 +12,15 @@ open_json_file(const std::string& _path, std::ios_base::openmode _mode) {
   return std::fstream(_path, _mode);
 }
 
+mapped_file
+map_json_file(const std::string_view _path) {
+  if(!is_json_extension(_path))
+    return mapped_file();
+
+  return mapped_file(std::string(_path));
+}
+
+
 const bool
 is_json_extension(const std::string_view& _path) {
   return _path.ends_with(".json");
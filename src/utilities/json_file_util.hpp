@@ -7,6 +7,8 @@
 
 #include <bstd_error.hpp>
 
+#include "mapped_file.hpp"
+
 namespace bstd::json::utilities {
 
 /// \brief Open a file with the .json extension.
@@ -17,6 +19,11 @@ namespace bstd::json::utilities {
 std::fstream open_json_file(const std::string& _path,
     std::ios_base::openmode _mode);
 
+/// \brief Map a file with the .json extension into memory.
+/// \param _path the file path
+/// \return a mapped_file of the JSON file, or a closed mapped_file otherwise
+mapped_file map_json_file(const std::string_view _path);
+
 /// \brief Check if a file has the .json extension.
 /// \param _path the file path
 /// \return true if _path has the .json extension, false otherwise
@@ -0,0 +1,136 @@
+#include "mapped_file.hpp"
+
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+namespace bstd::json::utilities {
+
+
+mapped_file::
+mapped_file(const std::string& _path) {
+  const auto fd = ::open(_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if(fd < 0)
+    return;
+
+  struct stat status;
+  if(::fstat(fd, &status) != 0 or !S_ISREG(status.st_mode)) {
+    ::close(fd);
+    return;
+  }
+
+  m_size = static_cast<std::size_t>(status.st_size);
+  m_open = true;
+
+  if(m_size == 0) {
+    ::close(fd);
+    return;
+  }
+
+  auto mapping = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if(mapping != MAP_FAILED) {
+    ::madvise(mapping, m_size, MADV_SEQUENTIAL);
+#if defined(MADV_HUGEPAGE)
+    if(m_size >= huge_page_threshold)
+      ::madvise(mapping, m_size, MADV_HUGEPAGE);
+#endif
+
+    m_data = static_cast<const char*>(mapping);
+    m_mapped = true;
+    ::close(fd);
+    return;
+  }
+
+  // Fall back to reading the whole file at once.
+  m_buffer = std::make_unique<char[]>(m_size);
+  std::size_t total = 0;
+  while(total < m_size) {
+    const auto count = ::read(fd, m_buffer.get() + total, m_size - total);
+    if(count <= 0)
+      break;
+    total += static_cast<std::size_t>(count);
+  }
+  ::close(fd);
+
+  if(total != m_size) {
+    m_buffer.reset();
+    m_size = 0;
+    m_open = false;
+    return;
+  }
+
+  m_data = m_buffer.get();
+}
+
+
+mapped_file::
+~mapped_file() {
+  close();
+}
+
+
+mapped_file::
+mapped_file(mapped_file&& _other) noexcept
+    : m_data(std::exchange(_other.m_data, nullptr)),
+      m_size(std::exchange(_other.m_size, 0)),
+      m_open(std::exchange(_other.m_open, false)),
+      m_mapped(std::exchange(_other.m_mapped, false)),
+      m_buffer(std::move(_other.m_buffer)) {}
+
+
+mapped_file&
+mapped_file::
+operator=(mapped_file&& _other) noexcept {
+  if(this != &_other) {
+    close();
+    m_data = std::exchange(_other.m_data, nullptr);
+    m_size = std::exchange(_other.m_size, 0);
+    m_open = std::exchange(_other.m_open, false);
+    m_mapped = std::exchange(_other.m_mapped, false);
+    m_buffer = std::move(_other.m_buffer);
+  }
+
+  return *this;
+}
+
+
+bool
+mapped_file::
+is_open() const noexcept {
+  return m_open;
+}
+
+
+bool
+mapped_file::
+is_mapped() const noexcept {
+  return m_mapped;
+}
+
+
+std::string_view
+mapped_file::
+get_view() const noexcept {
+  return std::string_view(m_data, m_size);
+}
+
+
+void
+mapped_file::
+close() noexcept {
+  if(m_mapped)
+    ::munmap(const_cast<char*>(m_data), m_size);
+
+  m_buffer.reset();
+  m_data = nullptr;
+  m_size = 0;
+  m_open = false;
+  m_mapped = false;
+}
+
+
+}
@@ -0,0 +1,70 @@
+#ifndef BSTD_JSON_MAPPED_FILE_HPP_
+#define BSTD_JSON_MAPPED_FILE_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace bstd::json::utilities {
+
+/// \brief Read-only view of a whole file.
+/// The file is memory-mapped with a sequential-access hint, and a huge-page
+/// hint for large files where the platform supports it, so its contents can be
+/// parsed in place without being copied. If the file cannot be mapped, it is
+/// read into a buffer with a single read().
+class mapped_file final {
+
+  public:
+
+    /// Files at least this large are given a huge-page hint.
+    static constexpr std::size_t huge_page_threshold = 2 * 1024 * 1024;
+
+    mapped_file() = default;
+
+    /// \brief Map a file.
+    /// \param _path the file path
+    explicit mapped_file(const std::string& _path);
+
+    ~mapped_file();
+
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    mapped_file(mapped_file&& _other) noexcept;
+    mapped_file& operator=(mapped_file&& _other) noexcept;
+
+    /// \brief Check if the file was opened.
+    /// \return true if the file contents are available
+    bool is_open() const noexcept;
+
+    /// \brief Check if the file is memory-mapped.
+    /// \return true if the file is mapped, false if it was read into a buffer
+    ///         or could not be opened
+    bool is_mapped() const noexcept;
+
+    /// \brief Get the file contents.
+    /// \return a view of the file contents, valid while this object is alive
+    std::string_view get_view() const noexcept;
+
+  private:
+
+    /// \brief Unmap or free the file contents.
+    void close() noexcept;
+
+    const char* m_data{nullptr};
+
+    std::size_t m_size{0};
+
+    bool m_open{false};
+
+    bool m_mapped{false};
+
+    /// Holds the file contents if mapping failed.
+    std::unique_ptr<char[]> m_buffer;
+
+};
+
+}
+
+#endif
@@ -0,0 +1,94 @@
+#include "string_pool.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <mutex>
+#include <new>
+
+
+namespace bstd::json::utilities {
+
+
+namespace {
+
+
+/// Entries are packed into blocks of at least this many bytes.
+constexpr std::size_t block_size = 64 * 1024;
+
+
+}
+
+
+const string_entry*
+string_pool::
+intern(const std::string_view _string) {
+  const auto hash = std::hash<std::string_view>()(_string);
+  auto& target = m_shards[hash % shard_count];
+
+  {
+    std::shared_lock lock(target.m_mutex);
+    if(const auto it = target.m_entries.find(_string);
+        it != target.m_entries.end())
+      return it->second;
+  }
+
+  std::unique_lock lock(target.m_mutex);
+
+  // Another thread may have added it between the locks.
+  if(const auto it = target.m_entries.find(_string);
+      it != target.m_entries.end())
+    return it->second;
+
+  const auto entry = allocate(target, _string);
+  target.m_entries.emplace(entry->get_view(), entry);
+  return entry;
+}
+
+
+std::size_t
+string_pool::
+size() const {
+  std::size_t size = 0;
+  for(const auto& target : m_shards) {
+    std::shared_lock lock(target.m_mutex);
+    size += target.m_entries.size();
+  }
+
+  return size;
+}
+
+
+string_pool&
+string_pool::
+get_default() {
+  static string_pool pool;
+  return pool;
+}
+
+
+const string_entry*
+string_pool::
+allocate(shard& _shard, const std::string_view _string) {
+  constexpr auto alignment = alignof(string_entry);
+  const auto size = (sizeof(string_entry) + _string.size() + alignment - 1) /
+    alignment * alignment;
+
+  if(_shard.m_available < size) {
+    const auto allocation = std::max(block_size, size);
+    _shard.m_blocks.push_back(std::make_unique<std::byte[]>(allocation));
+    _shard.m_free = _shard.m_blocks.back().get();
+    _shard.m_available = allocation;
+  }
+
+  const auto entry = new(_shard.m_free) string_entry{_string.size(), {0}};
+  std::memcpy(const_cast<char*>(entry->data()), _string.data(),
+      _string.size());
+
+  _shard.m_free += size;
+  _shard.m_available -= size;
+  return entry;
+}
+
+
+}
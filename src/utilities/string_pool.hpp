@@ -0,0 +1,83 @@
+#ifndef BSTD_JSON_STRING_POOL_HPP_
+#define BSTD_JSON_STRING_POOL_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace bstd::json::utilities {
+
+/// \brief A string stored with its length, followed by its characters.
+struct string_entry {
+
+  std::size_t m_size;
+
+  /// Owners of a string that is not in a pool; 0 for pooled strings, which
+  /// live as long as their pool.
+  mutable std::atomic<std::size_t> m_references;
+
+  const char* data() const noexcept {
+    return reinterpret_cast<const char*>(this + 1);
+  }
+
+  std::string_view get_view() const noexcept { return {data(), m_size}; }
+
+};
+
+/// \brief A thread-safe set of unique strings.
+/// Interning a string returns the one entry for its contents, so interned
+/// strings can be compared by address. Entries are never removed, and are
+/// packed into large blocks. The pool is split into shards by hash, each with
+/// its own reader-writer lock, so concurrent parses rarely contend, and
+/// looking up a string that is already interned only takes a shared lock.
+class string_pool final {
+
+  public:
+
+    /// The number of independently locked shards.
+    static constexpr std::size_t shard_count = 16;
+
+    string_pool() = default;
+
+    string_pool(const string_pool&) = delete;
+    string_pool& operator=(const string_pool&) = delete;
+
+    /// \brief Get the entry for a string, adding it if needed.
+    /// \param _string the string
+    /// \return the entry, valid as long as the pool is
+    const string_entry* intern(const std::string_view _string);
+
+    /// \brief Count the interned strings.
+    /// \return the number of unique strings in the pool
+    std::size_t size() const;
+
+    /// \brief Get a pool shared by the whole process.
+    /// \return the pool, which lives until the process exits
+    static string_pool& get_default();
+
+  private:
+
+    struct shard {
+      mutable std::shared_mutex m_mutex;
+      std::unordered_map<std::string_view, const string_entry*> m_entries;
+      std::vector<std::unique_ptr<std::byte[]>> m_blocks;
+      std::byte* m_free{nullptr};
+      std::size_t m_available{0};
+    };
+
+    /// \brief Allocate and construct an entry in a shard's blocks.
+    static const string_entry* allocate(shard& _shard,
+        const std::string_view _string);
+
+    std::array<shard, shard_count> m_shards;
+
+};
+
+}
+
+#endif
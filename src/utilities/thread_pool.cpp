@@ -0,0 +1,172 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+
+namespace bstd::json::utilities {
+
+
+namespace {
+
+
+/// The pool the current thread works for, if any.
+thread_local const thread_pool* current_pool{nullptr};
+
+/// The index of the current thread's queue in current_pool.
+thread_local std::size_t current_index{0};
+
+
+}
+
+
+thread_pool::
+thread_pool(const std::size_t _threads) {
+  auto threads = _threads;
+  if(threads == 0)
+    threads = std::max(std::thread::hardware_concurrency(), 1u);
+
+  m_queues.reserve(threads);
+  for(std::size_t i = 0; i < threads; ++i)
+    m_queues.push_back(std::make_unique<worker_queue>());
+
+  m_threads.reserve(threads);
+  for(std::size_t i = 0; i < threads; ++i)
+    m_threads.emplace_back(&thread_pool::run, this, i);
+}
+
+
+thread_pool::
+~thread_pool() {
+  {
+    std::lock_guard lock(m_mutex);
+    m_stop = true;
+  }
+  m_condition.notify_all();
+
+  for(auto& thread : m_threads)
+    thread.join();
+}
+
+
+void
+thread_pool::
+submit(task_type _task) {
+  std::size_t index;
+  if(current_pool == this)
+    index = current_index;
+  else {
+    std::lock_guard lock(m_mutex);
+    index = m_next++ % m_queues.size();
+  }
+
+  {
+    auto& queue = *m_queues[index];
+    std::lock_guard lock(queue.m_mutex);
+    queue.m_tasks.push_back(std::move(_task));
+  }
+
+  // Only count the task once it is queued, so a worker that claims it is
+  // guaranteed to find it.
+  {
+    std::lock_guard lock(m_mutex);
+    ++m_pending;
+  }
+  m_condition.notify_one();
+}
+
+
+bool
+thread_pool::
+run_pending() {
+  {
+    std::lock_guard lock(m_mutex);
+    if(m_pending == 0)
+      return false;
+
+    --m_pending;
+  }
+
+  // Claimed the same way as in run(). A worker takes its own tasks first.
+  const auto index = current_pool == this ? current_index : 0;
+  task_type task;
+  while(!take(index, task))
+    std::this_thread::yield();
+
+  task();
+  return true;
+}
+
+
+std::size_t
+thread_pool::
+size() const noexcept {
+  return m_threads.size();
+}
+
+
+thread_pool&
+thread_pool::
+get_default() {
+  static thread_pool pool;
+  return pool;
+}
+
+
+void
+thread_pool::
+run(const std::size_t _index) {
+  current_pool = this;
+  current_index = _index;
+
+  for(;;) {
+    {
+      std::unique_lock lock(m_mutex);
+      m_condition.wait(lock, [this] { return m_stop or m_pending > 0; });
+
+      // Queued tasks are still run when stopping.
+      if(m_pending == 0)
+        return;
+
+      --m_pending;
+    }
+
+    // A task has been claimed, so one is in some queue. Another worker may
+    // have stolen the one this worker saw, but then that worker's own claimed
+    // task is still queued.
+    task_type task;
+    while(!take(_index, task))
+      std::this_thread::yield();
+
+    task();
+  }
+}
+
+
+bool
+thread_pool::
+take(const std::size_t _index, task_type& _task) {
+  {
+    auto& own = *m_queues[_index];
+    std::lock_guard lock(own.m_mutex);
+    if(!own.m_tasks.empty()) {
+      _task = std::move(own.m_tasks.back());
+      own.m_tasks.pop_back();
+      return true;
+    }
+  }
+
+  for(std::size_t i = 1; i < m_queues.size(); ++i) {
+    auto& victim = *m_queues[(_index + i) % m_queues.size()];
+    std::lock_guard lock(victim.m_mutex);
+    if(!victim.m_tasks.empty()) {
+      _task = std::move(victim.m_tasks.front());
+      victim.m_tasks.pop_front();
+      return true;
+    }
+  }
+
+  return false;
+}
+
+
+}
@@ -0,0 +1,118 @@
+#ifndef BSTD_JSON_THREAD_POOL_HPP_
+#define BSTD_JSON_THREAD_POOL_HPP_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace bstd::json::utilities {
+
+/// \brief A fixed set of worker threads that share work by stealing.
+/// Every worker owns a task queue. A worker takes tasks from the back of its
+/// own queue and, when that is empty, steals from the front of the others, so
+/// uneven tasks are balanced without a single contended queue. Tasks
+/// submitted from a worker go to that worker's own queue; tasks submitted
+/// from any other thread are spread across the queues.
+/// Tasks must not throw.
+class thread_pool final {
+
+  public:
+
+    using task_type = std::function<void()>;
+
+    /// \brief Start the worker threads.
+    /// \param _threads the number of workers; 0 uses one per hardware thread
+    explicit thread_pool(const std::size_t _threads = 0);
+
+    /// \brief Run the remaining tasks and join the workers.
+    ~thread_pool();
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    /// \brief Queue a task.
+    /// \param _task the task
+    void submit(task_type _task);
+
+    /// \brief Run one queued task on the calling thread.
+    /// \return false if no task was queued
+    bool run_pending();
+
+    /// \brief Wait for a condition, running queued tasks meanwhile.
+    /// A thread that waits for its own tasks, even a worker of this pool, so
+    /// never blocks while they are still queued.
+    /// \param _lock holds the mutex that guards the condition
+    /// \param _condition notified, under that mutex, when the condition may
+    ///                   have changed
+    /// \param _done the condition
+    template<class Predicate>
+    void wait(std::unique_lock<std::mutex>& _lock,
+        std::condition_variable& _condition, Predicate _done);
+
+    /// \brief Get the number of workers.
+    /// \return the number of workers
+    std::size_t size() const noexcept;
+
+    /// \brief Get a pool shared by the whole process.
+    /// \return a pool with one worker per hardware thread
+    static thread_pool& get_default();
+
+  private:
+
+    struct worker_queue {
+      std::mutex m_mutex;
+      std::deque<task_type> m_tasks;
+    };
+
+    /// \brief The loop each worker runs.
+    void run(const std::size_t _index);
+
+    /// \brief Take a task, stealing if the worker's own queue is empty.
+    /// \return false if every queue is empty
+    bool take(const std::size_t _index, task_type& _task);
+
+    std::vector<std::unique_ptr<worker_queue>> m_queues;
+
+    std::vector<std::thread> m_threads;
+
+    /// Guards m_pending and m_stop.
+    std::mutex m_mutex;
+
+    std::condition_variable m_condition;
+
+    /// Tasks queued but not yet claimed by a worker.
+    std::size_t m_pending{0};
+
+    /// The queue the next task from outside the pool goes to.
+    std::size_t m_next{0};
+
+    bool m_stop{false};
+
+};
+
+
+template<class Predicate>
+void
+thread_pool::
+wait(std::unique_lock<std::mutex>& _lock, std::condition_variable& _condition,
+    Predicate _done) {
+  while(!_done()) {
+    _lock.unlock();
+    const auto ran = run_pending();
+    _lock.lock();
+
+    // Nothing is queued, so every task waited for is already running on some
+    // thread and will notify when it finishes.
+    if(!ran)
+      _condition.wait(_lock, _done);
+  }
+}
+
+}
+
+#endif
@@ -11,6 +11,7 @@ test_lexer() {
   ADD_TEST(test_lexer::reset);
   ADD_TEST(test_lexer::lex);
   ADD_TEST(test_lexer::lex_bad_input);
+  ADD_TEST(test_lexer::tape);
 }
 
 
@@ -71,6 +72,12 @@ lex() {
 
   VERIFY(ws_lexer.get_tokens() == m_lexed_whitespace,
       "lexer::lex JSON whitespace")
+
+  lexer strings_lexer(m_strings, true, false);
+  strings_lexer.lex();
+
+  VERIFY(strings_lexer.get_tokens() == m_lexed_strings,
+      "lexer::lex JSON strings")
 }
 
 
@@ -89,6 +96,37 @@ lex_bad_input() {
   VERIFY(bad_input_lexer2.get_tokens() == m_lexed_bad_input2,
       "lexer::lex_bad_input bad_input2")
 
+  lexer utf8_lexer("[\"\xc3\xa9\", \"\xc3\"]", true, true);
+  std::string message;
+  try {
+    utf8_lexer.lex();
+  }
+  catch(const bstd::error::error& _error) {
+    message = _error.what();
+  }
+
+  VERIFY(message.find("Invalid UTF-8") != std::string::npos,
+      "lexer::lex_bad_input invalid UTF-8")
+}
+
+
+
+
+void
+test_lexer::
+tape() {
+  lexer l(m_nested, true, false);
+  l.lex();
+  const auto& t = l.get_tape();
+
+  VERIFY(t.size() == l.get_tokens().size(), "tape::size")
+  VERIFY(t.get_matching(0) == t.size() - 2, "tape::get_matching outer array")
+  VERIFY(t.get_matching(1) == 3, "tape::get_matching inner array")
+  VERIFY(t.get_type(t.get_matching(6)) == token::end_object,
+      "tape::get_matching object")
+  VERIFY(t.get_offset(0) == 0 and t.get_offset(1) == 1 and
+      t.get_offset(2) == 2, "tape::get_offset")
+  VERIFY(t.get_text(7) == "\"a\"", "tape::get_text")
 }
 
 
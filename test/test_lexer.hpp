@@ -18,6 +18,7 @@ class test_lexer final : public bstd::test::unit_tester {
     void reset();
     void lex();
     void lex_bad_input();
+    void tape();
 
   private:
 
@@ -93,6 +94,20 @@ class test_lexer final : public bstd::test::unit_tester {
         { token::end_json }
     };
 
+    const std::string m_strings{"[\"a \\\"quoted\\\" string that is longer than one "
+      "64-byte block, with [brackets], {braces}, and: colons\",\"\\\\\"]"};
+    const std::vector<token> m_lexed_strings {
+        { token::begin_array },
+        { token::string, "a \\\"quoted\\\" string that is longer than one "
+          "64-byte block, with [brackets], {braces}, and: colons" },
+        { token::comma },
+        { token::string, "\\\\" },
+        { token::end_array },
+        { token::end_json }
+    };
+
+    const std::string m_nested{"[[1], {\"a\":[]}]"};
+
     const std::string m_bad_input1{"\"testingasdf;\":[true,a;ldfks,0]"};
     const std::vector<token> m_lexed_bad_input1 {
       { token::string, "testingasdf;" },
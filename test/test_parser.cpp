@@ -0,0 +1,1314 @@
+#include "test_parser.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <future>
+
+BSTD_TEST_MAIN(bstd::json::test::test_parser)
+
+namespace bstd::json::test {
+
+
+namespace {
+
+
+/// Records events as a compact string.
+struct recording_handler {
+  void begin_object() { events += '{'; }
+  void end_object() { events += '}'; }
+  void begin_array() { events += '['; }
+  void end_array() { events += ']'; }
+  void key(const std::string_view _key) { events += "k:"; events += _key; }
+  void string(const std::string_view _s) { events += "s:"; events += _s; }
+  void number(const std::string_view _n) { events += "n:"; events += _n; }
+  void boolean(const bool _b) { events += _b ? 'T' : 'F'; }
+  void null() { events += '0'; }
+
+  std::string events;
+};
+
+
+}
+
+
+test_parser::
+test_parser() {
+  ADD_TEST(test_parser::parse_values);
+  ADD_TEST(test_parser::parse_containers);
+  ADD_TEST(test_parser::parse_nested);
+  ADD_TEST(test_parser::parse_file);
+  ADD_TEST(test_parser::parse_bad_input);
+  ADD_TEST(test_parser::parse_incremental);
+  ADD_TEST(test_parser::parse_sax);
+  ADD_TEST(test_parser::parse_lazy);
+  ADD_TEST(test_parser::parse_ndjson);
+  ADD_TEST(test_parser::parse_parallel);
+  ADD_TEST(test_parser::parse_pmr);
+  ADD_TEST(test_parser::parse_flat);
+  ADD_TEST(test_parser::parse_interned);
+  ADD_TEST(test_parser::parse_numbers);
+  ADD_TEST(test_parser::parse_escapes);
+  ADD_TEST(test_parser::parse_utf8);
+  ADD_TEST(test_parser::serialize);
+  ADD_TEST(test_parser::pointer_lookup);
+  ADD_TEST(test_parser::path_query);
+  ADD_TEST(test_parser::compare_values);
+  ADD_TEST(test_parser::patch_documents);
+  ADD_TEST(test_parser::encode_binary);
+  ADD_TEST(test_parser::snapshot_documents);
+}
+
+
+void
+test_parser::
+parse_values() {
+  VERIFY(parse("\"string\"")->get<json::string_type>() == "string",
+      "parse string")
+  VERIFY(parse("-42")->get<json::number_type>() == -42, "parse number")
+  VERIFY(parse("true")->get<json::boolean_type>(), "parse true")
+  VERIFY(!parse("false")->get<json::boolean_type>(), "parse false")
+  VERIFY(parse(" null ")->get_type() == json::value_type::null, "parse null")
+
+  auto short_string = *parse("\"short\"");
+  short_string.get<json::string_type>() += " string, now longer";
+  VERIFY(short_string.get_string() == "short string, now longer",
+      "parse string changed through get")
+}
+
+
+void
+test_parser::
+parse_containers() {
+  const auto object = parse(m_object);
+
+  VERIFY(object->get_type() == json::value_type::object, "parse object type")
+  VERIFY(object->size() == 7, "parse object size")
+  VERIFY(object->at("name").get<json::string_type>() == "value",
+      "parse object string member")
+  VERIFY(object->at("number").get<json::number_type>() == -12,
+      "parse object number member")
+  VERIFY(object->at("float").get<json::number_type>() == 25,
+      "parse object exponent member")
+  VERIFY(object->at("true").get<json::boolean_type>(),
+      "parse object true member")
+  VERIFY(object->at("null").get_type() == json::value_type::null,
+      "parse object null member")
+  VERIFY(object->at("dup").get<json::number_type>() == 2,
+      "parse object duplicate member")
+
+  const auto array = parse(m_array);
+
+  VERIFY(array->get_type() == json::value_type::array, "parse array type")
+  VERIFY(array->size() == 5, "parse array size")
+  VERIFY(array->at(1).get<json::string_type>() == "two",
+      "parse array string element")
+  VERIFY(array->at(2).at(1).at(0).get<json::number_type>() == 4,
+      "parse nested array element")
+  VERIFY(array->at(3).empty() and array->at(4).empty(),
+      "parse empty containers")
+}
+
+
+void
+test_parser::
+parse_nested() {
+  const std::size_t depth = 100000;
+  const auto deep = std::string(depth, '[') + std::string(depth, ']');
+
+  auto result = parse(deep);
+  std::size_t levels = 1;
+  for(const json* value = result.get(); !value->empty();
+      value = &value->at(0))
+    ++levels;
+
+  VERIFY(levels == depth, "parse deeply nested arrays")
+
+  // Tear down iteratively; the recursive destructor would use as much stack
+  // as recursive parsing.
+  while(!result->empty()) {
+    auto inner = std::move(result->get<json::array_type>().front());
+    *result = std::move(inner);
+  }
+}
+
+
+void
+test_parser::
+parse_file() {
+  const auto object = parse("json_files/object.json");
+
+  VERIFY(object->get_type() == json::value_type::object, "parse .json file")
+}
+
+
+void
+test_parser::
+parse_bad_input() {
+  for(const auto& input : m_bad_inputs) {
+    bool thrown = false;
+    try {
+      parse(input);
+    }
+    catch(const bstd::error::error&) {
+      thrown = true;
+    }
+
+    VERIFY(thrown, "parse bad input: " + input)
+    VERIFY(parse(input, false, false)->get_type() == json::value_type::null,
+        "parse bad input without throwing: " + input)
+  }
+}
+
+
+
+
+void
+test_parser::
+parse_incremental() {
+  incremental_parser p;
+
+  // One byte at a time splits every token.
+  for(const auto c : m_object)
+    p.feed(std::string_view(&c, 1));
+  const auto object = p.finish();
+
+  VERIFY(object->size() == 7, "incremental_parser object size")
+  VERIFY(object->at("name").get<json::string_type>() == "value",
+      "incremental_parser split string")
+  VERIFY(object->at("float").get<json::number_type>() == 25,
+      "incremental_parser split number")
+  VERIFY(!object->at("false").get<json::boolean_type>(),
+      "incremental_parser split literal")
+
+  for(std::size_t i = 0; i < m_array.size(); i += 3)
+    p.feed(std::string_view(m_array).substr(i, 3));
+  const auto array = p.finish();
+
+  VERIFY(array->at(2).at(1).at(0).get<json::number_type>() == 4,
+      "incremental_parser nested array")
+
+  p.feed("[\"a\\");
+  p.feed("\"b\", 1");
+  p.feed("23]");
+  const auto escaped = p.finish();
+
+  VERIFY(escaped->at(0).get<json::string_type>() == "a\"b",
+      "incremental_parser split escape")
+  VERIFY(escaped->at(1).get<json::number_type>() == 123,
+      "incremental_parser number at end of chunk")
+
+  p.feed("12");
+  VERIFY(p.finish()->get<json::number_type>() == 12,
+      "incremental_parser number at end of input")
+
+  bool thrown = false;
+  try {
+    p.feed("[tr");
+    p.feed("ux]");
+  }
+  catch(const bstd::error::error&) {
+    thrown = true;
+  }
+  VERIFY(thrown, "incremental_parser bad split literal")
+
+  p.reset();
+  p.feed("[1, \"abc");
+
+  thrown = false;
+  try {
+    p.finish();
+  }
+  catch(const bstd::error::error&) {
+    thrown = true;
+  }
+  VERIFY(thrown, "incremental_parser unterminated input")
+
+  incremental_parser quiet(false, false);
+  quiet.feed("[1, ");
+  quiet.feed("2 x]");
+  VERIFY(quiet.get_offset() == 6, "incremental_parser error offset")
+}
+
+
+
+
+void
+test_parser::
+parse_sax() {
+  recording_handler handler;
+  const auto result = parser::parse_sax(m_array, handler);
+
+  VERIFY(result, "parse_sax result")
+  VERIFY(handler.events == "[n:1s:two[n:3[n:4]]{}[]]", "parse_sax events")
+
+  recording_handler object_handler;
+  parser::parse_sax(R"({"a": [true, false, null]})", object_handler);
+
+  VERIFY(object_handler.events == "{k:a[TF0]}", "parse_sax object events")
+
+  recording_handler bad_handler;
+  const auto bad_result = parser::parse_sax("[1, 2", bad_handler, false);
+
+  VERIFY(!bad_result and bad_result.offset == 5, "parse_sax error")
+}
+
+
+
+
+void
+test_parser::
+parse_lazy() {
+  const auto object = parser::parse_lazy(m_object);
+  const auto root = object->get_root();
+
+  VERIFY(root.get_type() == json::value_type::object, "parse_lazy root type")
+  VERIFY(root.size() == 8, "parse_lazy object size counts duplicates")
+  VERIFY(root["name"].get<json::string_type>() == "value",
+      "parse_lazy string member")
+  VERIFY(root["float"].get_text() == "2.5e1", "parse_lazy number text")
+  VERIFY(!root.find("missing"), "parse_lazy missing member")
+  VERIFY(root["dup"].get<json::number_type>() ==
+      parse(m_object)->at("dup").get<json::number_type>(),
+      "parse_lazy last duplicate wins")
+
+  const std::string escaped = R"({"a\"b": 1, "\u0063": 2})";
+  const auto keys = parser::parse_lazy(escaped);
+  VERIFY(keys->get_root()["a\"b"].get<json::number_type>() == 1 and
+      keys->get_root()["c"].get<json::number_type>() == 2,
+      "parse_lazy escaped keys")
+
+  const auto padded = " " + m_array;
+  const auto array = parser::parse_lazy(padded);
+  const auto nested = array->get_root()[2];
+
+  VERIFY(nested.get_text() == "[3, [4]]", "parse_lazy container text")
+  VERIFY(nested[1][0].get<json::number_type>() == 4,
+      "parse_lazy nested element")
+  VERIFY(nested.get_json().at(1).at(0).get<json::number_type>() == 4,
+      "parse_lazy get_json")
+  VERIFY(array->get_root()[3].size() == 0, "parse_lazy empty object")
+
+  bool thrown = false;
+  try {
+    nested[2];
+  }
+  catch(const std::out_of_range&) {
+    thrown = true;
+  }
+  VERIFY(thrown, "parse_lazy index out of range")
+
+  thrown = false;
+  try {
+    parser::parse_lazy("[1, 2");
+  }
+  catch(const bstd::error::error&) {
+    thrown = true;
+  }
+  VERIFY(thrown, "parse_lazy bad input")
+}
+
+
+void
+test_parser::
+parse_ndjson() {
+  std::string records;
+  for(auto i = 0; i < 1000; ++i)
+    records += "{\"id\": " + std::to_string(i) +
+      ", \"tags\": [\"a\", \"b\"]}\n";
+  records += "\n  \r\n[1]";
+
+  utilities::thread_pool pool(4);
+  ndjson_options options;
+  options.batch_size = 64;
+  options.pool = &pool;
+
+  std::vector<json::number_type> ids;
+  const auto ordered = parser::parse_ndjson(records,
+      [&](std::size_t, json&& _record) {
+        if(_record.get_type() == json::value_type::object)
+          ids.push_back(_record.at("id").get<json::number_type>());
+      }, options);
+
+  auto in_order = ids.size() == 1000;
+  for(std::size_t i = 0; in_order and i < ids.size(); ++i)
+    in_order = ids[i] == i;
+
+  VERIFY(ordered == 1001, "parse_ndjson record count")
+  VERIFY(in_order, "parse_ndjson preserves order")
+
+  options.ordered = false;
+  ids.clear();
+  parser::parse_ndjson(records, [&](std::size_t, json&& _record) {
+        if(_record.get_type() == json::value_type::object)
+          ids.push_back(_record.at("id").get<json::number_type>());
+      }, options);
+
+  std::sort(ids.begin(), ids.end());
+  auto complete = ids.size() == 1000;
+  for(std::size_t i = 0; complete and i < ids.size(); ++i)
+    complete = ids[i] == i;
+
+  VERIFY(complete, "parse_ndjson unordered delivers every record")
+
+  std::size_t delivered = 0;
+  bool thrown = false;
+  try {
+    parser::parse_ndjson("1\n2\n[3,\n4", [&](std::size_t, json&&) {
+          ++delivered;
+        }, options);
+  }
+  catch(const bstd::error::error&) {
+    thrown = true;
+  }
+  VERIFY(thrown, "parse_ndjson bad record")
+
+  delivered = parser::parse_ndjson("1\n[3,\n4", [](std::size_t, json&&) {},
+      options, false);
+  VERIFY(delivered == 2, "parse_ndjson skips bad records")
+
+  std::string bad;
+  for(auto i = 0; i < 200; ++i)
+    bad += i == 100 ? "[1,\n" : std::to_string(i) + "\n";
+  const auto error_offset = bad.find('[');
+
+  // Unordered, records after the bad one may have been delivered before it
+  // was parsed, but every record before it has been by the time it throws.
+  std::size_t before_error = 0;
+  thrown = false;
+  try {
+    parser::parse_ndjson(bad, [&](std::size_t _offset, json&&) {
+          if(_offset < error_offset)
+            ++before_error;
+        }, options);
+  }
+  catch(const bstd::error::error&) {
+    thrown = true;
+  }
+  VERIFY(thrown and before_error == 100,
+      "parse_ndjson unordered delivers every record before a bad one")
+
+  // A worker waiting on its own pool parses the batches itself.
+  utilities::thread_pool single(1);
+  options.pool = &single;
+  std::promise<std::size_t> nested;
+  single.submit([&] {
+    nested.set_value(parser::parse_ndjson(records,
+          [](std::size_t, json&&) {}, options));
+  });
+  VERIFY(nested.get_future().get() == 1001, "parse_ndjson from a worker")
+}
+
+
+void
+test_parser::
+parse_parallel() {
+  utilities::thread_pool pool(4);
+  parallel_options options;
+  options.min_chunk_size = 4;
+  options.pool = &pool;
+
+  const auto to_string = [](const json& _json) {
+    std::ostringstream os;
+    os << _json;
+    return os.str();
+  };
+
+  std::string array = " [";
+  for(auto i = 0; i < 500; ++i)
+    array += std::to_string(i) + ", [\"x\", {\"y\": [" +
+      std::to_string(i) + "]}], ";
+  array += "null ]\n";
+
+  const auto parallel_array = parser::parse_parallel(array, options);
+  VERIFY(parallel_array->size() == 1001, "parse_parallel array size")
+  VERIFY(to_string(*parallel_array) == to_string(*parse(array)),
+      "parse_parallel array matches parse")
+
+  VERIFY(to_string(*parser::parse_parallel(m_object, options)) ==
+      to_string(*parse(m_object)), "parse_parallel object matches parse")
+
+  VERIFY(parser::parse_parallel("\"scalar\"", options)->get_type() ==
+      json::value_type::string, "parse_parallel scalar")
+
+  for(const auto& input : {"[1, 2, 3, 4,]", "[1, 2,, 3, 4]", "{\"a\": 1]",
+        "[1, 2, 3, 4 5]", "[1, 2, 3, 4] 5", "[1, 2, 3, 4"}) {
+    bool thrown = false;
+    try {
+      parser::parse_parallel(input, options);
+    }
+    catch(const bstd::error::error&) {
+      thrown = true;
+    }
+    VERIFY(thrown, "parse_parallel bad input: "s + input)
+  }
+
+  utilities::thread_pool single(1);
+  options.pool = &single;
+  std::promise<std::size_t> nested;
+  single.submit([&] {
+    nested.set_value(parser::parse_parallel(array, options)->size());
+  });
+  VERIFY(nested.get_future().get() == 1001, "parse_parallel from a worker")
+}
+
+
+void
+test_parser::
+parse_pmr() {
+  std::pmr::monotonic_buffer_resource arena;
+  const std::string long_string(100, 'x');
+  const auto input = "{\"long\": [\"" + long_string + "\"], \"object\": " +
+    m_object + "}";
+
+  // Anything not allocated from the arena would come from the default
+  // resource and fail.
+  const auto previous =
+    std::pmr::set_default_resource(std::pmr::null_memory_resource());
+
+  std::shared_ptr<pmr_json> result;
+  bool allocated_elsewhere = false;
+  try {
+    result = parser::parse_pmr(input, &arena);
+  }
+  catch(const std::bad_alloc&) {
+    allocated_elsewhere = true;
+  }
+
+  std::pmr::set_default_resource(previous);
+
+  VERIFY(!allocated_elsewhere, "parse_pmr allocates only from the resource")
+  if(allocated_elsewhere)
+    return;
+
+  auto& string = result->get<pmr_json::object_type>().at("long")
+    .get<pmr_json::array_type>().at(0).get<pmr_json::string_type>();
+  VERIFY(std::string_view(string) == long_string, "parse_pmr string value")
+  VERIFY(string.get_allocator().resource() == &arena,
+      "parse_pmr string uses the resource")
+  VERIFY(result->at("object").size() == 7, "parse_pmr nested object")
+
+  const auto document = parse_arena(m_array);
+  VERIFY(document->get_root().size() == 5, "parse_arena array size")
+  VERIFY(document->get_root().at(2).at(1).at(0).get<pmr_json::number_type>()
+      == 4, "parse_arena nested element")
+}
+
+
+void
+test_parser::
+parse_flat() {
+  dom_builder<flat_json> builder;
+  parser::parse_sax(m_object, builder);
+  const auto object = builder.release();
+  const auto& members = object.get<flat_json::object_type>();
+
+  VERIFY(members.size() == 7, "parse_flat object size")
+  VERIFY(members.begin()->first == "name", "parse_flat keeps insertion order")
+  VERIFY(members.at("dup").get<flat_json::number_type>() == 2,
+      "parse_flat last duplicate wins")
+  VERIFY(!members.contains("missing"), "parse_flat missing member")
+  VERIFY(object.to_string(false).starts_with(
+        "{\"name\":\"value\",\"number\":-12"),
+      "parse_flat to_string in insertion order")
+
+  std::string large = "{";
+  for(auto i = 0; i < 100; ++i)
+    large += "\"key" + std::to_string(i) + "\": " + std::to_string(i) + ", ";
+  large += "\"key7\": 700}";
+
+  parser::parse_sax(large, builder);
+  auto indexed = builder.release().get<flat_json::object_type>();
+
+  auto found = indexed.size() == 100;
+  for(auto i = 0; found and i < 100; ++i)
+    found = indexed.at("key" + std::to_string(i)).get<flat_json::number_type>()
+      == (i == 7 ? 700 : i);
+  VERIFY(found, "parse_flat indexed lookup")
+
+  indexed.erase("key0");
+  VERIFY(indexed.begin()->first == "key1" and !indexed.contains("key0") and
+      indexed.contains("key99"), "parse_flat erase keeps order and index")
+
+  // Keys of the same length with the same first and last characters share a
+  // tag in the linear scan.
+  flat_json::object_type small;
+  small.emplace("", flat_json(100));
+  for(auto i = 0; i < 12; ++i)
+    small.emplace("k" + std::to_string(i % 10) + "_" + std::to_string(i / 10),
+        flat_json(i));
+  small.erase("k3_0");
+
+  auto scanned = small.size() == 12 and small.contains("") and
+    !small.contains("k3_0");
+  for(auto i = 0; scanned and i < 12; ++i)
+    if(i != 3)
+      scanned = small.at("k" + std::to_string(i % 10) + "_" +
+          std::to_string(i / 10)).get<flat_json::number_type>() == i;
+  VERIFY(scanned, "parse_flat linear scan with shared tags and erase")
+}
+
+
+void
+test_parser::
+parse_interned() {
+  const std::string long_string(100, 'x');
+  const auto input = "{\"name\": \"value\", \"long\": \"" + long_string +
+    "\"}";
+
+  dom_builder<interned_json> builder;
+  parser::parse_sax(input, builder);
+  const auto first = builder.release();
+  parser::parse_sax(input, builder);
+  const auto second = builder.release();
+
+  const auto& name1 = first.get<interned_json::object_type>().begin()->first;
+  const auto& name2 = second.get<interned_json::object_type>().begin()->first;
+  VERIFY(name1.is_interned() and name1.data() == name2.data(),
+      "parse_interned keys are shared across documents")
+  const auto& value = first.at("name").get<interned_string>();
+  VERIFY(!value.is_interned() and value == second.at("name")
+      .get<interned_string>() and value.data() != second.at("name")
+      .get<interned_string>().data() and value == interned_string::intern(
+        "value"), "parse_interned values are owned, not pooled")
+
+  const auto& long1 = first.at("long").get<interned_string>();
+  const auto& long2 = second.at("long").get<interned_string>();
+  VERIFY(!long1.is_interned() and long1 == long2 and
+      long1.data() != long2.data(), "parse_interned long values are owned")
+
+  auto copy = long1;
+  VERIFY(copy.data() == long1.data() and copy == long_string,
+      "parse_interned copies share long values")
+  VERIFY(first.to_string(false).starts_with("{\"name\":\"value\""),
+      "parse_interned to_string")
+}
+
+
+void
+test_parser::
+parse_numbers() {
+  const auto value = [](const std::string_view _text) {
+    return parse(_text)->get<json::number_type>();
+  };
+  using int64_limits = std::numeric_limits<std::int64_t>;
+  const auto infinity = std::numeric_limits<double>::infinity();
+
+  VERIFY(value("9223372036854775807").get_int64() == int64_limits::max() and
+      value("-9223372036854775808").get_int64() == int64_limits::min(),
+      "parse_numbers int64 range")
+  VERIFY(value("18446744073709551615").get_uint64() ==
+      std::numeric_limits<std::uint64_t>::max() and
+      value("18446744073709551615").get_kind() ==
+      number::kind::unsigned_integer, "parse_numbers uint64 range")
+  VERIFY(value("123456789012345678").get_kind() == number::kind::integer and
+      value("123456789012345678") == 123456789012345678,
+      "parse_numbers 64-bit integers are exact")
+  VERIFY(value("18446744073709551616").get_double() == 18446744073709551616.0,
+      "parse_numbers larger integers become doubles")
+
+  VERIFY(value("0.1").get_double() == 0.1 and
+      value("-12.540").get_double() == -12.54 and
+      value("15010E5").get_double() == 15010E5 and
+      value("123e-5").get_double() == 123e-5 and
+      value("+.5").get_double() == 0.5, "parse_numbers floats")
+  VERIFY(value("2.2250738585072014e-308").get_double() ==
+      2.2250738585072014e-308 and
+      value("3.141592653589793238462643383279").get_double() ==
+      3.141592653589793238462643383279 and
+      value("0.000000000000000000000000000001e2").get_double() == 1e-28,
+      "parse_numbers long and extreme floats")
+  VERIFY(value("-0").get_kind() == number::kind::floating_point and
+      std::signbit(value("-0").get_double()) and
+      std::signbit(value("-0.0e5").get_double()) and
+      value("0").get_kind() == number::kind::integer,
+      "parse_numbers negative zero")
+  VERIFY(value("1e400").get_double() == infinity and
+      value("-1e400").get_double() == -infinity and
+      value("1e-400").get_double() == 0, "parse_numbers out of range")
+  VERIFY(value("2.5").get<int>() == 2 and value("1e300").get<int>() ==
+      std::numeric_limits<int>::max(),
+      "parse_numbers conversion saturates")
+
+  const auto lazy = parse("[12.5, 123456789012345678901, 7]",
+      number_mode::lazy);
+  auto first = lazy->at(0).get<json::number_type>();
+  VERIFY(first.get_kind() == number::kind::raw and first.get_raw() == "12.5" and
+      first == 12.5 and to_string(first) == "12.5", "parse_numbers lazy")
+  VERIFY(lazy->at(1).get<json::number_type>().get_kind() ==
+      number::kind::floating_point, "parse_numbers lazy long numbers decoded")
+
+  first.decode();
+  VERIFY(first.get_kind() == number::kind::floating_point and
+      first.get_double() == 12.5, "parse_numbers lazy decode")
+  VERIFY(lazy->at(2).get<json::number_type>() == 7 and json(7).get_type() ==
+      json::value_type::number and json(2.5).get<json::number_type>() == 2.5,
+      "parse_numbers construct from arithmetic types")
+}
+
+
+void
+test_parser::
+parse_escapes() {
+  const auto value = [](const std::string_view _text) {
+    return parse(_text)->get<json::string_type>();
+  };
+
+  VERIFY(value("\"plain\"") == "plain", "parse_escapes plain")
+  VERIFY(value(R"("q\"b\\s\/f\bf\fn\nr\rt\t")") ==
+      "q\"b\\s/f\bf\fn\nr\rt\t", "parse_escapes short escapes")
+  VERIFY(value(R"("\u0041\u00e9\u20AC\ud83d\ude00")") ==
+      "A\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80",
+      "parse_escapes unicode escapes and surrogate pairs")
+  VERIFY(value(R"("\ud83dx\ude00\ud83d")") ==
+      "\xef\xbf\xbdx\xef\xbf\xbd\xef\xbf\xbd",
+      "parse_escapes lone surrogates")
+
+  const std::string text(100, 'x');
+  const auto long_value = value("\"" + text + "\\\"" + text + "\"");
+  VERIFY(long_value == text + '"' + text, "parse_escapes long string")
+  VERIFY(parse(R"({"a\"b": 1})")->at("a\"b").get<json::number_type>() == 1,
+      "parse_escapes keys")
+
+  // Bad escapes are reported at their backslash.
+  const auto error_offset = [](const std::string& _input) {
+    null_handler handler;
+    const auto result = parser::parse_sax(_input, handler, false);
+    return result ? std::string::npos : result.offset;
+  };
+  auto reported = true;
+  for(const auto bad : {R"(\u12)", R"(\q)", R"(\u12g4)", R"(\U0041)"})
+    reported = reported and
+      error_offset(std::string("[\"ok\\n") + bad + "\"]") == 6;
+  VERIFY(reported, "parse_escapes invalid escapes")
+
+  incremental_parser p(false, false);
+  p.feed(R"(["\u00)");
+  p.feed(R"(4x"])");
+  VERIFY(p.finish()->get_type() == json::value_type::null,
+      "parse_escapes incremental invalid escape")
+
+  std::string buffer;
+  const std::string_view unescaped = "no escapes";
+  VERIFY(unescape(unescaped, buffer).data() == unescaped.data(),
+      "parse_escapes strings without escapes are not copied")
+
+  const auto input =
+    R"(["a\"b\u00e9\ud83d\ude00\n", {"k\\": "\u0001"}])";
+  VERIFY(serializer::serialize(*parse(input)) ==
+      "[\"a\\\"b\xc3\xa9\xf0\x9f\x98\x80\\n\",{\"k\\\\\":\"\\u0001\"}]",
+      "parse_escapes round trip")
+}
+
+
+void
+test_parser::
+parse_utf8() {
+  // The offset of the first invalid byte, or npos if the input is valid.
+  const auto error_offset = [](const std::string& _input) {
+    null_handler handler;
+    const auto result = parser::parse_sax(_input, handler, false);
+    return result ? std::string::npos : result.offset;
+  };
+
+  VERIFY(error_offset("[\"\x7f\xc2\x80\xdf\xbf\xe0\xa0\x80\xed\x9f\xbf"
+        "\xee\x80\x80\xf0\x90\x80\x80\xf4\x8f\xbf\xbf\"]") ==
+      std::string::npos, "parse_utf8 valid sequences")
+
+  const std::vector<std::string> invalid{
+    "\x80",             // continuation without a lead
+    "\xc0\xaf",         // overlong two byte sequence
+    "\xe0\x9f\xbf",     // overlong three byte sequence
+    "\xf0\x8f\xbf\xbf", // overlong four byte sequence
+    "\xed\xa0\x80",     // surrogate
+    "\xf4\x90\x80\x80", // above U+10FFFF
+    "\xf8\x88\x80\x80", // five byte lead
+    "\xe2\x82",         // truncated
+    "\xe2\x82x"         // truncated before ASCII
+  };
+
+  // Check every error at the start, in the middle and at the end of a long
+  // string, so that it is found both inside and across blocks.
+  auto found = true;
+  for(const auto& sequence : invalid)
+    for(const auto padding : {0, 13, 62, 63, 64, 100}) {
+      const std::string plain(padding, 'a');
+      const auto text = "\xc3\xa9" + plain;
+      found = found and error_offset("[\"" + text + sequence + text + "\"]") ==
+        2 + text.size();
+    }
+  VERIFY(found, "parse_utf8 invalid sequences")
+
+  VERIFY(error_offset("{\"\xff\": 1}") == 2, "parse_utf8 keys")
+  VERIFY(error_offset("[\xc3\xa9]") == 1,
+      "parse_utf8 is only valid in strings")
+
+  incremental_parser p(false, false);
+  p.feed("[\"\xe2\x82");
+  p.feed("\xac\"]");
+  VERIFY(p.finish()->at(0).get<json::string_type>() == "\xe2\x82\xac",
+      "parse_utf8 incremental split sequence")
+  p.feed("[\"\xe2\x82\"]");
+  VERIFY(p.finish()->get_type() == json::value_type::null,
+      "parse_utf8 incremental invalid")
+}
+
+
+void
+test_parser::
+serialize() {
+  using serializer::serialize;
+
+  VERIFY(serialize(*parse(m_array)) == "[1,\"two\",[3,[4]],{},[]]",
+      "serialize compact")
+  VERIFY(serialize(*parse("{\"a\": [1, true], \"b\": {}, \"c\": null}"),
+        {2}) == "{\n  \"a\": [\n    1,\n    true\n  ],\n  \"b\": {},\n"
+      "  \"c\": null\n}", "serialize pretty")
+
+  std::string buffer = "prefix ";
+  {
+    serializer::serializer writer(buffer);
+    writer.write_string(std::string_view("q\"b\\n\n\x01\xc3\xa9", 9));
+  }
+  VERIFY(buffer == "prefix \"q\\\"b\\\\n\\n\\u0001\xc3\xa9\"",
+      "serialize escapes strings and appends to a buffer")
+
+  buffer.clear();
+  const auto capacity = buffer.capacity();
+  serialize(json(false), buffer);
+  VERIFY(buffer == "false" and buffer.capacity() == capacity,
+      "serialize reuses a buffer")
+
+  const auto numbers = parse("[-0, 1.5e300, 0.1, 18446744073709551615, "
+      "+7, 007, +.5, 1E2]", number_mode::lazy);
+  VERIFY(serialize(*numbers) == "[-0,1.5e300,0.1,18446744073709551615,7,7,"
+      "0.5,1E2]", "serialize raw numbers")
+  VERIFY(serialize(*parse("[1.5e300, 0.1, -9223372036854775808]")) ==
+      "[1.5e+300,0.1,-9223372036854775808]", "serialize decoded numbers")
+  VERIFY(serialize(json(std::numeric_limits<double>::infinity())) == "null",
+      "serialize non-finite numbers as null")
+}
+
+
+void
+test_parser::
+pointer_lookup() {
+  const std::string input = "{\"payload\": {\"items\": [{\"price\": 9.5}, "
+    "{\"price\": 3}], \"a/b\": 1, \"m~n\": 2, \"\": 3, \"01\": 4}}";
+  const auto document = parse(input);
+
+  const json_pointer price("/payload/items/1/price");
+  VERIFY(price.size() == 4 and price.key(1) == "items" and
+      price.index(2) == 1 and price.index(1) == json_pointer::npos,
+      "pointer_lookup tokens")
+  VERIFY(price.at(*document).to_string(false) == "3", "pointer_lookup array element")
+  VERIFY(json_pointer("").find(*document) == &*document,
+      "pointer_lookup whole document")
+  VERIFY(json_pointer("/payload/a~1b").at(*document).to_string(false) == "1" and
+      json_pointer("/payload/m~0n").at(*document).to_string(false) == "2" and
+      json_pointer("/payload/").at(*document).to_string(false) == "3" and
+      json_pointer("/payload/01").at(*document).to_string(false) == "4",
+      "pointer_lookup escaped, empty and numeric keys")
+  VERIFY(json_pointer("/payload/items/2").find(*document) == nullptr and
+      json_pointer("/payload/items/-").find(*document) == nullptr and
+      json_pointer("/payload/items/01").find(*document) == nullptr and
+      json_pointer("/payload/missing").find(*document) == nullptr and
+      json_pointer("/payload/a~1b/0").find(*document) == nullptr,
+      "pointer_lookup missing values")
+  VERIFY(json_pointer("/a~1b/m~0n").to_string() == "/a~1b/m~0n",
+      "pointer_lookup to_string")
+
+  auto threw = false;
+  try {
+    price.at(json(1));
+  }
+  catch(const std::out_of_range&) {
+    threw = true;
+  }
+  VERIFY(threw, "pointer_lookup at throws for missing values")
+
+  for(const auto bad : {"a", "/~", "/~2", "/a~"}) {
+    threw = false;
+    try {
+      json_pointer{std::string_view(bad)};
+    }
+    catch(const std::invalid_argument&) {
+      threw = true;
+    }
+    VERIFY(threw, "pointer_lookup rejects bad pointers")
+  }
+
+  static constexpr static_json_pointer static_price("/payload/items/0/price");
+  static_assert(static_price.size() == 4 and static_price.index(2) == 0 and
+      static_price.key(3) == "price");
+  VERIFY(static_price.at(*document).to_string(false) == "9.5",
+      "pointer_lookup static pointers")
+
+  // Large flat objects are indexed by hash_string().
+  std::string wide = "{";
+  for(auto i = 0; i < 100; ++i)
+    wide += "\"key" + std::to_string(i) + "\": " + std::to_string(i) + ", ";
+  wide += "\"end\": [true]}";
+
+  dom_builder<flat_json> builder;
+  parser::parse_sax(wide, builder);
+  auto flat = builder.release();
+  VERIFY(json_pointer("/key42").at(flat).to_string(false) == "42" and
+      json_pointer("/end/0").at(flat).to_string(false) == "true" and
+      json_pointer("/key100").find(flat) == nullptr,
+      "pointer_lookup flat objects")
+
+  json_pointer("/end/0").at(flat) = flat_json(false);
+  VERIFY(flat.at("end").at(0).to_string(false) == "false",
+      "pointer_lookup mutable access")
+}
+
+
+void
+test_parser::
+path_query() {
+  const std::string events = "{\"events\": [{\"user\": {\"id\": 1}, "
+    "\"type\": \"click\", \"n\": 5}, {\"user\": {\"id\": 2}, \"type\": "
+    "\"view\", \"n\": 2}, {\"user\": {\"id\": \"x\"}}], \"id\": 0}";
+
+  const auto select = [&events](const std::string_view _path) {
+    std::string values;
+    for(const auto value : json_path(_path).select(events))
+      values += std::string(value) + ";";
+    return values;
+  };
+
+  VERIFY(select("$.events[*].user.id") == "1;2;\"x\";",
+      "path_query children and wildcards")
+  VERIFY(select("$..id") == "1;2;\"x\";0;", "path_query recursive descent")
+  VERIFY(select("$['events'][1].n") == "2;" and
+      select("$.events[0:3:2].user") == "{\"id\": 1};{\"id\": \"x\"};" and
+      select("$.events[1:].n") == "2;" and select("$.events[5]").empty(),
+      "path_query names, indices and slices")
+  VERIFY(select("$") == events + ";", "path_query root")
+  VERIFY(select("$.events[?(@.type == 'click')].user.id") == "1;" and
+      select("$.events[?(@.type != \"click\")].user.id") == "2;\"x\";" and
+      select("$.events[?(@.n >= 2)].n") == "5;2;" and
+      select("$.events[?(@.n < 3)].type") == "\"view\";" and
+      select("$.events[?@.type].n") == "5;2;" and
+      select("$.events[*].n[?(@ > 3)]").empty() and
+      select("$.events[*][?(@ > 3)]") == "5;",
+      "path_query filters")
+  VERIFY(select("$..[?(@.id == 2)]") == "{\"id\": 2};",
+      "path_query recursive filters")
+
+  const auto nested = json_path("$..a").select(
+      "{\"a\": {\"a\": [1]}, \"b\": [{\"a\": null}]}");
+  VERIFY(nested.size() == 3 and nested[0] == "{\"a\": [1]}" and
+      nested[1] == "[1]" and nested[2] == "null",
+      "path_query nested matches in document order")
+
+  std::size_t count = 0;
+  const auto result = json_path("$[*]").query("[1, 2, }",
+      [&count](std::string_view) { ++count; }, false);
+  VERIFY(!result and count == 2, "path_query reports values before errors")
+
+  for(const auto bad : {"", "a", "$.", "$[", "$[-1]", "$[1:2:0]",
+      "$[?(@.a ==)]", "$['a]", "$.a b"}) {
+    auto threw = false;
+    try {
+      json_path{std::string_view(bad)};
+    }
+    catch(const std::invalid_argument&) {
+      threw = true;
+    }
+    VERIFY(threw, "path_query rejects bad paths")
+  }
+}
+
+
+void
+test_parser::
+compare_values() {
+  const auto a = parse("{\"a\": [1, 2.5, \"x\"], \"b\": {\"c\": null}, "
+      "\"d\": true}");
+  const auto b = parse("{\"d\": true, \"b\": {\"c\": null}, "
+      "\"a\": [1.0, 25e-1, \"x\"]}");
+  VERIFY(*a == *b and a->hash() == b->hash(),
+      "compare_values objects in any order")
+
+  for(const auto other : {"{\"a\": [1, 2.5, \"x\"], \"b\": {\"c\": 0}, "
+      "\"d\": true}", "{\"a\": [2.5, 1, \"x\"], \"b\": {\"c\": null}, "
+      "\"d\": true}", "{\"a\": [1, 2.5, \"x\"], \"b\": {\"c\": null}}",
+      "[1]", "\"x\""})
+    VERIFY(*a != *parse(other) and a->hash() != parse(other)->hash(),
+        "compare_values different values")
+
+  VERIFY(json(0) == json(-0.0) and json(0).hash() == json(-0.0).hash() and
+      json("a") != json("b") and json(nullptr) == json() and
+      json(true) != json(1), "compare_values scalars")
+
+  // Integers compare exactly with doubles, so equality stays transitive.
+  const json exact(std::int64_t{9007199254740992});
+  const json above(std::int64_t{9007199254740993});
+  const json rounded(9007199254740992.0);
+  VERIFY(exact == rounded and exact.hash() == rounded.hash() and
+      above != rounded and above != exact and json(2.5) != json(2) and
+      json(std::uint64_t{18446744073709551615u}) != json(0x1p64) and
+      json(std::int64_t{-9223372036854775807 - 1}) == json(-0x1p63) and
+      number(-1) < number(-0.5) and number(3) > number(2.5),
+      "compare_values integers and doubles")
+  std::unordered_map<json, int> ids;
+  for(const auto& id : {exact, above, rounded})
+    ++ids[id];
+  VERIFY(ids.size() == 2 and ids[above] == 1, "compare_values large ids")
+
+  auto memoized = *a;
+  const auto hash = memoized.memoize_hash();
+  VERIFY(hash == a->hash() and memoized.hash() == hash and memoized == *b,
+      "compare_values memoized hashes")
+
+  memoized.get<json::object_type>().erase("d");
+  VERIFY(memoized.hash() != hash and memoized != *a and
+      memoized.memoize_hash() == parse("{\"b\": {\"c\": null}, "
+        "\"a\": [1, 2.5, \"x\"]}")->hash(),
+      "compare_values mutable access drops memoized hashes")
+
+  json_pointer("/b/c").at(memoized) = json(1);
+  VERIFY(memoized.hash() == parse("{\"b\": {\"c\": 1}, "
+        "\"a\": [1, 2.5, \"x\"]}")->hash(),
+      "compare_values json_pointer drops memoized hashes")
+
+  std::unordered_map<json, int> counts;
+  for(const auto text : {"[1, {\"a\": 1, \"b\": 2}]", "[1, {\"b\": 2, "
+      "\"a\": 1}]", "[1.0, {\"a\": 1, \"b\": 2}]", "[1, {\"a\": 1}]"})
+    ++counts[*parse(text)];
+  VERIFY(counts.size() == 2 and counts[*parse("[1, {\"a\": 1}]")] == 1,
+      "compare_values unordered_map keys")
+}
+
+
+void
+test_parser::
+patch_documents() {
+  auto document = *parse("{\"a\": {\"b\": [1, 2, 3]}, \"c\": \"d\"}");
+  patch::apply_patch(document, *parse("[{\"op\": \"add\", \"path\": "
+        "\"/a/b/1\", \"value\": 9}, {\"op\": \"add\", \"path\": \"/a/b/-\", "
+        "\"value\": 4}, {\"op\": \"remove\", \"path\": \"/a/b/0\"}, "
+        "{\"op\": \"replace\", \"path\": \"/c\", \"value\": [\"e\"]}, "
+        "{\"op\": \"move\", \"from\": \"/a/b\", \"path\": \"/b\"}, "
+        "{\"op\": \"copy\", \"from\": \"/c/0\", \"path\": \"/a/~1\"}, "
+        "{\"op\": \"test\", \"path\": \"/b\", \"value\": [9, 2, 3, 4]}]"));
+  VERIFY(document == *parse("{\"a\": {\"/\": \"e\"}, \"b\": [9, 2, 3, 4], "
+        "\"c\": [\"e\"]}"), "patch_documents apply_patch")
+
+  patch::apply_patch(document, *parse("[{\"op\": \"add\", \"path\": \"\", "
+        "\"value\": [1]}]"));
+  VERIFY(document == *parse("[1]"), "patch_documents replace the document")
+
+  // Operations before a failing one stay applied.
+  auto threw = false;
+  try {
+    patch::apply_patch(document, *parse("[{\"op\": \"add\", \"path\": "
+          "\"/0\", \"value\": 0}, {\"op\": \"test\", \"path\": \"/0\", "
+          "\"value\": 1}]"));
+  }
+  catch(const std::domain_error&) {
+    threw = true;
+  }
+  VERIFY(threw and document == *parse("[0, 1]"),
+      "patch_documents failed tests throw")
+
+  for(const auto bad : {"{}", "[1]", "[{\"path\": \"/0\"}]", "[{\"op\": "
+      "\"add\", \"path\": \"/0\"}]", "[{\"op\": \"swap\", \"path\": \"\"}]",
+      "[{\"op\": \"move\", \"from\": \"/a\", \"path\": \"/a/b\"}]"}) {
+    threw = false;
+    try {
+      patch::apply_patch(document, *parse(bad));
+    }
+    catch(const std::invalid_argument&) {
+      threw = true;
+    }
+    VERIFY(threw, "patch_documents rejects bad patches")
+  }
+
+  for(const auto missing : {"[{\"op\": \"remove\", \"path\": \"/2\"}]",
+      "[{\"op\": \"add\", \"path\": \"/3\", \"value\": 0}]",
+      "[{\"op\": \"replace\", \"path\": \"/a\", \"value\": 0}]",
+      "[{\"op\": \"add\", \"path\": \"/0/a\", \"value\": 0}]",
+      "[{\"op\": \"copy\", \"from\": \"/-\", \"path\": \"/0\"}]"}) {
+    threw = false;
+    try {
+      patch::apply_patch(document, *parse(missing));
+    }
+    catch(const std::out_of_range&) {
+      threw = true;
+    }
+    VERIFY(threw and document == *parse("[0, 1]"),
+        "patch_documents missing paths throw")
+  }
+
+  document = *parse("{\"title\": \"Goodbye!\", \"author\": {\"givenName\": "
+      "\"John\", \"familyName\": \"Doe\"}, \"tags\": [\"example\", "
+      "\"sample\"], \"content\": \"This will be unchanged\"}");
+  patch::apply_merge_patch(document, *parse("{\"title\": \"Hello!\", "
+        "\"phoneNumber\": \"+01-123-456-7890\", \"author\": {\"familyName\": "
+        "null}, \"tags\": [\"example\"], \"new\": {\"a\": null, \"b\": 1}}"));
+  VERIFY(document == *parse("{\"title\": \"Hello!\", \"author\": "
+        "{\"givenName\": \"John\"}, \"tags\": [\"example\"], \"content\": "
+        "\"This will be unchanged\", \"phoneNumber\": \"+01-123-456-7890\", "
+        "\"new\": {\"b\": 1}}"), "patch_documents apply_merge_patch")
+
+  patch::apply_merge_patch(document, json(1));
+  patch::apply_merge_patch(document, *parse("{\"a\": {\"b\": 1}}"));
+  VERIFY(document == *parse("{\"a\": {\"b\": 1}}"),
+      "patch_documents merge patches replace non-objects")
+
+  const std::pair<const char*, const char*> pairs[] = {
+    {"{\"a\": 1, \"b\": [1, 2, 3], \"c\": {\"d\": null}}",
+      "{\"a\": 2, \"b\": [1, 5, 2, 3], \"e\": {}}"},
+    {"[1, 2, 3, 4, 5]", "[1, 5]"},
+    {"[1, 2, 3]", "[7, 8, 9, 10]"},
+    {"{\"a/b\": [{\"~\": 1}]}", "{\"a/b\": [{\"~\": 2}, true]}"},
+    {"[1]", "{}"},
+    {"{\"a\": 1}", "{\"a\": 1}"}};
+  for(const auto& [from, to] : pairs) {
+    auto source = *parse(from);
+    const auto target = *parse(to);
+    patch::apply_patch(source, patch::diff(source, target));
+    VERIFY(source == target, "patch_documents diff")
+  }
+
+  auto source = *parse("{\"big\": [1, 2, 3, 4, 5, 6, 7, 8], \"x\": [1]}");
+  auto target = *parse("{\"big\": [1, 2, 3, 4, 0, 5, 6, 7, 8], "
+      "\"x\": [1]}");
+  source.memoize_hash();
+  target.memoize_hash();
+  VERIFY(patch::diff(source, target) == *parse("[{\"op\": \"add\", "
+        "\"path\": \"/big/4\", \"value\": 0}]") and
+      patch::diff(source, source).get<json::array_type>().empty(),
+      "patch_documents minimal diffs")
+
+  // Changed through a reference taken before memoizing, so the root's memo
+  // is stale.
+  auto stale = *parse("{\"a\": [1]}");
+  auto& member = stale.get<json::object_type>().at("a");
+  stale.memoize_hash();
+  auto original = stale;
+  original.memoize_hash();
+  member.get<json::array_type>().push_back(json(2));
+  VERIFY(patch::diff(original, stale) == *parse("[{\"op\": \"add\", "
+        "\"path\": \"/a/1\", \"value\": 2}]"),
+      "patch_documents stale memoized hashes")
+
+  dom_builder<flat_json> builder;
+  parser::parse_sax("{\"a\": [1], \"b\": 2}", builder);
+  auto flat = builder.release();
+  patch::apply_patch(flat, patch::diff(flat, flat_json(
+          flat_json::object_type())));
+  VERIFY(flat.get<flat_json::object_type>().empty(),
+      "patch_documents flat objects")
+}
+
+
+void
+test_parser::
+encode_binary() {
+  const auto bytes = [](const std::string_view _hex) {
+    std::string data;
+    for(std::size_t i = 0; i + 1 < _hex.size(); i += 2)
+      data += static_cast<char>(std::stoi(std::string(_hex.substr(i, 2)),
+            nullptr, 16));
+    return data;
+  };
+
+  // Examples from RFC 8949 appendix A.
+  const std::pair<const char*, const char*> cbor_examples[] = {
+    {"0", "00"}, {"23", "17"}, {"24", "1818"}, {"1000", "1903e8"},
+    {"-1", "20"}, {"-1000", "3903e7"}, {"1.5", "f93e00"},
+    {"100000.0", "fa47c35000"}, {"1.1", "fb3ff199999999999a"},
+    {"5.960464477539063e-8", "f90001"}, {"-4.0", "f9c400"},
+    {"18446744073709551615", "1bffffffffffffffff"}, {"true", "f5"},
+    {"null", "f6"}, {"\"\\u00fc\"", "62c3bc"}, {"[1, [2, 3]]", "8201820203"},
+    {"{\"a\": 1}", "a1616101"}};
+  for(const auto& [text, hex] : cbor_examples) {
+    const auto value = *parse(text);
+    VERIFY(binary::to_cbor(value) == bytes(hex) and
+        binary::from_cbor(bytes(hex)) == value, "encode_binary cbor examples")
+  }
+
+  const std::pair<const char*, const char*> cbor_decoded[] = {
+    {"9f018202039f0405ffff", "[1, [2, 3], [4, 5]]"},
+    {"bf61610161629f0203ffff", "{\"a\": 1, \"b\": [2, 3]}"},
+    {"7f657374726561646d696e67ff", "\"streaming\""},
+    {"c074323031332d30332d32315432303a30343a30305a",
+      "\"2013-03-21T20:04:00Z\""},
+    {"4401020304", "\"AQIDBA\""}, {"f7", "null"},
+    {"3bffffffffffffffff", "-18446744073709551616.0"},
+    {"a2616101616102", "{\"a\": 2}"}};
+  for(const auto& [hex, text] : cbor_decoded)
+    VERIFY(binary::from_cbor(bytes(hex)) == *parse(text),
+        "encode_binary cbor decoding")
+
+  const std::pair<const char*, const char*> msgpack_examples[] = {
+    {"127", "7f"}, {"-32", "e0"}, {"128", "cc80"}, {"-33", "d0df"},
+    {"-40000", "d2ffff63c0"}, {"1.5", "ca3fc00000"},
+    {"1.1", "cb3ff199999999999a"}, {"false", "c2"}, {"null", "c0"},
+    {"\"a\"", "a161"}, {"[1, []]", "920190"}, {"{\"a\": 1}", "81a16101"}};
+  for(const auto& [text, hex] : msgpack_examples) {
+    const auto value = *parse(text);
+    VERIFY(binary::to_msgpack(value) == bytes(hex) and
+        binary::from_msgpack(bytes(hex)) == value,
+        "encode_binary msgpack examples")
+  }
+
+  const auto document = *parse(m_object);
+  std::string long_string(70000, 'x');
+  auto large = *parse("[]");
+  for(auto i = 0; i < 300; ++i)
+    large.get<json::array_type>().emplace_back(i * 1000 - 150000);
+  large.get<json::array_type>().emplace_back(json::string_type(long_string));
+  for(const auto& value : {document, *parse(m_array), large}) {
+    VERIFY(binary::from_cbor(binary::to_cbor(value)) == value and
+        binary::from_msgpack(binary::to_msgpack(value)) == value,
+        "encode_binary round trips")
+
+    dom_builder<flat_json> builder;
+    parser::parse_sax(value.to_string(false), builder);
+    const auto flat = builder.release();
+    VERIFY(binary::from_cbor<flat_json>(binary::to_cbor(flat)) == flat and
+        binary::from_msgpack<pmr_json>(binary::to_msgpack(value))
+        .to_string(false) == value.to_string(false),
+        "encode_binary other json types")
+  }
+
+  // A sequence fed one byte at a time.
+  std::string buffer;
+  binary::cbor_writer writer(buffer);
+  writer.write(document);
+  writer.begin_array();
+  writer.write_number(1);
+  writer.write_string("two");
+  writer.end();
+  writer.finish();
+
+  binary::cbor_reader<json> reader;
+  std::vector<json> values;
+  for(const auto c : buffer) {
+    reader.feed(std::string_view(&c, 1));
+    while(auto value = reader.next())
+      values.push_back(std::move(*value));
+  }
+  VERIFY(values.size() == 2 and values[0] == document and
+      values[1] == *parse("[1, \"two\"]") and !reader.is_partial() and
+      reader.get_offset() == buffer.size(), "encode_binary streaming")
+
+  for(const auto bad : {"", "82", "8201", "0000", "a10101", "6261ff", "1c",
+      "ff", "5f01ff", "bf01ff"}) {
+    auto threw = false;
+    try {
+      binary::from_cbor(bytes(bad));
+    }
+    catch(const std::invalid_argument&) {
+      threw = true;
+    }
+    VERIFY(threw, "encode_binary rejects bad cbor")
+  }
+
+  for(const auto bad : {"", "92", "c1", "d40100", "8101c0", "a1ff"}) {
+    auto threw = false;
+    try {
+      binary::from_msgpack(bytes(bad));
+    }
+    catch(const std::invalid_argument&) {
+      threw = true;
+    }
+    VERIFY(threw, "encode_binary rejects bad msgpack")
+  }
+}
+
+
+
+void
+test_parser::
+snapshot_documents() {
+  const auto document = *parse(m_object);
+  const auto image = binary::write_snapshot(document);
+  const binary::snapshot borrowed(image);
+  VERIFY(borrowed.get_root().get_json() == document,
+      "snapshot_documents round trip")
+
+  const auto numbers = *parse("[268435455, -268435456, 268435456, "
+      "-268435457, -9223372036854775808, 1e300, -0.5]");
+  const auto number_image = binary::write_snapshot(numbers);
+  VERIFY(binary::snapshot(number_image).get_root().get_json() == numbers,
+      "snapshot_documents inline and separate numbers")
+
+  // More members than are searched linearly, in an order flat_json keeps.
+  std::string text = "{";
+  for(auto i = 20; i > 0; --i)
+    text += "\"key" + std::to_string(i) + "\": " + std::to_string(i) + ", ";
+  text += "\"list\": [null, true, -7, 18446744073709551615, 2.5, \"key1\", "
+    "{}, []]}";
+  dom_builder<flat_json> builder;
+  parser::parse_sax(text, builder);
+  const auto flat = builder.release();
+
+  const auto path = (std::filesystem::temp_directory_path() /
+      "bstd_json_snapshot_test").string();
+  std::ofstream(path, std::ios::binary) << binary::write_snapshot(flat);
+  const auto mapped = binary::open_snapshot(path);
+  std::filesystem::remove(path);
+
+  const auto root = mapped.get_root();
+  auto found = root.size() == 21;
+  for(auto i = 1; i <= 20; ++i)
+    found = found and root.at("key" + std::to_string(i)).get<int>() == i;
+  VERIFY(found and !root.find("key0") and !root.find("key21"),
+      "snapshot_documents member lookup")
+
+  const auto list = root["list"];
+  VERIFY(list.size() == 8 and
+      list[0].get_type() == json::value_type::null and
+      list[1].get<bool>() and list[2].get<std::int64_t>() == -7 and
+      list[3].get<std::uint64_t>() == 18446744073709551615u and
+      list[4].get<double>() == 2.5 and
+      list[5].get<std::string_view>() == "key1" and
+      list[6].empty() and list[7].empty(), "snapshot_documents accessors")
+
+  std::string keys;
+  for(auto it = root.begin(); it != root.end(); ++it)
+    keys += std::string(it.key()) + ";";
+  VERIFY(keys.starts_with("key20;key19;") and keys.ends_with("key1;list;") and
+      root.get_json<flat_json>() == flat, "snapshot_documents member order")
+
+  auto threw = 0;
+  try {
+    root.at("missing");
+  }
+  catch(const std::out_of_range&) {
+    ++threw;
+  }
+  try {
+    list.at("key1");
+  }
+  catch(const std::domain_error&) {
+    ++threw;
+  }
+  try {
+    list[5].get_number();
+  }
+  catch(const std::bad_variant_access&) {
+    ++threw;
+  }
+  VERIFY(threw == 3, "snapshot_documents type and range errors")
+
+  for(const auto& bad : {std::string(), image.substr(0, image.size() - 1),
+      "X" + image.substr(1), m_object}) {
+    auto rejected = false;
+    try {
+      binary::snapshot{std::string_view(bad)};
+    }
+    catch(const std::invalid_argument&) {
+      rejected = true;
+    }
+    VERIFY(rejected, "snapshot_documents rejects bad images")
+  }
+}
+
+
+}
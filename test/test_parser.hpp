@@ -0,0 +1,70 @@
+#ifndef TEST_PARSER_HPP_
+#define TEST_PARSER_HPP_
+
+#include <bstd_json.hpp>
+#include <bstd_test.hpp>
+
+namespace bstd::json::test {
+
+using namespace bstd::json::parser;
+
+class test_parser final : public bstd::test::unit_tester {
+
+  public:
+
+    test_parser();
+
+    void parse_values();
+    void parse_containers();
+    void parse_nested();
+    void parse_file();
+    void parse_bad_input();
+    void parse_incremental();
+    void parse_sax();
+    void parse_lazy();
+    void parse_ndjson();
+    void parse_parallel();
+    void parse_pmr();
+    void parse_flat();
+    void parse_interned();
+    void parse_numbers();
+    void parse_escapes();
+    void parse_utf8();
+    void serialize();
+    void pointer_lookup();
+    void path_query();
+    void compare_values();
+    void patch_documents();
+    void encode_binary();
+    void snapshot_documents();
+
+  private:
+
+    const std::string m_object{
+      "{ \"name\": \"value\", \"number\": -12, \"float\": 2.5e1,\n"
+      "  \"true\": true, \"false\": false, \"null\": null, \"dup\": 1,\n"
+      "  \"dup\": 2 }"};
+
+    const std::string m_array{"[1, \"two\", [3, [4]], {}, []]"};
+
+    const std::vector<std::string> m_bad_inputs {
+      "",
+      "[1, 2",
+      "[1 2]",
+      "{\"a\" 1}",
+      "{\"a\": 1,}",
+      "[1,]",
+      "{1: 2}",
+      "[1] 2",
+      "]",
+      "[tru]",
+      "\"\\u12\"",
+      "\"\\q\"",
+      "{\"\\x\": 1}"
+    };
+
+};
+
+}
+
+#endif